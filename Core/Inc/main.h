@@ -61,12 +61,24 @@ void Error_Handler(void);
 /* Private defines -----------------------------------------------------------*/
 #define B1_Pin GPIO_PIN_13
 #define B1_GPIO_Port GPIOC
+#define AXIS1_DIR_Pin GPIO_PIN_0
+#define AXIS1_DIR_GPIO_Port GPIOC
+#define AXIS1_EN_Pin GPIO_PIN_1
+#define AXIS1_EN_GPIO_Port GPIOC
+#define AXIS2_DIR_Pin GPIO_PIN_2
+#define AXIS2_DIR_GPIO_Port GPIOC
+#define AXIS2_EN_Pin GPIO_PIN_3
+#define AXIS2_EN_GPIO_Port GPIOC
 #define USART_TX_Pin GPIO_PIN_2
 #define USART_TX_GPIO_Port GPIOA
 #define USART_RX_Pin GPIO_PIN_3
 #define USART_RX_GPIO_Port GPIOA
 #define LD2_Pin GPIO_PIN_5
 #define LD2_GPIO_Port GPIOA
+#define ENC_A_Pin GPIO_PIN_6
+#define ENC_A_GPIO_Port GPIOA
+#define ENC_B_Pin GPIO_PIN_7
+#define ENC_B_GPIO_Port GPIOA
 #define MOTOR_DIR_Pin GPIO_PIN_8
 #define MOTOR_DIR_GPIO_Port GPIOA
 #define MOTOR_EN_Pin GPIO_PIN_9
@@ -0,0 +1,120 @@
+#ifndef INC_MODULES_COMM_COMMANDRECEIVER_HPP_
+#define INC_MODULES_COMM_COMMANDRECEIVER_HPP_
+
+#include "main.h"
+#include "comm/TelemetryProtocol.hpp"
+#include <cstdint>
+
+/**
+ * @brief COMMAND frame reception over UART RX circular DMA
+ *
+ * The DMA stream writes every received byte into a ring buffer without CPU
+ * involvement. The HAL reception event (IDLE line, half or full buffer)
+ * only publishes the new write position and a DWT cycle stamp; nothing is
+ * parsed in interrupt context.
+ *
+ * poll() runs in the main loop: it scans the new bytes once for 0x00
+ * delimiters and decodes each candidate frame in place in the DMA buffer
+ * (COBS decoding never writes ahead of its input). Only a frame that wraps
+ * around the end of the buffer is first copied into a small scratch buffer.
+ * Bytes between delimiters that do not decode are counted as frame errors
+ * and skipped, as is any unterminated run longer than a command frame.
+ *
+ * Overrun: if the main loop falls more than BUFFER_SIZE bytes behind, the
+ * DMA has overwritten unread data; the backlog is discarded and counted.
+ *
+ * Requirements: huart RX linked to a DMA stream in circular mode, UART and
+ * DMA stream interrupts enabled, HAL_UARTEx_RxEventCallback and
+ * HAL_UART_ErrorCallback forwarded to onRxEvent()/onError() (done by this
+ * module for the console receiver), DWT cycle counter running for stamps.
+ */
+class CommandReceiver {
+public:
+    static constexpr uint32_t BUFFER_SIZE = 256;    // Bytes, power of two
+    // Longest COMMAND frame between its delimiters (payload + CRC + COBS)
+    static constexpr uint32_t MAX_ENCODED_FRAME = TelemetryProtocol::MAX_COMMAND_PAYLOAD + 2 + 1;
+
+    explicit CommandReceiver(UART_HandleTypeDef* huart);
+
+    // Receiver owns the UART RX DMA stream
+    CommandReceiver(const CommandReceiver&) = delete;
+    CommandReceiver& operator=(const CommandReceiver&) = delete;
+
+    /**
+     * @brief Start circular DMA reception with idle-line events
+     * @return false if the HAL refused to start the reception
+     */
+    bool start();
+
+    /**
+     * @brief Take the next valid command out of the received bytes (main loop)
+     * @param command Decoded command
+     * @return false if no complete command is waiting
+     */
+    bool poll(TelemetryProtocol::Command& command);
+
+    /**
+     * @brief DWT cycle stamp of the reception event that delivered the last
+     * command returned by poll()
+     */
+    uint32_t getCommandCycles() const { return command_cycles_; }
+
+    /**
+     * @brief Reception event - call from HAL_UARTEx_RxEventCallback
+     * @param position DMA write position in the buffer (1 .. BUFFER_SIZE)
+     */
+    void onRxEvent(uint16_t position);
+
+    /**
+     * @brief UART error - call from HAL_UART_ErrorCallback
+     *
+     * The HAL aborts a DMA reception on overrun, framing or noise errors;
+     * reception restarts at the beginning of the buffer.
+     */
+    void onError();
+
+    /**
+     * @brief Candidate frames that failed COBS, CRC or command checks
+     */
+    uint32_t getFrameErrors() const { return frame_errors_; }
+
+    /**
+     * @brief Times unread data was overwritten or reception had to restart
+     */
+    uint32_t getOverruns() const { return overruns_; }
+
+    /**
+     * @brief UART driven by this receiver
+     */
+    UART_HandleTypeDef* getUart() const { return huart_; }
+
+    /**
+     * @brief Receiver on the console UART (USART2, ST-LINK virtual COM port)
+     */
+    static CommandReceiver& console();
+
+private:
+    static constexpr uint32_t MASK = BUFFER_SIZE - 1;
+    static_assert((BUFFER_SIZE & MASK) == 0, "BUFFER_SIZE must be a power of two");
+    static_assert(BUFFER_SIZE <= 0xFFFF, "HAL reception size is 16 bits");
+
+    UART_HandleTypeDef* huart_;
+    uint8_t buffer_[BUFFER_SIZE];               // DMA target
+    uint8_t scratch_[MAX_ENCODED_FRAME];        // Frames that wrap around the buffer end
+    volatile uint32_t head_;                    // Free-running, bytes written by the DMA
+    volatile uint32_t event_cycles_;            // DWT stamp of the last reception event
+    volatile uint32_t restarts_;                // Reception restarts by onError()
+    uint16_t last_position_;                    // DMA position at the last event
+    uint32_t tail_;                             // Free-running, first byte of the open candidate
+    uint32_t scan_;                             // Free-running, next byte to scan
+    uint32_t seen_restarts_;
+    bool in_frame_;                             // Candidate opened by a delimiter
+    uint32_t command_cycles_;
+    uint32_t frame_errors_;
+    uint32_t overruns_;
+
+    bool decode(uint32_t start, uint32_t length, TelemetryProtocol::Command& command);
+    void discard(uint32_t head);
+};
+
+#endif /* INC_MODULES_COMM_COMMANDRECEIVER_HPP_ */
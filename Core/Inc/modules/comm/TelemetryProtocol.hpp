@@ -0,0 +1,238 @@
+#ifndef INC_MODULES_COMM_TELEMETRYPROTOCOL_HPP_
+#define INC_MODULES_COMM_TELEMETRYPROTOCOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Binary wire protocol between the controller and the host GUI
+ *
+ * Shared by the firmware and the Qt GUI (no HAL dependency).
+ *
+ * Framing: every message is a payload followed by its CRC-16/CCITT-FALSE
+ * (poly 0x1021, init 0xFFFF, little-endian), COBS-encoded and wrapped in
+ * 0x00 delimiters on both sides. The leading delimiter resynchronises the
+ * receiver after plain-text console output, which never contains 0x00;
+ * anything between delimiters that fails COBS, CRC or version checks is
+ * treated as text by the receiver.
+ *
+ * Payload header (all multi-byte fields little-endian):
+ *   [0] version  PROTOCOL_VERSION
+ *   [1] type     MessageType
+ *   [2] sequence Per-sender counter, echoed by ACK
+ *
+ * TELEMETRY body: a batch of samples taken at a fixed period
+ *   u32 t0_us, u16 period_us, u8 count, u8 reserved,
+ *   i32 target_position, i32 actual_position of sample 0 (POSITION_SCALE),
+ *   count x { i16 d_target, i16 d_actual (change since the previous sample,
+ *             POSITION_SCALE), f16 target_velocity, f16 actual_velocity,
+ *             i8 pid_output (percent, saturated), u8 phase }
+ *   10 bytes per sample against 50-80 for a "DATA,..." text line.
+ *
+ * COMMAND body: u8 opcode (CommandOpcode), 0-4 x f32 arguments
+ * ACK body:     u8 acked sequence, u8 opcode, u8 status (AckStatus), u32 value
+ *
+ * LOOP_TIMING body: control loop jitter and deadline misses since start,
+ *   sent about once a second; all fields u32/i32, times in core cycles
+ *   clock_hz, period, iterations, jitter_min, jitter_max, duration_max,
+ *   misses, lost_ticks, worst_iteration, worst_lateness, worst_duration,
+ *   worst_context, TIMING_BINS x histogram count (log2 of |jitter|)
+ */
+class TelemetryProtocol {
+public:
+    static constexpr uint8_t PROTOCOL_VERSION = 2;
+    static constexpr uint8_t DELIMITER = 0x00;
+
+    static constexpr float POSITION_SCALE = 64.0f;    // Position units per step
+    static constexpr uint32_t MAX_BATCH_SAMPLES = 32;
+    static constexpr uint32_t MAX_COMMAND_ARGS = 4;
+    static constexpr uint32_t TIMING_BINS = 16;
+
+    static constexpr size_t HEADER_SIZE = 3;
+    static constexpr size_t TELEMETRY_HEADER_SIZE = 16;
+    static constexpr size_t SAMPLE_SIZE = 10;
+    static constexpr size_t MAX_PAYLOAD = HEADER_SIZE + TELEMETRY_HEADER_SIZE + MAX_BATCH_SAMPLES * SAMPLE_SIZE;
+    static constexpr size_t MAX_COMMAND_PAYLOAD = HEADER_SIZE + 1 + MAX_COMMAND_ARGS * 4;
+    static constexpr size_t LOOP_TIMING_PAYLOAD = HEADER_SIZE + (12 + TIMING_BINS) * 4;
+    // Payload + CRC, COBS overhead (1 per 254 bytes) and two delimiters
+    static constexpr size_t MAX_FRAME = MAX_PAYLOAD + 2 + (MAX_PAYLOAD + 2) / 254 + 1 + 2;
+
+    enum class MessageType : uint8_t {
+        TELEMETRY = 0x01,
+        COMMAND = 0x02,
+        ACK = 0x03,
+        LOOP_TIMING = 0x04
+    };
+
+    enum class CommandOpcode : uint8_t {
+        GET_VERSION = 0x01,  // ACK value = PROTOCOL_VERSION
+        MOVE = 0x02,         // steps (relative), max_velocity, max_acceleration[, max_jerk]
+        START = 0x03,        // Run the planned move
+        STOP = 0x04,
+        ESTOP = 0x05,
+        HOME = 0x06,
+        SET_GAINS = 0x07,    // kp, ki, kd, kf
+        GET_PROFILE = 0x08   // [reset]: print the execution time probes, ACK value = control loop max
+    };
+
+    enum class AckStatus : uint8_t {
+        OK = 0,
+        REJECTED = 1,     // Valid command the controller cannot run now
+        UNKNOWN = 2,      // Opcode not supported
+        BAD_ARGS = 3      // Wrong argument count or value
+    };
+
+    struct Sample {
+        uint32_t time_us;
+        float target_position;   // steps
+        float actual_position;   // steps
+        float target_velocity;   // steps/sec
+        float actual_velocity;   // steps/sec
+        float pid_output;        // %, whole percent on the wire
+        uint8_t phase;           // Profile phase 1-7, 0 = idle
+    };
+
+    struct Command {
+        uint8_t sequence;
+        CommandOpcode opcode;
+        uint8_t arg_count;
+        float args[MAX_COMMAND_ARGS];
+    };
+
+    struct Ack {
+        uint8_t sequence;        // Sequence of the acknowledged command
+        CommandOpcode opcode;
+        AckStatus status;
+        uint32_t value;
+    };
+
+    struct LoopTiming {
+        uint32_t clock_hz;           // Cycle counter rate
+        uint32_t period_cycles;      // Nominal control period
+        uint32_t iterations;
+        int32_t jitter_min;          // Entry-to-entry minus period
+        int32_t jitter_max;
+        uint32_t duration_max;       // Entry to exit
+        uint32_t misses;             // Iterations that ended past their deadline
+        uint32_t lost_ticks;         // Timer updates that never ran
+        uint32_t worst_iteration;    // Latest miss
+        int32_t worst_lateness;      // Past the deadline, 0 = no miss
+        uint32_t worst_duration;
+        uint32_t worst_context;      // Firmware: profile phase (bits 0-7), queued moves (bits 8-15)
+        uint32_t histogram[TIMING_BINS];
+    };
+
+    /**
+     * @brief CRC-16/CCITT-FALSE (table driven)
+     */
+    static uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+    /**
+     * @brief Append the CRC, COBS-encode and delimit a payload
+     * @param payload Payload including the header
+     * @param length Payload length
+     * @param frame Output buffer
+     * @param capacity Output buffer size (MAX_FRAME is always enough)
+     * @return Frame length, 0 if it does not fit
+     */
+    static size_t encodeFrame(const uint8_t* payload, size_t length, uint8_t* frame, size_t capacity);
+
+    /**
+     * @brief Undo COBS and check CRC and version of the bytes between delimiters
+     * @param data Encoded bytes without delimiters
+     * @param length Number of encoded bytes
+     * @param payload Output buffer for the payload (without CRC), may be data
+     *                itself: decoding never writes ahead of what it has read
+     * @param capacity Output buffer size
+     * @return Payload length, 0 if the frame is invalid
+     */
+    static size_t decodeFrame(const uint8_t* data, size_t length, uint8_t* payload, size_t capacity);
+
+    /**
+     * @brief Message type of a decoded payload
+     */
+    static MessageType getType(const uint8_t* payload) { return static_cast<MessageType>(payload[1]); }
+
+    /**
+     * @brief Unpack a TELEMETRY payload
+     * @return Number of samples written, 0 if malformed
+     */
+    static uint32_t decodeTelemetry(const uint8_t* payload, size_t length, Sample* samples, uint32_t max_samples);
+
+    /**
+     * @brief Build a COMMAND frame
+     * @return Frame length, 0 on bad arguments
+     */
+    static size_t encodeCommand(const Command& command, uint8_t* frame, size_t capacity);
+    static bool decodeCommand(const uint8_t* payload, size_t length, Command& command);
+
+    /**
+     * @brief Build an ACK frame
+     * @return Frame length
+     */
+    static size_t encodeAck(const Ack& ack, uint8_t sequence, uint8_t* frame, size_t capacity);
+    static bool decodeAck(const uint8_t* payload, size_t length, Ack& ack);
+
+    /**
+     * @brief Build a LOOP_TIMING frame
+     * @return Frame length
+     */
+    static size_t encodeLoopTiming(const LoopTiming& timing, uint8_t sequence, uint8_t* frame, size_t capacity);
+    static bool decodeLoopTiming(const uint8_t* payload, size_t length, LoopTiming& timing);
+
+    /**
+     * @brief IEEE 754 half precision conversion (round to nearest even)
+     */
+    static uint16_t floatToHalf(float value);
+    static float halfToFloat(uint16_t half);
+};
+
+/**
+ * @brief Batches telemetry samples into TELEMETRY frames
+ *
+ * Positions are sent as deltas from the previous sample, tracked in the
+ * quantised units the receiver reconstructs, so rounding never drifts. A
+ * batch is closed early when the next sample breaks the fixed period or its
+ * delta does not fit 16 bits; every frame is self-contained, so a lost frame
+ * costs only its own samples.
+ */
+class TelemetryEncoder {
+public:
+    TelemetryEncoder();
+
+    /**
+     * @brief Add a sample
+     * @param sample Sample to add
+     * @param period_us Nominal sample period
+     * @return true if a frame was completed (read it with getFrame())
+     *
+     * When the sample cannot join the open batch, the batch is closed into
+     * a frame and the sample starts the next one.
+     */
+    bool add(const TelemetryProtocol::Sample& sample, uint16_t period_us);
+
+    /**
+     * @brief Close the open batch into a frame, if it has samples
+     * @return true if a frame was completed
+     */
+    bool flush();
+
+    const uint8_t* getFrame() const { return frame_; }
+    size_t getFrameLength() const { return frame_length_; }
+
+private:
+    uint8_t payload_[TelemetryProtocol::MAX_PAYLOAD];
+    uint8_t frame_[TelemetryProtocol::MAX_FRAME];
+    size_t frame_length_;
+    uint32_t count_;
+    uint32_t next_time_us_;
+    uint16_t period_us_;
+    int32_t last_target_;   // Quantised position of the previous sample
+    int32_t last_actual_;
+    uint8_t sequence_;
+
+    void begin(const TelemetryProtocol::Sample& sample, uint16_t period_us);
+    bool append(const TelemetryProtocol::Sample& sample);
+};
+
+#endif /* INC_MODULES_COMM_TELEMETRYPROTOCOL_HPP_ */
@@ -0,0 +1,157 @@
+#ifndef INC_MODULES_HAL_CYCLEPROFILER_HPP_
+#define INC_MODULES_HAL_CYCLEPROFILER_HPP_
+
+#include <cstdint>
+
+#ifdef HOST_SIM
+#include <chrono>
+#else
+#include "main.h"
+#endif
+
+// 0 = compile every PROFILE_SCOPE() out
+#ifndef CYCLE_PROFILER_ENABLED
+#define CYCLE_PROFILER_ENABLED 1
+#endif
+
+/**
+ * @brief Execution time probes on the DWT cycle counter
+ *
+ * A probe is a fixed slot of statistics in static RAM: count, min, max,
+ * total (for the mean) and a log2 histogram, where bin k counts
+ * measurements of [2^k, 2^(k+1)) ticks and bin 0 also takes 0. A
+ * ScopedProbe (or PROFILE_SCOPE()) measures the enclosing block and records
+ * it on exit; the probe's own cost, measured once by init(), is subtracted.
+ * Nested probes are included in the outer measurement, so CONTROL_LOOP is
+ * the instrumented worst case.
+ *
+ * Ticks are core cycles on the target (DWT->CYCCNT, wraps after 51 s at
+ * 84 MHz, so one measurement must stay shorter than that). The host
+ * simulation has no cycle-accurate core, so there the back end is
+ * std::chrono::steady_clock and ticks are nanoseconds of host time.
+ *
+ * record() may be called from any context; it masks interrupts only while
+ * updating the slot. report() prints from the main loop through printf().
+ *
+ * Requirements: init() before the first measurement (starts the DWT cycle
+ * counter on the target).
+ */
+class CycleProfiler {
+public:
+    enum class Probe : uint8_t {
+        CONTROL_LOOP,          // Whole TIM4 control tick
+        PLANNER_UPDATE,        // MotionPlanner::update()
+        COORDINATOR_UPDATE,    // MultiAxisCoordinator::update()
+        PROFILE_EVALUATE,      // SCurveProfile::getStateAtTime()
+        PROFILE_STEP,          // SCurveStepper::step()
+        PWM_UPDATE,            // StepperMotor::updatePWMFrequency()
+        MOVE_START,            // MotionPlanner taking over a queued move
+        COUNT
+    };
+
+    static constexpr uint32_t PROBE_COUNT = static_cast<uint32_t>(Probe::COUNT);
+    static constexpr uint32_t HISTOGRAM_BINS = 24;   // Last bin also takes everything longer
+
+    struct Stats {
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+        uint64_t total;
+        uint32_t histogram[HISTOGRAM_BINS];
+    };
+
+    /**
+     * @brief Start the tick source and measure the probe overhead
+     */
+    static void init();
+
+    /**
+     * @brief Current tick count
+     */
+    static inline uint32_t now() {
+#ifdef HOST_SIM
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+        return DWT->CYCCNT;
+#endif
+    }
+
+    /**
+     * @brief Ticks per second of now()
+     */
+    static uint32_t getTickRate();
+
+    /**
+     * @brief Add one measurement to a probe
+     * @param probe Probe slot
+     * @param ticks Elapsed ticks, probe overhead included
+     */
+    static void record(Probe probe, uint32_t ticks);
+
+    /**
+     * @brief Copy of a probe's statistics, consistent even while it records
+     */
+    static Stats getStats(Probe probe);
+
+    /**
+     * @brief Clear all probes
+     */
+    static void reset();
+
+    /**
+     * @brief Pause or resume recording (ScopedProbe does nothing while paused)
+     */
+    static void setEnabled(bool enabled) { enabled_ = enabled; }
+    static bool isEnabled() { return enabled_; }
+
+    /**
+     * @brief Print every probe that has measurements
+     * @param budget_hz Rate the CONTROL_LOOP probe must sustain; its worst
+     *                  case is reported against 1/budget_hz (0 = no check)
+     * @return false if CONTROL_LOOP exceeded the budget
+     */
+    static bool report(uint32_t budget_hz);
+
+    static const char* getName(Probe probe);
+
+    /**
+     * @brief Measures the enclosing scope into one probe
+     */
+    class ScopedProbe {
+    public:
+        explicit ScopedProbe(Probe probe)
+            : probe_(probe)
+            , active_(enabled_)
+            , start_(active_ ? now() : 0)
+        {
+        }
+
+        ~ScopedProbe() {
+            if (active_) {
+                record(probe_, now() - start_);
+            }
+        }
+
+        ScopedProbe(const ScopedProbe&) = delete;
+        ScopedProbe& operator=(const ScopedProbe&) = delete;
+
+    private:
+        Probe probe_;
+        bool active_;
+        uint32_t start_;
+    };
+
+private:
+    static Stats stats_[PROBE_COUNT];
+    static uint32_t overhead_;
+    static volatile bool enabled_;
+};
+
+#if CYCLE_PROFILER_ENABLED
+#define PROFILE_SCOPE(probe) CycleProfiler::ScopedProbe profile_scope_(CycleProfiler::Probe::probe)
+#else
+#define PROFILE_SCOPE(probe) ((void)0)
+#endif
+
+#endif /* INC_MODULES_HAL_CYCLEPROFILER_HPP_ */
@@ -0,0 +1,75 @@
+#ifndef INC_MODULES_HAL_GPIOPIN_HPP_
+#define INC_MODULES_HAL_GPIOPIN_HPP_
+
+#include "stm32f4xx_hal.h"
+#include <cstdint>
+
+/**
+ * @brief GPIO ports of the STM32F411
+ */
+enum class GpioPort : uint8_t {
+    A,
+    B,
+    C,
+    D,
+    E,
+    H
+};
+
+/**
+ * @brief Output pin fixed at compile time
+ *
+ * Port, pin and polarity are template parameters, so write() is one BSRR
+ * store of a constant (set or reset half chosen by a select, no branch and
+ * no call) instead of HAL_GPIO_WritePin() with runtime port, pin and
+ * polarity. The pin must be configured as an output beforehand (CubeMX).
+ *
+ * @tparam PORT GPIO port
+ * @tparam PIN Pin mask, a single GPIO_PIN_x
+ * @tparam ACTIVE_LOW true if the active level is LOW
+ */
+template <GpioPort PORT, uint16_t PIN, bool ACTIVE_LOW = false>
+class GpioPin {
+    static_assert(PIN != 0 && (PIN & (PIN - 1)) == 0, "PIN must be a single GPIO_PIN_x");
+
+public:
+    static constexpr GpioPort port_id = PORT;
+    static constexpr uint16_t pin = PIN;
+    static constexpr bool active_low = ACTIVE_LOW;
+
+    static GPIO_TypeDef* port() {
+        if constexpr (PORT == GpioPort::A) {
+            return GPIOA;
+        } else if constexpr (PORT == GpioPort::B) {
+            return GPIOB;
+        } else if constexpr (PORT == GpioPort::C) {
+            return GPIOC;
+        } else if constexpr (PORT == GpioPort::D) {
+            return GPIOD;
+        } else if constexpr (PORT == GpioPort::E) {
+            return GPIOE;
+        } else {
+            return GPIOH;
+        }
+    }
+
+    /**
+     * @brief Drive the pin to its active (true) or inactive level
+     */
+    static void write(bool active) {
+        port()->BSRR = (active != ACTIVE_LOW) ? SET_MASK : RESET_MASK;
+    }
+
+    /**
+     * @brief Whether the output is at its active level (from ODR)
+     */
+    static bool isActive() {
+        return ((port()->ODR & PIN) != 0) != ACTIVE_LOW;
+    }
+
+private:
+    static constexpr uint32_t SET_MASK = PIN;
+    static constexpr uint32_t RESET_MASK = static_cast<uint32_t>(PIN) << 16;
+};
+
+#endif /* INC_MODULES_HAL_GPIOPIN_HPP_ */
@@ -0,0 +1,81 @@
+#ifndef INC_MODULES_HAL_LOOPTIMINGRECORDER_HPP_
+#define INC_MODULES_HAL_LOOPTIMINGRECORDER_HPP_
+
+#include <cstdint>
+
+/**
+ * @brief Period jitter and deadline misses of a periodic interrupt
+ *
+ * The handler passes a DWT cycle stamp on entry and on exit of every
+ * iteration. Jitter is the distance between two entries minus the nominal
+ * period; its magnitude goes into a log2 histogram (bin k counts
+ * [2^k, 2^(k+1)) cycles, bin 0 also takes 0) next to the signed extremes.
+ *
+ * Deadlines: iteration n is due at the first entry plus n periods and must
+ * exit one period later, before the next timer update. An exit past that is
+ * a miss; the latest one is kept with its iteration number, duration and a
+ * caller-supplied context word. An entry a whole period late means timer
+ * updates were lost (the handler ran too long or interrupts were masked):
+ * they are counted and the schedule moves on to the current tick.
+ *
+ * onEntry()/onExit() belong to one interrupt handler; getSnapshot() and
+ * reset() may run from the main loop (they mask interrupts briefly).
+ */
+class LoopTimingRecorder {
+public:
+    static constexpr uint32_t HISTOGRAM_BINS = 16;   // Last bin also takes everything larger
+
+    struct Snapshot {
+        uint32_t period_cycles;     // Nominal period
+        uint32_t iterations;
+        int32_t jitter_min;         // Cycles, entry-to-entry minus period
+        int32_t jitter_max;
+        uint32_t duration_max;      // Cycles, entry to exit
+        uint32_t misses;            // Iterations that exited past their deadline
+        uint32_t lost_ticks;        // Timer updates that never ran
+        uint32_t worst_iteration;   // Latest miss
+        int32_t worst_lateness;     // Cycles past the deadline, 0 if no miss yet
+        uint32_t worst_duration;
+        uint32_t worst_context;
+        uint32_t histogram[HISTOGRAM_BINS];
+    };
+
+    LoopTimingRecorder();
+
+    /**
+     * @brief Forget everything and arm for a new schedule
+     * @param period_cycles Nominal period in DWT cycles
+     */
+    void start(uint32_t period_cycles);
+
+    /**
+     * @brief Iteration entry - first thing in the handler
+     * @param cycles DWT->CYCCNT
+     */
+    void onEntry(uint32_t cycles);
+
+    /**
+     * @brief Iteration exit - last thing in the handler
+     * @param cycles DWT->CYCCNT
+     * @param context Kept with the worst miss (what the loop was doing)
+     */
+    void onExit(uint32_t cycles, uint32_t context);
+
+    /**
+     * @brief Consistent copy of the statistics
+     */
+    Snapshot getSnapshot() const;
+
+    /**
+     * @brief Clear the statistics, keeping period and schedule
+     */
+    void reset();
+
+private:
+    Snapshot stats_;
+    uint32_t last_entry_;
+    uint32_t due_;              // Scheduled entry of the running iteration
+    bool started_;              // First entry seen
+};
+
+#endif /* INC_MODULES_HAL_LOOPTIMINGRECORDER_HPP_ */
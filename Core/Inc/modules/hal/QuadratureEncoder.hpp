@@ -0,0 +1,54 @@
+#ifndef INC_MODULES_HAL_QUADRATUREENCODER_HPP_
+#define INC_MODULES_HAL_QUADRATUREENCODER_HPP_
+
+#include "stm32f4xx_hal.h"
+#include <cstdint>
+
+/**
+ * @brief Quadrature encoder on a 16-bit timer in encoder mode, extended to 32 bits
+ *
+ * The timer counts A/B edges in hardware (CubeMX: encoder mode TI1 and TI2,
+ * x4, ARR = 0xFFFF) and its counter wraps every 65536 counts. getCount()
+ * folds the signed change of CNT since the last read into a 32-bit count,
+ * so it must be called at least once per 32768 counts of travel; the
+ * control loop reads it every tick, which covers any encoder speed the
+ * input filters pass.
+ */
+class QuadratureEncoder {
+public:
+    struct Config {
+        TIM_HandleTypeDef* timer;  // Encoder mode, counter at least 16 bits
+        bool invert = false;       // Count down when the motor turns forward
+    };
+
+    /**
+     * @brief Construct the encoder and start its timer, count zero
+     * @param config Hardware configuration
+     */
+    explicit QuadratureEncoder(const Config& config);
+
+    /**
+     * @brief Position in encoder counts (ISR safe)
+     */
+    int32_t getCount();
+
+    /**
+     * @brief Set the position, e.g. after homing (ISR safe)
+     */
+    void setCount(int32_t count);
+
+    /**
+     * @brief Check that the timer started in encoder mode
+     */
+    bool isRunning() const { return running_; }
+
+private:
+    Config config_;
+    bool running_;
+    int32_t count_;       // Position up to count_last_
+    uint16_t count_last_;  // CNT at the last read
+
+    void accumulate();
+};
+
+#endif /* INC_MODULES_HAL_QUADRATUREENCODER_HPP_ */
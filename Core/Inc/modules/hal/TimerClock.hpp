@@ -0,0 +1,58 @@
+#ifndef INC_MODULES_HAL_TIMERCLOCK_HPP_
+#define INC_MODULES_HAL_TIMERCLOCK_HPP_
+
+#include "stm32f4xx_hal.h"
+#include <cstdint>
+
+/**
+ * @brief Timer kernel clocks and prescaler/period selection (STM32F411)
+ *
+ * getClock() follows the RCC clock tree for the timer's bus instead of
+ * assuming one: TIM1 and TIM9-11 sit on APB2, TIM2-5 on APB1. A timer
+ * runs at its PCLK when that APB is undivided and at twice PCLK when it
+ * is divided; with RCC_DCKCFGR.TIMPRE set the multiplier becomes four
+ * (capped at HCLK).
+ *
+ * solve() picks the PSC/ARR pair that comes closest to a frequency: the
+ * smallest prescaler that lets the period fit the counter (so the period,
+ * i.e. the resolution, is as large as possible), then the nearest period.
+ * The relative error is at most half a counter tick over the period, e.g.
+ * 0.5 / 420 at 200 kHz from 84 MHz; 32-bit timers (TIM2, TIM5) need no
+ * prescaler down to clock / 2^32.
+ */
+class TimerClock {
+public:
+    static constexpr uint32_t MAX_PRESCALER = 0xFFFF;
+
+    struct Setting {
+        uint32_t prescaler;     // PSC value (clock divided by prescaler + 1)
+        uint32_t period;        // Counter ticks per cycle (ARR + 1)
+        float frequency;        // Achieved (Hz)
+        float error;            // Relative: achieved / requested - 1
+    };
+
+    /**
+     * @brief Counter clock of a timer before its prescaler (Hz)
+     */
+    static uint32_t getClock(const TIM_TypeDef* instance);
+
+    /**
+     * @brief Longest period the counter supports (ARR + 1): 2^16, or 2^32 - 1 on TIM2/TIM5
+     */
+    static uint32_t getMaxPeriod(const TIM_TypeDef* instance);
+
+    /**
+     * @brief Closest PSC/ARR pair for a frequency
+     * @param clock Counter clock (Hz), e.g. from getClock()
+     * @param frequency Requested frequency (Hz, > 0)
+     * @param max_period Longest period the counter supports
+     * @param min_period Shortest period allowed (e.g. 2 for a PWM pulse)
+     * @param setting Chosen values with the achieved frequency and error
+     * @return false if the frequency is out of reach (setting then holds
+     *         the nearest end of the range)
+     */
+    static bool solve(uint32_t clock, float frequency, uint32_t max_period, uint32_t min_period,
+                      Setting& setting);
+};
+
+#endif /* INC_MODULES_HAL_TIMERCLOCK_HPP_ */
@@ -0,0 +1,108 @@
+#ifndef INC_MODULES_HAL_UARTLOGSINK_HPP_
+#define INC_MODULES_HAL_UARTLOGSINK_HPP_
+
+#include "main.h"
+#include <cstdint>
+
+/**
+ * @brief Non-blocking log output over UART TX DMA
+ *
+ * write() copies the bytes into a ring buffer and returns; the DMA stream
+ * drains the buffer in the background, and each transfer-complete interrupt
+ * starts the next chunk. Callers never wait for the UART, so printf()
+ * from the main loop or an interrupt handler costs a memcpy instead of
+ * ~87 us per byte at 115200 baud.
+ *
+ * Overflow policy: a write that does not fit into the free space is
+ * dropped as a whole (newest data is lost, queued bytes are never
+ * overwritten and lines are never spliced). Dropped writes and bytes are
+ * counted so the loss is visible.
+ *
+ * write() may be called from any context; it masks interrupts only while
+ * reserving and copying its bytes.
+ *
+ * Requirements: huart TX linked to a DMA stream in normal mode, UART and
+ * DMA stream interrupts enabled, HAL_UART_TxCpltCallback forwarded to
+ * onTransferComplete() (done by this module for the console sink) and
+ * HAL_UART_ErrorCallback to onError() (done by comm/CommandReceiver, which
+ * shares the console UART).
+ */
+class UartLogSink {
+public:
+    static constexpr uint32_t BUFFER_SIZE = 2048;    // Bytes, power of two
+    static constexpr uint32_t MAX_TRANSFER = 256;    // Bytes per DMA transfer
+
+    explicit UartLogSink(UART_HandleTypeDef* huart);
+
+    // Sink owns the UART TX DMA stream
+    UartLogSink(const UartLogSink&) = delete;
+    UartLogSink& operator=(const UartLogSink&) = delete;
+
+    /**
+     * @brief Queue bytes for transmission (never blocks)
+     * @param data Bytes to send
+     * @param length Number of bytes
+     * @return false if the write was dropped for lack of buffer space
+     */
+    bool write(const char* data, uint32_t length);
+
+    /**
+     * @brief Wait until everything queued has been sent
+     * @param timeout_ms Give up after this long
+     * @return true if the buffer drained in time
+     *
+     * Main loop only (e.g. before a reset); needs the UART interrupts.
+     */
+    bool flush(uint32_t timeout_ms);
+
+    /**
+     * @brief DMA transfer finished - call from HAL_UART_TxCpltCallback
+     */
+    void onTransferComplete();
+
+    /**
+     * @brief UART error aborted the transfer - call from HAL_UART_ErrorCallback
+     */
+    void onError();
+
+    /**
+     * @brief Bytes waiting or in flight
+     */
+    uint32_t getPending() const { return head_ - tail_; }
+
+    /**
+     * @brief Writes dropped by the overflow policy since start-up
+     */
+    uint32_t getDroppedWrites() const { return dropped_writes_; }
+
+    /**
+     * @brief Bytes dropped by the overflow policy since start-up
+     */
+    uint32_t getDroppedBytes() const { return dropped_bytes_; }
+
+    /**
+     * @brief UART driven by this sink
+     */
+    UART_HandleTypeDef* getUart() const { return huart_; }
+
+    /**
+     * @brief Sink behind printf() (USART2, ST-LINK virtual COM port)
+     */
+    static UartLogSink& console();
+
+private:
+    static constexpr uint32_t MASK = BUFFER_SIZE - 1;
+    static_assert((BUFFER_SIZE & MASK) == 0, "BUFFER_SIZE must be a power of two");
+
+    UART_HandleTypeDef* huart_;
+    uint8_t buffer_[BUFFER_SIZE];
+    volatile uint32_t head_;         // Free-running, next byte to write
+    volatile uint32_t tail_;         // Free-running, first byte not yet sent
+    volatile uint32_t in_flight_;    // Bytes of the current DMA transfer (0 = idle)
+    volatile uint32_t dropped_writes_;
+    volatile uint32_t dropped_bytes_;
+
+    void startTransfer();
+};
+
+#endif /* INC_MODULES_HAL_UARTLOGSINK_HPP_ */
@@ -2,7 +2,12 @@
 #define INC_MODULES_MOTOR_MOTIONPLANNER_HPP_
 
 #include "motor/SCurveProfile.hpp"
+#include "motor/SCurveStepper.hpp"
+#include "motor/SpscQueue.hpp"
+#include "motor/StepPulseEngine.hpp"
+#include "motor/VelocityRamp.hpp"
 #include "stm32f4xx_hal.h"
+#include <atomic>
 #include <cstdint>
 
 /**
@@ -10,6 +15,53 @@
  * 
  * Executes S-curve motion profiles in real-time using timer interrupts.
  * Updates motor speed dynamically to follow the calculated trajectory.
+ * 
+ * The control-loop timer (TIM4) is reprogrammed by init() for the requested
+ * rate and its update interrupt must call update(). Profile time advances by
+ * one fixed period per call (SCurveStepper), so the loop is independent of
+ * SysTick and each update is a few multiply-adds.
+ * 
+ * Moves can also be queued with queueMove(): each is planned in the
+ * caller's context and pushed into a lock-free SPSC ring with its profile,
+ * and update() starts the next one on the tick the current profile
+ * completes, so back-to-back moves run without a dead tick or a main-loop
+ * round trip. Starting one costs update() a profile copy, and in DMA step
+ * engine mode the first table fill (StepPulseEngine::BUFFER_STEPS steps);
+ * the MOVE_START probe measures it.
+ * 
+ * Queued moves are blended: each push revisits up to LOOKAHEAD_MOVES
+ * queued moves before the new one (backward pass from a stop after it, as
+ * in GRBL's planner, then forward from the oldest one's entry) and stores
+ * in the segments the highest junction velocities from which everything
+ * queued can still stop. A junction is fixed once the move before it has
+ * started, so update() takes over the stored profiles as they are. Moves
+ * that reverse direction meet at rest; so do moves in DMA step engine
+ * mode, where the engine restarts between moves.
+ * 
+ * The hand-off uses atomics only. Each queued move holds two plans: a push
+ * writes the spare one and swaps it in with a compare-exchange, newest
+ * move first, and update() locks the current one as it starts the move.
+ * A swap that loses to the start is dropped, and a move that then starts
+ * slower than its plan assumed has its exit velocity lowered to what it
+ * can reach (one profile solve in update(), only after such a race).
+ * stop(), retarget() and jog() drop queued moves through
+ * SpscQueue::discard(), which the ISR applies.
+ * 
+ * moveTo() while a move runs retargets it in place (retarget()): the new
+ * profile starts from the position, velocity and acceleration of the
+ * current tick and replaces the old one before the next tick, so a target
+ * that changes every few control periods costs no stop.
+ * 
+ * jog() runs the axis in velocity mode instead: update() ramps towards a
+ * streamed velocity setpoint (VelocityRamp) under jerk and acceleration
+ * limits, reversing through zero, with no position target. A jog takes
+ * over a running move from its live state, and moveTo() takes over a jog
+ * the same way.
+ * 
+ * Two ways to stop: stop() cuts the step rate at once (emergency stop,
+ * steps may be lost at speed); decelerateToStop() switches the running
+ * move mid-profile onto a jerk-limited ramp to rest computed from its live
+ * velocity and acceleration, within the move's own limits.
  */
 class MotionPlanner {
 public:
@@ -20,20 +72,28 @@ public:
         ERROR
     };
     
+    static constexpr uint32_t MIN_UPDATE_FREQ_HZ = 1000;
+    static constexpr uint32_t MAX_UPDATE_FREQ_HZ = 10000;
+    static constexpr uint32_t QUEUE_CAPACITY = 8;  // Queued moves (power of two)
+    static constexpr uint32_t LOOKAHEAD_MOVES = 4;  // Queued moves considered per junction
+    
     struct Status {
         State state;
-        float current_position;
+        float current_position;  // Counted with a position callback, planned otherwise
+        float commanded_position;  // Planned along the profile
         float current_velocity;
         float target_position;
         float progress;  // 0.0 to 1.0
+        uint32_t phase;  // Profile phase (1-7) of the running move, 0 otherwise
+        uint32_t queue_depth;  // Moves waiting behind the current one
     };
 
     MotionPlanner();
     
     /**
-     * @brief Initialize motion planner
-     * @param htim Timer handle for position updates
-     * @param update_freq_hz Update frequency (Hz), typically 1000-10000
+     * @brief Initialize motion planner and start the control-loop timer
+     * @param htim Timer handle for position updates (nullptr: caller drives update())
+     * @param update_freq_hz Update frequency (Hz), clamped to 1000-10000
      */
     void init(TIM_HandleTypeDef* htim, uint32_t update_freq_hz);
     
@@ -44,15 +104,98 @@ public:
      * @param max_acceleration Maximum acceleration (steps/sec²)
      * @param max_jerk Maximum jerk (steps/sec³)
      * @return true if motion started successfully
+     * 
+     * While a move runs this is retarget(), which discards queued moves.
      */
     bool moveTo(float target_steps, float max_velocity, 
                 float max_acceleration, float max_jerk);
     
     /**
-     * @brief Stop current motion
+     * @brief Replace the running move's target and limits mid-motion
+     * @param target_steps New target position in steps
+     * @param max_velocity Maximum velocity (steps/sec)
+     * @param max_acceleration Maximum acceleration (steps/sec²)
+     * @param max_jerk Maximum jerk (steps/sec³)
+     * @return false if the limits are invalid or in step engine mode (the
+     *         running move is unchanged then)
+     * 
+     * Still heading for the target with room to stop: a profile starting
+     * from the live velocity and acceleration takes over. Target behind, too close to stop for, or the
+     * velocity above the new max_velocity: a stop ramp (as in
+     * decelerateToStop()) is followed by a move from rest. Queued moves are
+     * discarded. Starts a move as moveTo() does when none is running.
+     * 
+     * The profiles are solved with the control-loop interrupt running, from
+     * the state of the last tick; it is masked only to take them over.
+     */
+    bool retarget(float target_steps, float max_velocity,
+                  float max_acceleration, float max_jerk);
+    
+    /**
+     * @brief Run at a velocity, or change the velocity of a running jog
+     * @param velocity Setpoint (steps/sec, signed: negative is reverse)
+     * @param max_acceleration Maximum acceleration (steps/sec²)
+     * @param max_jerk Maximum jerk (steps/sec³)
+     * @return false if a limit is not positive or in step engine mode
+     *         (nothing is changed then)
+     * 
+     * Meant to be called whenever the setpoint changes; each call only
+     * replaces the setpoint and limits, and the control loop ramps to it.
+     * A running move is taken over at its live velocity and acceleration
+     * and queued moves are discarded. The jog completes once a setpoint of
+     * zero is reached.
+     */
+    bool jog(float velocity, float max_acceleration, float max_jerk);
+    
+    /**
+     * @brief Check if the planner is in velocity mode (jog())
+     */
+    bool isJogging() const { return state_ == State::RUNNING && jogging_; }
+    
+    /**
+     * @brief Queue a move to start when the previous one completes
+     * @param target_steps Target position in steps
+     * @param max_velocity Maximum velocity (steps/sec)
+     * @param max_acceleration Maximum acceleration (steps/sec²)
+     * @param max_jerk Maximum jerk (steps/sec³)
+     * @return false if the queue is full or the profile is invalid
+     * 
+     * Producer side of the queue: call from one (non-ISR) context only.
+     * The move starts from the target of the last queued or started move.
+     * Junction velocities and profiles of the moves still queued are
+     * replanned here, without masking the control-loop interrupt.
+     * Rejected while jogging, which has no target to continue from.
+     */
+    bool queueMove(float target_steps, float max_velocity,
+                   float max_acceleration, float max_jerk);
+    
+    /**
+     * @brief Moves waiting in the queue
+     */
+    uint32_t getQueueDepth() const { return queue_.size(); }
+    
+    /**
+     * @brief Stop current motion at once and discard queued moves
      */
     void stop();
     
+    /**
+     * @brief Ramp the running move down to rest and discard queued moves
+     * @return false if there is no move to ramp down (nothing is changed);
+     *         call stop() then
+     * 
+     * The move continues on the stop ramp (profile phases 5-7) and
+     * completes at rest like any other move. A jog ramps to a setpoint of
+     * zero within its limits. Not available in step engine
+     * mode, where the profile is already in the DMA table.
+     */
+    bool decelerateToStop();
+    
+    /**
+     * @brief Check if the running move is a stop ramp from decelerateToStop()
+     */
+    bool isStopping() const { return state_ == State::RUNNING && stopping_; }
+    
     /**
      * @brief Get current status
      */
@@ -71,34 +214,134 @@ public:
     void setDirectionCallback(void (*callback)(bool forward));
     
     /**
-     * @brief Check if motion is complete
+     * @brief Read the position from a hardware step counter
+     * @param callback Counted position (steps), or nullptr to use the planned one
+     * 
+     * The counted position is then authoritative: getStatus() reports it,
+     * moveTo() plans from it and stop() adopts it, so steps the profile and
+     * the emitted pulses disagree on do not add up over moves. A position
+     * given to setPosition() must also be loaded into the counter.
+     */
+    void setPositionCallback(int32_t (*callback)());
+    
+    /**
+     * @brief Emit steps through a DMA step engine instead of the speed callback
+     * @param engine Engine on the step timer, or nullptr for speed callback mode
+     * 
+     * In engine mode moveTo() hands the whole profile to the engine and
+     * update() only tracks the planned state; the move completes when the
+     * engine has emitted its last step. Only change while idle.
+     */
+    void setStepEngine(StepPulseEngine* engine) { step_engine_ = engine; }
+    
+    /**
+     * @brief DMA step engine in use (nullptr in speed callback mode)
+     */
+    StepPulseEngine* getStepEngine() const { return step_engine_; }
+    
+    /**
+     * @brief Control-loop timer driving update() (nullptr if none)
+     */
+    TIM_HandleTypeDef* getTimer() const { return htim_; }
+    
+    /**
+     * @brief Actual update rate after timer quantisation (Hz)
+     */
+    float getUpdateFrequency() const { return 1.0f / dt_; }
+    
+    /**
+     * @brief Check if motion is complete (including queued moves)
      */
-    bool isComplete() const { return state_ == State::COMPLETED || state_ == State::IDLE; }
+    bool isComplete() const {
+        return (state_ == State::COMPLETED || state_ == State::IDLE) && queue_.empty();
+    }
     
     /**
      * @brief Reset position to zero
      */
-    void resetPosition() { current_position_ = 0.0f; }
+    void resetPosition() { setPosition(0.0f); }
+    
+    /**
+     * @brief Set position (steps), e.g. after the axis was moved elsewhere
+     */
+    void setPosition(float steps) {
+        current_position_ = steps;
+        planned_position_ = steps;
+    }
 
 private:
+    // A profile of a queued move between two junction velocities
+    struct Plan {
+        SCurveProfile profile;
+        float entry_velocity;  // Junction with the move before (steps/sec)
+        float exit_velocity;   // Junction with the move after, 0 if last
+    };
+    
+    // A queued move, built in its slot by pushSegment()
+    struct Segment {
+        SCurveProfile::Config limits;
+        float target_position;
+        float distance;  // Steps from the previous move's target (> 0)
+        bool forward;
+        Plan plans[2];  // Current and spare
+        mutable std::atomic<uint8_t> plan;  // Index of the current one, | PLAN_STARTED once update() took it
+    };
+    static constexpr uint8_t PLAN_STARTED = 0x80;
+    
+    // A move of the window pushSegment() replans, oldest first
+    struct WindowMove {
+        Segment* segment;
+        uint8_t plan;  // Its current plan when looked at
+        float entry_velocity;
+        float exit_velocity;
+    };
+    
     SCurveProfile profile_;
-    State state_;
+    SCurveStepper stepper_;  // Walks profile_ one control period per update()
+    volatile State state_;  // Written by update() in the timer ISR
     
     float current_position_;
     float current_velocity_;
     float target_position_;
+    float start_position_;
+    float direction_;  // +1 forward, -1 reverse
+    float planned_position_;  // End of the last started or queued move (producer only)
+    volatile uint32_t ticks_;  // update() calls, compared by retarget() across its solves
+    float exit_velocity_;  // End velocity of the running move (consumer only)
+    SCurveProfile::Config limits_;  // Limits of the running move
+    volatile bool stopping_;  // Running move is a stop ramp
+    VelocityRamp jog_;  // Velocity mode state, stepped by update()
+    volatile bool jogging_;  // Running in velocity mode
+    
+    SpscQueue<Segment, QUEUE_CAPACITY> queue_;  // Producer: queueMove(), consumer: update()
+    WindowMove window_[LOOKAHEAD_MOVES + 1];  // Junction replanning scratch (producer only)
     
-    uint32_t start_time_ms_;
     uint32_t update_freq_hz_;
     float dt_;  // Time step (seconds)
     
     TIM_HandleTypeDef* htim_;
+    StepPulseEngine* step_engine_;
     
     // Callbacks for motor control
     void (*speed_callback_)(float speed);
     void (*direction_callback_)(bool forward);
+    int32_t (*position_callback_)();
     
+    static bool buildSegment(Segment& segment, float from, float target_steps, float max_velocity,
+                             float max_acceleration, float max_jerk);
+    bool pushSegment(float target_steps, float max_velocity,
+                     float max_acceleration, float max_jerk);
+    static void planJunctions(WindowMove* window, uint32_t count);
+    bool startQueuedMove(float start_time);
+    bool startMove(const Segment& segment, float start_time);
+    void startTransition(const SCurveProfile& transition, const SCurveProfile::Config& limits);
+    void updateJog();
+    SCurveProfile::State liveState() const;
     void updateMotorSpeed(float velocity);
+    float measuredPosition() const;
+    void configureTimer();
+    void maskUpdates();
+    void unmaskUpdates();
 };
 
 #endif /* INC_MODULES_MOTOR_MOTIONPLANNER_HPP_ */
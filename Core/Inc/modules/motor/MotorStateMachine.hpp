@@ -1,21 +1,33 @@
 #ifndef INC_MODULES_MOTOR_MOTORSTATEMACHINE_HPP_
 #define INC_MODULES_MOTOR_MOTORSTATEMACHINE_HPP_
 
+#include <atomic>
 #include <cstdint>
-#include <functional>
+#include "motor/MpscQueue.hpp"
 
 /**
  * @brief Motor control state machine
  * 
  * Manages motor states and transitions with proper event handling.
  * Ensures safe state transitions and provides hooks for state entry/exit.
+ *
+ * Transitions come from one constexpr table, checked at compile time (no
+ * duplicate entries, every state reachable from UNINITIALIZED, none without
+ * a way out) and flattened into a [state][event] lookup, so an event costs
+ * one array read plus the callbacks. Callbacks are plain function pointers:
+ * nothing is allocated and nothing is printed here.
+ *
+ * Contexts: post() may be called from any interrupt handler (lock-free
+ * queue). processEvent(), dispatch() and reset() belong to one consumer
+ * context, normally the main loop; processEvent() dispatches what is queued
+ * first, so events keep their order.
  */
 class MotorStateMachine {
 public:
     /**
      * @brief Motor control states
      */
-    enum class State {
+    enum class State : uint8_t {
         UNINITIALIZED,  // System not ready
         IDLE,           // Motor disabled, ready to enable
         READY,          // Motor enabled, waiting for command
@@ -30,7 +42,7 @@ public:
     /**
      * @brief Events that trigger state transitions
      */
-    enum class Event {
+    enum class Event : uint8_t {
         INITIALIZE,     // System initialization complete
         ENABLE,         // Enable motor driver
         DISABLE,        // Disable motor driver
@@ -44,27 +56,49 @@ public:
         HOME_COMPLETE   // Homing finished
     };
     
+    static constexpr uint32_t STATE_COUNT = static_cast<uint32_t>(State::HOMING) + 1;
+    static constexpr uint32_t EVENT_COUNT = static_cast<uint32_t>(Event::HOME_COMPLETE) + 1;
+    static constexpr uint32_t QUEUE_CAPACITY = 16;  // Posted events awaiting dispatch()
+    
     /**
      * @brief State transition callback
      * Parameters: (from_state, to_state, event)
      */
-    using TransitionCallback = std::function<void(State, State, Event)>;
+    using TransitionCallback = void (*)(State from, State to, Event event);
     
     /**
      * @brief State entry/exit callback
      * Parameter: (current_state)
      */
-    using StateCallback = std::function<void(State)>;
+    using StateCallback = void (*)(State state);
 
     MotorStateMachine();
     
     /**
-     * @brief Process an event and potentially transition state
-     * @param event Event to process
-     * @return true if state changed
+     * @brief Process an event and potentially transition state (consumer)
+     * @param event Event to process, after everything already posted
+     * @return true if this event changed the state
      */
     bool processEvent(Event event);
     
+    /**
+     * @brief Queue an event for the consumer context (any context, ISR-safe)
+     * @return false if the queue was full (the event is counted as dropped)
+     */
+    bool post(Event event);
+    
+    /**
+     * @brief Process posted events (consumer)
+     * @param max_events Upper bound for this call, which bounds its run time
+     * @return Number of events processed
+     */
+    uint32_t dispatch(uint32_t max_events = QUEUE_CAPACITY);
+    
+    /**
+     * @brief Events post() could not queue
+     */
+    uint32_t getDroppedEvents() const { return dropped_events_; }
+    
     /**
      * @brief Get current state
      */
@@ -139,10 +173,13 @@ private:
     StateCallback state_entry_callback_;
     StateCallback state_exit_callback_;
     
+    MpscQueue<Event, QUEUE_CAPACITY> events_;
+    std::atomic<uint32_t> dropped_events_;
+    
     /**
-     * @brief Check if transition is valid
+     * @brief Look up and run one event
      */
-    bool isTransitionValid(State from, State to, Event event) const;
+    bool handle(Event event);
     
     /**
      * @brief Execute state transition
@@ -0,0 +1,100 @@
+#ifndef INC_MODULES_MOTOR_MPSCQUEUE_HPP_
+#define INC_MODULES_MOTOR_MPSCQUEUE_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Fixed-capacity multi-producer/single-consumer ring buffer
+ *
+ * Lock-free hand-off from any number of writer contexts (interrupt handlers
+ * of any priority and the main loop) to one reader context. Every slot
+ * carries a sequence number: a producer claims a slot by advancing the
+ * shared head with a compare-and-swap (LDREX/STREX on Cortex-M), fills it
+ * and then publishes it with a release store of the sequence. The consumer
+ * only takes a slot whose sequence says it is published, so a producer
+ * preempted between claim and publish holds up the items behind it but
+ * never hands out a half-written one. No interrupt masking is needed.
+ *
+ * Producer side (any context): push(). Consumer side: pop().
+ * size() and empty() may be called from either side (approximate while
+ * producers are active).
+ *
+ * @tparam T Element type (copied in and out)
+ * @tparam CAPACITY Number of slots, a power of two
+ */
+template <typename T, uint32_t CAPACITY>
+class MpscQueue {
+    static_assert(CAPACITY > 1 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "Indices must be lock-free");
+
+public:
+    MpscQueue() : head_(0), tail_(0) {
+        for (uint32_t i = 0; i < CAPACITY; i++) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Append an element (any producer)
+     * @return false if the queue is full
+     */
+    bool push(const T& item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[head & MASK];
+            const int32_t lag = static_cast<int32_t>(slot.sequence.load(std::memory_order_acquire) - head);
+            if (lag == 0) {
+                // Free for this lap: claim it, or retry with the head that won
+                if (head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+                    slot.item = item;
+                    slot.sequence.store(head + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;   // Still holds the element from the previous lap
+            } else {
+                head = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Take the oldest published element (consumer)
+     * @return false if there is none
+     */
+    bool pop(T& item) {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[tail & MASK];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+            return false;
+        }
+        item = slot.item;
+        slot.sequence.store(tail + CAPACITY, std::memory_order_release);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr uint32_t capacity() { return CAPACITY; }
+
+private:
+    static constexpr uint32_t MASK = CAPACITY - 1;
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;  // == position: free, == position + 1: published
+        T item;
+    };
+
+    Slot slots_[CAPACITY];
+    std::atomic<uint32_t> head_;  // Next slot to claim, shared by producers
+    std::atomic<uint32_t> tail_;  // Next slot to read, consumer only
+};
+
+#endif /* INC_MODULES_MOTOR_MPSCQUEUE_HPP_ */
@@ -0,0 +1,139 @@
+#ifndef INC_MODULES_MOTOR_MULTIAXISCOORDINATOR_HPP_
+#define INC_MODULES_MOTOR_MULTIAXISCOORDINATOR_HPP_
+
+#include "motor/SCurveProfile.hpp"
+#include "motor/SCurveStepper.hpp"
+#include "motor/StepperMotor.hpp"
+#include "stm32f4xx_hal.h"
+#include <cstdint>
+
+/**
+ * @brief Coordinated point-to-point motion for several stepper axes
+ * 
+ * Plans one S-curve per axis, then time-scales the faster axes
+ * (v * k, a * k², j * k³ with k = T_axis / T_slowest) so every axis starts
+ * and finishes together. update() walks all profiles on the control-loop
+ * tick and sets each axis' step rate.
+ * 
+ * Axis 0 drives the master step timer (TRGO = OC1REF, its step pulse); the
+ * other axes' step timers are slaves in trigger mode on that TRGO. Slave
+ * timers are armed first and the master is started last, so all step
+ * timers start on the master's first step edge, a few core clocks apart,
+ * and share one time base. When axis 0 has no steps to make in a move the
+ * master raises no trigger, and the first update() starts the armed
+ * slaves itself. A step timer is never restarted within a move.
+ * 
+ * Each axis stops on its step count rather than on the end of its
+ * profile: update() adds up the steps its timer made at the rates it ran
+ * (StepPhase puts step k at k - 0.5 steps, so step N + 1 is half a step
+ * past the end) and stops the timer once step N is out. Rates never take
+ * the timer up to step N + 1, so time-stretched axes, whose rates the
+ * motor raises to its 1 Hz floor, make exactly their steps.
+ */
+class MultiAxisCoordinator {
+public:
+    static constexpr uint32_t MAX_AXES = 4;
+    
+    enum class State {
+        IDLE,
+        RUNNING,
+        COMPLETED,
+        ERROR
+    };
+    
+    /**
+     * @brief Per-axis motion limits
+     */
+    struct Limits {
+        float max_velocity;       // steps/sec
+        float max_acceleration;   // steps/sec²
+        float max_jerk;           // steps/sec³
+    };
+    
+    MultiAxisCoordinator();
+    
+    /**
+     * @brief Add an axis (the first axis must own the master step timer)
+     * @param motor Motor of the axis, slave timers in trigger mode on the master TRGO
+     * @return Axis index, or -1 if all axes are in use
+     */
+    int addAxis(StepperMotor* motor);
+    
+    /**
+     * @brief Set the control-loop tick
+     * @param htim Timer whose interrupt calls update() (masked while loading a move)
+     * @param update_freq_hz Rate at which update() is called
+     */
+    void init(TIM_HandleTypeDef* htim, float update_freq_hz);
+    
+    /**
+     * @brief Start a coordinated move
+     * @param targets Absolute target per axis (steps), one per added axis
+     * @param limits Motion limits per axis, one per added axis
+     * @return true if motion started successfully
+     */
+    bool moveTo(const float targets[], const Limits limits[]);
+    
+    /**
+     * @brief Stop all axes immediately
+     */
+    void stop();
+    
+    /**
+     * @brief Update function - call from the control-loop interrupt
+     */
+    void update();
+    
+    /**
+     * @brief Planned position of an axis (steps)
+     */
+    float getPosition(uint32_t axis) const { return axis < axis_count_ ? axes_[axis].position : 0.0f; }
+    
+    /**
+     * @brief Set the position of an idle axis (steps)
+     */
+    void setPosition(uint32_t axis, float position);
+    
+    /**
+     * @brief Duration of the current move (seconds)
+     */
+    float getMoveTime() const { return move_time_; }
+    
+    uint32_t getAxisCount() const { return axis_count_; }
+    State getState() const { return state_; }
+    bool isComplete() const { return state_ == State::COMPLETED || state_ == State::IDLE; }
+
+private:
+    struct Axis {
+        StepperMotor* motor;
+        SCurveProfile profile;
+        SCurveStepper stepper;
+        float position;
+        float start_position;
+        float target_position;
+        float direction;  // +1 forward, -1 reverse
+        uint32_t steps;   // Steps to make in the current move
+        float made;       // Steps made so far, as a StepPhase position
+        float rate;       // Rate the step timer runs at (steps/sec)
+        bool active;      // Moving in the current move
+        bool stepping;    // Step timer running
+    };
+    
+    // Steps kept clear of the step instants k - 0.5 when stopping
+    static constexpr float STEP_MARGIN = 0.25f;
+    
+    Axis axes_[MAX_AXES];
+    uint32_t axis_count_;
+    volatile State state_;  // Written by update() in the timer ISR
+    bool start_slaves_;     // Master idle in this move: start the slaves on the first update()
+    
+    TIM_HandleTypeDef* htim_;
+    float dt_;
+    float move_time_;
+    
+    void startArmedSlaves();
+    void maskUpdates();
+    void unmaskUpdates();
+};
+
+#endif /* INC_MODULES_MOTOR_MULTIAXISCOORDINATOR_HPP_ */
@@ -0,0 +1,96 @@
+#ifndef INC_MODULES_MOTOR_PIDCONTROLLER_HPP_
+#define INC_MODULES_MOTOR_PIDCONTROLLER_HPP_
+
+#include <cstdint>
+
+/**
+ * @brief Feedforward + PID position loop for a step/direction axis
+ *
+ * Runs once per control tick on the commanded position and velocity of
+ * the planner and the position measured by an encoder, and returns the
+ * step rate to emit (signed):
+ *
+ *   rate = kf * v + kp * e + ki * ∫e dt + kd * (v - v_measured)
+ *
+ * with e the following error (commanded - measured, in steps). The
+ * feedforward term carries the move, so the PID part only makes up steps
+ * the motor lost or gained; it is limited to max_correction, and the
+ * integral stops growing while that limit holds it (anti-windup). The
+ * measured velocity is the difference of the measured positions through a
+ * first-order low-pass filter.
+ *
+ * At rest (v = 0) errors within the deadband are left alone, so the axis
+ * does not hunt between two encoder counts. A following error beyond
+ * max_following_error latches a fault: the output is zero until reset().
+ */
+class PIDController {
+public:
+    struct Gains {
+        float kp;  // 1/s: steps/sec per step of following error
+        float ki;  // 1/s²: steps/sec per step·second of accumulated error
+        float kd;  // steps/sec per steps/sec of velocity error
+        float kf;  // Share of the commanded velocity fed forward (1 = all of it)
+    };
+
+    struct Limits {
+        float max_correction;       // Largest PID output (steps/sec, > 0)
+        float max_following_error;  // Fault beyond this error (steps, > 0)
+        float deadband;             // Error left alone at rest (steps, >= 0)
+    };
+
+    PIDController();
+
+    /**
+     * @brief Set the gains (may be changed between ticks)
+     * @return false if a gain is negative or not finite (nothing is changed)
+     */
+    bool setGains(const Gains& gains);
+
+    /**
+     * @brief Set the output and error limits
+     * @return false if a limit is out of range (nothing is changed)
+     */
+    bool setLimits(const Limits& limits);
+
+    const Gains& getGains() const { return gains_; }
+    const Limits& getLimits() const { return limits_; }
+
+    /**
+     * @brief Clear the integral, the velocity filter and a latched fault
+     *
+     * Call when the loop takes over the axis, e.g. after it ran open loop.
+     */
+    void reset();
+
+    /**
+     * @brief Run the loop for one tick
+     * @param commanded_position Planned position now (steps)
+     * @param commanded_velocity Planned velocity for the next tick (steps/sec, signed)
+     * @param measured_position Encoder position now (steps)
+     * @param dt Tick period (seconds)
+     * @return Step rate to emit until the next tick (steps/sec, signed)
+     */
+    float update(float commanded_position, float commanded_velocity, float measured_position, float dt);
+
+    float getError() const { return error_; }
+    float getCorrection() const { return correction_; }  // PID part of the last output
+    float getMeasuredVelocity() const { return measured_velocity_; }
+
+    /**
+     * @brief Check if the following error exceeded its limit
+     */
+    bool isFaulted() const { return faulted_; }
+
+private:
+    Gains gains_;
+    Limits limits_;
+    float integral_;           // ∫e dt (step·seconds)
+    float error_;
+    float correction_;
+    float measured_velocity_;  // Filtered (steps/sec)
+    float last_measured_;
+    bool primed_;              // last_measured_ is valid
+    bool faulted_;
+};
+
+#endif /* INC_MODULES_MOTOR_PIDCONTROLLER_HPP_ */
@@ -16,6 +16,23 @@
  * Phase 5: Jerk-up (deceleration increasing)
  * Phase 6: Constant deceleration
  * Phase 7: Jerk-down (deceleration decreasing)
+ *
+ * Phases that the constraints make unnecessary have zero length: phases 2/6
+ * when a_max is not reached within the ramp, phase 4 when v_max is not
+ * reached within the distance. Each phase is a cubic in time, so position,
+ * velocity and acceleration are evaluated in closed form.
+ *
+ * The move may start and end at non-zero velocities (blending into the
+ * neighbouring moves of a sequence); phases 1-3 then ramp from the start
+ * velocity and phases 5-7 ramp down to the end velocity.
+ *
+ * calculateStop() builds a stop ramp instead: phases 5-7 only, starting
+ * from a live velocity and acceleration anywhere in another profile.
+ *
+ * A move may also start with non-zero acceleration (retargeting a move in
+ * progress): phase 1 then takes the acceleration from there to the ramp's
+ * peak (through zero if it was decelerating, down to max_acceleration if
+ * it was above it), so the acceleration stays continuous across the switch.
  */
 class SCurveProfile {
 public:
@@ -23,7 +40,9 @@ public:
         float max_velocity;       // steps/sec
         float max_acceleration;   // steps/sec²
         float max_jerk;          // steps/sec³
-        float start_velocity;    // steps/sec (usually 0)
+        float start_velocity = 0.0f;  // steps/sec (usually 0, must not exceed max_velocity)
+        float end_velocity = 0.0f;    // steps/sec at the target (must not exceed max_velocity)
+        float start_acceleration = 0.0f;  // steps/sec², signed along the motion (usually 0)
     };
     
     struct State {
@@ -44,6 +63,41 @@ public:
      */
     bool calculate(float target_position, const Config& config);
     
+    /**
+     * @brief Highest velocity reachable from v_from within a distance
+     * @param v_from Velocity at the start of the distance (steps/sec)
+     * @param distance Distance available for the velocity change (steps)
+     * @param limits Motion limits (start/end velocity ignored)
+     * @return Velocity in [v_from, max_velocity] (steps/sec)
+     * 
+     * By symmetry this is also the highest velocity from which v_from can
+     * still be reached within the distance, i.e. the look-ahead bound on a
+     * junction velocity.
+     */
+    static float reachableVelocity(float v_from, float distance, const Config& limits);
+    
+    /**
+     * @brief Calculate the shortest jerk-limited ramp to rest
+     * @param velocity Velocity at the start of the ramp (steps/sec, >= 0)
+     * @param acceleration Acceleration there (steps/sec², signed, along the motion)
+     * @param limits Motion limits (start/end velocity ignored)
+     * @return false if already at rest (nothing to ramp) or the limits are invalid
+     * 
+     * Phase 5 takes the acceleration to the deceleration peak (at most
+     * max_acceleration), phase 6 holds it, phase 7 returns to zero at rest;
+     * phases 1-4 have zero length. The stopping distance becomes the
+     * target. A deceleration beyond max_acceleration (limits lowered
+     * mid-move) eases off to it with positive jerk in phase 5. If the
+     * deceleration is already too strong to unwind before rest, phase 7 is
+     * cut short where the velocity reaches zero.
+     */
+    bool calculateStop(float velocity, float acceleration, const Config& limits);
+    
+    /**
+     * @brief Distance covered by the profile (steps)
+     */
+    float getDistance() const { return target_pos_; }
+    
     /**
      * @brief Get state at a specific time
      * @param time_sec Time since motion start (seconds)
@@ -60,25 +114,56 @@ public:
      * @brief Check if profile is valid
      */
     bool isValid() const { return is_valid_; }
+    
+    /**
+     * @brief Get peak (cruise) velocity actually reached
+     */
+    float getPeakVelocity() const { return v_peak_; }
+    
+    /**
+     * @brief Get velocity at the end of the move
+     */
+    float getEndVelocity() const { return v_end_; }
+    
+    /**
+     * @brief Get time at the end of a phase (1-7)
+     */
+    float getPhaseEndTime(uint32_t phase) const { return t_[phase]; }
+    
+    /**
+     * @brief Get jerk applied during a phase (1-7)
+     */
+    float getPhaseJerk(uint32_t phase) const { return jerk_[phase]; }
 
 private:
     // Phase timing
     float t_[8];  // Time at end of each phase (t_[0] = 0, t_[7] = total time)
     
+    // Kinematic state at the end of each phase (index 0 = motion start)
+    float pos_[8];
+    float vel_[8];
+    float acc_[8];
+    float jerk_[8];  // Jerk applied during phase i (index 0 unused)
+    
     // Motion parameters
     float target_pos_;
     float v_max_;
     float a_max_;
     float j_max_;
     float v_start_;
+    float a_start_;
+    float v_end_;
+    float v_peak_;
     
     float total_time_;
     bool is_valid_;
     
     // Helper functions
-    void calculatePhaseTimings();
+    float findPeakVelocity() const;
+    float settleVelocity() const;
+    void calculatePhaseTimings(float v_peak);
+    void integratePhases(const float durations[8], const float jerks[8], float a_start);
     State calculateStateInPhase(float t, uint32_t phase) const;
-    float positionAtPhaseEnd(uint32_t phase) const;
 };
 
 #endif /* INC_MODULES_MOTOR_SCURVEPROFILE_HPP_ */
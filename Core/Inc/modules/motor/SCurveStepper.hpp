@@ -0,0 +1,87 @@
+#ifndef INC_MODULES_MOTOR_SCURVESTEPPER_HPP_
+#define INC_MODULES_MOTOR_SCURVESTEPPER_HPP_
+
+#include "motor/SCurveProfile.hpp"
+#include <cstdint>
+
+/**
+ * @brief Fixed-step evaluator for an S-curve profile
+ * 
+ * Walks a profile in ticks of a fixed dt, for the control-loop ISR.
+ * start() converts the phase boundaries to tick counts and re-anchors each
+ * phase's cubic at its first tick, so step() is a tick compare and a few
+ * multiply-adds in the tick offset (Horner form). There is no division,
+ * sqrt or phase search per call, and because every value is evaluated from
+ * the phase anchor rather than accumulated, rounding does not drift.
+ * 
+ * Tick n matches profile.getStateAtTime(start_time + n * dt).
+ */
+class SCurveStepper {
+public:
+    SCurveStepper();
+    
+    /**
+     * @brief Prepare to walk a profile from tick 0
+     * @param profile Profile to evaluate (must stay valid while stepping)
+     * @param dt Tick period (seconds)
+     * @param start_time Profile time at tick 0 (seconds), e.g. the part of a
+     *        tick left over from the previous move of a sequence
+     * @return true if the profile is valid
+     */
+    bool start(const SCurveProfile& profile, float dt, float start_time = 0.0f);
+    
+    /**
+     * @brief Advance by one tick and evaluate the profile there
+     */
+    const SCurveProfile::State& step();
+    
+    /**
+     * @brief State at the current tick
+     */
+    const SCurveProfile::State& getState() const { return state_; }
+    
+    /**
+     * @brief Ticks since start()
+     */
+    uint32_t getTick() const { return tick_; }
+    
+    /**
+     * @brief Profile time at the current tick (seconds)
+     */
+    float getTime() const { return start_time_ + static_cast<float>(tick_) * dt_; }
+    
+    /**
+     * @brief Time by which the current tick lies past the end of the profile
+     * 
+     * Between 0 and dt once the state is complete: the start time to hand
+     * the next profile of a sequence so no time is lost at the junction.
+     */
+    float getTimePastEnd() const { return getTime() - total_time_; }
+
+private:
+    // One profile phase, as polynomials in ticks since first_tick
+    struct Segment {
+        uint32_t last_tick;
+        uint32_t first_tick;
+        uint32_t phase;
+        float p0, p1, p2, p3;  // position
+        float v0, v1, v2;      // velocity
+        float a0, a1;          // acceleration
+    };
+    
+    Segment segments_[7];
+    uint32_t segment_count_;
+    uint32_t segment_index_;
+    
+    uint32_t tick_;
+    uint32_t complete_tick_;  // First tick at or past the end of the profile
+    float dt_;
+    float start_time_;
+    float total_time_;
+    float final_position_;
+    float final_velocity_;
+    
+    SCurveProfile::State state_;
+};
+
+#endif /* INC_MODULES_MOTOR_SCURVESTEPPER_HPP_ */
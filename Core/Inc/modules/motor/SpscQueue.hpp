@@ -0,0 +1,168 @@
+#ifndef INC_MODULES_MOTOR_SPSCQUEUE_HPP_
+#define INC_MODULES_MOTOR_SPSCQUEUE_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Fixed-capacity single-producer/single-consumer ring buffer
+ *
+ * Lock-free hand-off between one writer context (e.g. the main loop) and
+ * one reader context (e.g. a timer ISR). Head and tail are free-running
+ * counters, each written by one side only; the release store that publishes
+ * an index is paired with an acquire load on the other side, so slot
+ * contents are visible before the index that covers them. No interrupt
+ * masking is needed on either side.
+ *
+ * Elements are pushed by copy (push()) or built in place in the next free
+ * slot (reserve(), then publish()). The producer drops what it has pushed
+ * with discard(): the consumer skips those elements from then on, so the
+ * tail stays written by the consumer only.
+ *
+ * Producer side: push(), reserve(), publish(), discard(), full(), back().
+ * Consumer side: peek(), pop(), clear(). size() and empty() may be called
+ * from either side.
+ *
+ * @tparam T Element type
+ * @tparam CAPACITY Number of slots, a power of two
+ */
+template <typename T, uint32_t CAPACITY>
+class SpscQueue {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "Indices must be lock-free");
+
+public:
+    SpscQueue() : head_(0), tail_(0), discard_(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Append an element (producer)
+     * @return false if the queue is full
+     */
+    bool push(const T& item) {
+        T* slot = reserve();
+        if (slot == nullptr) {
+            return false;
+        }
+        *slot = item;
+        publish();
+        return true;
+    }
+
+    /**
+     * @brief Next free slot, to be filled in place before publish() (producer)
+     * @return nullptr if the queue is full
+     *
+     * The slot stays invisible to the consumer until publish(); reserving
+     * again without publishing returns the same slot.
+     */
+    T* reserve() {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail() >= CAPACITY) {
+            return nullptr;
+        }
+        return &slots_[head & MASK];
+    }
+
+    /**
+     * @brief Hand the reserved slot to the consumer (producer)
+     */
+    void publish() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Drop everything pushed so far (producer)
+     *
+     * Takes effect at once for size(), empty() and reserve(); the consumer
+     * skips the elements on its next peek() or pop(), so it must not hold
+     * on to an element across producer calls.
+     */
+    void discard() {
+        discard_.store(head_.load(std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    /**
+     * @brief Element before the newest one (producer)
+     * @param offset 0 for the newest element
+     * @return nullptr if fewer than offset + 1 elements are queued
+     *
+     * The consumer may pop it at any time, after which the slot keeps its
+     * contents until the next push(). Only data the element synchronizes
+     * by itself (e.g. through an atomic member) may be rewritten.
+     */
+    T* back(uint32_t offset = 0) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail() <= offset) {
+            return nullptr;
+        }
+        return &slots_[(head - 1 - offset) & MASK];
+    }
+
+    /**
+     * @brief Element behind the oldest one, valid until it is popped (consumer)
+     * @param offset 0 for the oldest element
+     * @return nullptr if fewer than offset + 1 elements are queued
+     */
+    T* peek(uint32_t offset = 0) {
+        const uint32_t tail = skipDiscarded();
+        if (head_.load(std::memory_order_acquire) - tail <= offset) {
+            return nullptr;
+        }
+        return &slots_[(tail + offset) & MASK];
+    }
+
+    /**
+     * @brief Drop the oldest element (consumer)
+     */
+    void pop() {
+        const uint32_t tail = skipDiscarded();
+        if (head_.load(std::memory_order_acquire) != tail) {
+            tail_.store(tail + 1, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Drop everything pushed so far (consumer)
+     */
+    void clear() {
+        tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    uint32_t size() const {
+        return head_.load(std::memory_order_acquire) - tail();
+    }
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() >= CAPACITY; }
+    static constexpr uint32_t capacity() { return CAPACITY; }
+
+private:
+    static constexpr uint32_t MASK = CAPACITY - 1;
+
+    T slots_[CAPACITY];
+    std::atomic<uint32_t> head_;     // Next slot to write, producer only
+    std::atomic<uint32_t> tail_;     // Next slot to read, consumer only
+    std::atomic<uint32_t> discard_;  // Head at the last discard(), producer only
+
+    // Oldest element still wanted: the tail, or past it after a discard()
+    uint32_t tail() const {
+        const uint32_t tail = tail_.load(std::memory_order_acquire);
+        const uint32_t discard = discard_.load(std::memory_order_acquire);
+        return (static_cast<int32_t>(discard - tail) > 0) ? discard : tail;
+    }
+
+    // Consumer: move the tail past discarded elements
+    uint32_t skipDiscarded() {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        const uint32_t discard = discard_.load(std::memory_order_acquire);
+        if (static_cast<int32_t>(discard - tail) > 0) {
+            tail_.store(discard, std::memory_order_release);
+            return discard;
+        }
+        return tail;
+    }
+};
+
+#endif /* INC_MODULES_MOTOR_SPSCQUEUE_HPP_ */
@@ -0,0 +1,69 @@
+#ifndef INC_MODULES_MOTOR_STEPPHASE_HPP_
+#define INC_MODULES_MOTOR_STEPPHASE_HPP_
+
+#include <cstdint>
+
+/**
+ * @brief Step phase across buffered step rate changes
+ *
+ * With PSC, ARR and CCR buffered (ARPE/OCxPE) a new step rate only takes
+ * over at the next update event, so below one step per rate change the
+ * steps would lag a rising rate and run ahead of a falling one. This
+ * keeps the fraction of a step made since the last one at the commanded
+ * rates and keeps steps on their phase: a late step (speeding up from a
+ * long period, down to 1 Hz) starts at once when its pulse is over, and
+ * otherwise the counter is moved so the running period ends as its step
+ * falls due at the new rate, never into the pulse. What that cannot cover
+ * is made up by the buffered period below one step per reload, or by the
+ * next reload above it, where the periods just follow the rate.
+ *
+ * The step made when the timer starts counts as the first half step: the
+ * next one falls due 1.5 steps on, so step k lands at position k - 0.5 and
+ * a move of N steps ends before step N + 1 is due.
+ *
+ * The caller owns the timer: it reads CNT and UIF with CR1.UDIS set,
+ * writes CNT back if it was moved and the period returned, and generates
+ * the update event when told to.
+ */
+class StepPhase {
+public:
+    StepPhase();
+
+    /**
+     * @brief Timer (re)started with these values, a step beginning now
+     */
+    void start(uint32_t prescaler, uint32_t period, uint32_t compare);
+
+    /**
+     * @brief Period to buffer for a new rate on the running timer
+     * @param count CNT, read with CR1.UDIS set; moved so the live period
+     *        ends on its step (add the change to CNT)
+     * @param overflowed UIF was set: an update event loaded the values
+     *        written last (the caller clears it)
+     * @param prescaler New PSC value
+     * @param period New period (ARR + 1) at the commanded rate
+     * @param pulse New compare value
+     * @param max_period Longest period the counter supports
+     * @param step_now Set if the next step is due now: generate an update
+     *        event after writing PSC/ARR/CCR (and clear UIF)
+     * @return Period to write (ARR + 1)
+     */
+    uint32_t reload(uint32_t& count, bool overflowed, uint32_t prescaler, uint32_t period, uint32_t pulse,
+                    uint32_t max_period, bool& step_now);
+
+private:
+    struct Values {
+        uint32_t prescaler;
+        uint32_t period;
+        uint32_t compare;
+    };
+    Values live_;       // In the shadow registers
+    Values written_;    // In the preload registers
+    float step_;        // Timer clocks per step at the rate commanded last
+    uint32_t reload_count_;  // Counter at the last reload
+    float step_phase_;  // Fraction of a step made since it started
+    float next_phase_;  // Phase the next step starts with (< 0 if the live period ends early)
+    float interval_;    // Timer clocks between the last reloads without a step between them
+};
+
+#endif /* INC_MODULES_MOTOR_STEPPHASE_HPP_ */
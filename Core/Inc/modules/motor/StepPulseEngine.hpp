@@ -0,0 +1,105 @@
+#ifndef INC_MODULES_MOTOR_STEPPULSEENGINE_HPP_
+#define INC_MODULES_MOTOR_STEPPULSEENGINE_HPP_
+
+#include "motor/SCurveProfile.hpp"
+#include "motor/StepScheduler.hpp"
+#include "stm32f4xx_hal.h"
+#include <cstdint>
+
+/**
+ * @brief DMA-driven step pulse generator
+ *
+ * Converts an S-curve profile into one timer period per step (the interval
+ * between two step times from StepScheduler) and streams
+ * the periods into the step timer through its DMA burst interface
+ * (TIMx_DCR/DMAR). Every update event the DMA writes ARR and CCRx of the
+ * next step into the preload registers, so each step edge lands on an
+ * exact timer count and the step count equals the move distance.
+ *
+ * The table is a circular double buffer: the DMA half-transfer and
+ * transfer-complete interrupts refill the half that was just consumed.
+ * When the profile runs out the remaining entries are idle periods
+ * (CCR = 0, no pulse) and the engine stops itself once both halves are idle.
+ *
+ * Requirements: 32-bit step timer on channel 1 (TIM2), update DMA request
+ * linked to htim->hdma[TIM_DMA_ID_UPDATE] in circular mode, word transfers.
+ */
+class StepPulseEngine {
+public:
+    static constexpr uint32_t HALF_BUFFER_STEPS = 64;
+    static constexpr uint32_t BUFFER_STEPS = 2 * HALF_BUFFER_STEPS;
+
+    struct Config {
+        TIM_HandleTypeDef* step_timer;
+        uint32_t step_channel;  // Only TIM_CHANNEL_1 is supported
+    };
+
+    explicit StepPulseEngine(const Config& config);
+
+    // Engine owns the step timer's DMA stream
+    StepPulseEngine(const StepPulseEngine&) = delete;
+    StepPulseEngine& operator=(const StepPulseEngine&) = delete;
+
+    /**
+     * @brief Start emitting the steps of a profile
+     * @param profile Profile along the move (must stay valid until done)
+     * @param steps Number of steps to emit
+     * @return true if the DMA stream was started
+     */
+    bool start(const SCurveProfile& profile, uint32_t steps);
+
+    /**
+     * @brief Stop immediately (current pulse may be truncated)
+     */
+    void stop();
+
+    /**
+     * @brief Check if steps are still being emitted
+     */
+    bool isRunning() const { return is_running_; }
+
+    /**
+     * @brief Steps written to the DMA table so far
+     */
+    uint32_t getStepsQueued() const { return steps_queued_; }
+
+    /**
+     * @brief Step timer driven by this engine
+     */
+    TIM_HandleTypeDef* getTimer() const { return config_.step_timer; }
+
+    /**
+     * @brief DMA callbacks - call from HAL_TIM_PeriodElapsedHalfCpltCallback /
+     *        HAL_TIM_PeriodElapsedCallback for the step timer
+     */
+    void onHalfTransfer();
+    void onTransferComplete();
+
+private:
+    // One DMA burst: DBA = ARR, 3 transfers (ARR, RCR, CCR1)
+    struct BurstEntry {
+        uint32_t arr;
+        uint32_t rcr;  // Reserved on TIM2-5, written as 0
+        uint32_t ccr;
+    };
+
+    Config config_;
+    StepScheduler scheduler_;
+    BurstEntry buffer_[BUFFER_STEPS];
+    uint32_t half_steps_[2];  // Steps held by each half of the buffer
+
+    uint32_t total_steps_;
+    uint32_t steps_queued_;
+    float tick_hz_;           // Timer count rate
+    float step_time_;         // Profile time of the last queued step edge
+    float last_period_;       // Seconds, last step interval
+    float tick_remainder_;    // Rounding carry so periods do not drift
+    bool lead_in_done_;
+    volatile bool is_running_;
+
+    void fillHalf(uint32_t half);
+    bool nextEntry(BurstEntry& entry);
+    uint32_t toTicks(float seconds);
+};
+
+#endif /* INC_MODULES_MOTOR_STEPPULSEENGINE_HPP_ */
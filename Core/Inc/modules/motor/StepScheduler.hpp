@@ -0,0 +1,65 @@
+#ifndef INC_MODULES_MOTOR_STEPSCHEDULER_HPP_
+#define INC_MODULES_MOTOR_STEPSCHEDULER_HPP_
+
+#include "motor/SCurveProfile.hpp"
+#include <cstdint>
+
+/**
+ * @brief Position-domain step scheduler for an S-curve profile
+ *
+ * Produces the profile time at which the position reaches each whole step,
+ * in order, so a step timer can be loaded with the exact interval between
+ * two steps (AVR446-style per-step delays, for a jerk-limited profile).
+ *
+ * Within a phase the position is a cubic p(τ) = p0 + v0 τ + a0 τ²/2 + j τ³/6
+ * in the time since the phase start. Each step is solved incrementally
+ * from the previous one: the interval to the next step is seeded by
+ * inverting the local Taylor expansion (δ = 1/v - a/(2v³) for one step),
+ * and Newton refines it on the cubic, with the previous step and the phase
+ * end as bracket. Cruise needs no correction and ramps typically one. The
+ * profile itself is only evaluated once per phase to anchor the cubic, so
+ * times do not drift over long moves.
+ */
+class StepScheduler {
+public:
+    StepScheduler();
+
+    /**
+     * @brief Start scheduling the steps of a profile from step 1
+     * @param profile Profile along the move (must stay valid while scheduling)
+     * @param steps Number of steps; a last step past the profile's distance
+     *        lands at its end
+     * @return true if the profile is valid and steps is non-zero
+     */
+    bool start(const SCurveProfile& profile, uint32_t steps);
+
+    /**
+     * @brief Schedule the next step
+     * @param time Profile time at which the position reaches it (seconds)
+     * @return false once every step has been scheduled (time is unchanged)
+     */
+    bool next(float& time);
+
+    /**
+     * @brief Steps scheduled so far
+     */
+    uint32_t getStep() const { return step_; }
+
+private:
+    const SCurveProfile* profile_;
+    uint32_t steps_;
+    uint32_t step_;
+
+    // Cubic of the current phase, about its start
+    uint32_t phase_;
+    float phase_start_;
+    float phase_length_;
+    float phase_end_position_;
+    float p0_, v0_, a0_, jerk_;
+    float tau_;                 // Time of the last step since the phase start
+
+    void enterPhase(uint32_t phase);
+    float positionAt(float tau) const;
+};
+
+#endif /* INC_MODULES_MOTOR_STEPSCHEDULER_HPP_ */
@@ -0,0 +1,259 @@
+#ifndef INC_MODULES_MOTOR_STEPPERDRIVER_HPP_
+#define INC_MODULES_MOTOR_STEPPERDRIVER_HPP_
+
+#include "stm32f4xx_hal.h"
+#include "hal/GpioPin.hpp"
+#include "hal/TimerClock.hpp"
+#include "motor/StepPhase.hpp"
+#include "motor/StepperMotor.hpp"
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @brief Stepper motor driver with its pins and step timer fixed at compile time
+ *
+ * Counterpart of StepperMotor for axes whose wiring is known when the
+ * firmware is built. Timer, channel, pins and polarities are template
+ * parameters, so there is no Config to load from: setDirection() and
+ * setEnabled() are one BSRR store each, and a rate change is direct
+ * PSC/ARR/CCRx stores into a register block whose address and compare
+ * offset are constants. The step pin is checked against the F411
+ * alternate-function table of the timer channel, and the channel against
+ * the timer, at compile time.
+ *
+ * Steps are PWM pulses on the timer channel as in StepperMotor's
+ * CONTINUOUS mode (same pulse width, rates from TimerClock::solve(), 1 Hz
+ * floor, StepPhase across rate changes, same stop and restart sequence),
+ * so a move emits the same steps through either. There is no step counter; axes
+ * that count steps in hardware use StepperMotor.
+ *
+ * The timer and pins must be configured beforehand (CubeMX: PWM mode 1 on
+ * the channel, step pin in its alternate function, direction and enable
+ * pins as outputs). All members are static; use the class through an
+ * alias, e.g.
+ *   using Axis1 = StepperDriver<1, TIM_CHANNEL_3, GpioPin<GpioPort::A, GPIO_PIN_10>,
+ *                               GpioPin<GpioPort::C, GPIO_PIN_0>, GpioPin<GpioPort::C, GPIO_PIN_1>>;
+ *   Axis1::setDirection(forward);
+ *
+ * @tparam TIMER Timer number (1-5, 9-11)
+ * @tparam CHANNEL Step channel, TIM_CHANNEL_1..4
+ * @tparam STEP_PIN GpioPin of the step output
+ * @tparam DIR_PIN GpioPin of the direction output (active = forward)
+ * @tparam ENABLE_PIN GpioPin of the driver enable (active = enabled)
+ */
+template <uint32_t TIMER, uint32_t CHANNEL, typename STEP_PIN, typename DIR_PIN, typename ENABLE_PIN>
+class StepperDriver {
+    static constexpr uint32_t INDEX = CHANNEL >> 2;  // TIM_CHANNEL_1..4 are 0x0, 0x4, 0x8, 0xC
+
+    static_assert((TIMER >= 1 && TIMER <= 5) || (TIMER >= 9 && TIMER <= 11), "No such timer on the F411");
+    static_assert((CHANNEL & 0x3U) == 0 && INDEX < 4, "CHANNEL must be TIM_CHANNEL_1..4");
+    static_assert(TIMER <= 5 || INDEX < ((TIMER == 9) ? 2U : 1U), "Channel not on this timer");
+    static_assert(!(STEP_PIN::port_id == DIR_PIN::port_id && STEP_PIN::pin == DIR_PIN::pin) &&
+                  !(STEP_PIN::port_id == ENABLE_PIN::port_id && STEP_PIN::pin == ENABLE_PIN::pin) &&
+                  !(DIR_PIN::port_id == ENABLE_PIN::port_id && DIR_PIN::pin == ENABLE_PIN::pin),
+                  "Step, direction and enable pins must differ");
+
+    static constexpr bool stepPinRoutes() {
+        constexpr GpioPort P = STEP_PIN::port_id;
+        constexpr uint16_t N = STEP_PIN::pin;
+        auto on = [](GpioPort port, uint16_t pin) { return P == port && N == pin; };
+        using G = GpioPort;
+        switch (TIMER * 4 + INDEX) {
+        case 1 * 4 + 0: return on(G::A, GPIO_PIN_8) || on(G::E, GPIO_PIN_9);
+        case 1 * 4 + 1: return on(G::A, GPIO_PIN_9) || on(G::E, GPIO_PIN_11);
+        case 1 * 4 + 2: return on(G::A, GPIO_PIN_10) || on(G::E, GPIO_PIN_13);
+        case 1 * 4 + 3: return on(G::A, GPIO_PIN_11) || on(G::E, GPIO_PIN_14);
+        case 2 * 4 + 0: return on(G::A, GPIO_PIN_0) || on(G::A, GPIO_PIN_5) || on(G::A, GPIO_PIN_15);
+        case 2 * 4 + 1: return on(G::A, GPIO_PIN_1) || on(G::B, GPIO_PIN_3);
+        case 2 * 4 + 2: return on(G::A, GPIO_PIN_2) || on(G::B, GPIO_PIN_10);
+        case 2 * 4 + 3: return on(G::A, GPIO_PIN_3);
+        case 3 * 4 + 0: return on(G::A, GPIO_PIN_6) || on(G::B, GPIO_PIN_4) || on(G::C, GPIO_PIN_6);
+        case 3 * 4 + 1: return on(G::A, GPIO_PIN_7) || on(G::B, GPIO_PIN_5) || on(G::C, GPIO_PIN_7);
+        case 3 * 4 + 2: return on(G::B, GPIO_PIN_0) || on(G::C, GPIO_PIN_8);
+        case 3 * 4 + 3: return on(G::B, GPIO_PIN_1) || on(G::C, GPIO_PIN_9);
+        case 4 * 4 + 0: return on(G::B, GPIO_PIN_6) || on(G::D, GPIO_PIN_12);
+        case 4 * 4 + 1: return on(G::B, GPIO_PIN_7) || on(G::D, GPIO_PIN_13);
+        case 4 * 4 + 2: return on(G::B, GPIO_PIN_8) || on(G::D, GPIO_PIN_14);
+        case 4 * 4 + 3: return on(G::B, GPIO_PIN_9) || on(G::D, GPIO_PIN_15);
+        case 5 * 4 + 0: return on(G::A, GPIO_PIN_0);
+        case 5 * 4 + 1: return on(G::A, GPIO_PIN_1);
+        case 5 * 4 + 2: return on(G::A, GPIO_PIN_2);
+        case 5 * 4 + 3: return on(G::A, GPIO_PIN_3);
+        case 9 * 4 + 0: return on(G::A, GPIO_PIN_2) || on(G::E, GPIO_PIN_5);
+        case 9 * 4 + 1: return on(G::A, GPIO_PIN_3) || on(G::E, GPIO_PIN_6);
+        case 10 * 4 + 0: return on(G::B, GPIO_PIN_8);
+        case 11 * 4 + 0: return on(G::B, GPIO_PIN_9);
+        default: return false;
+        }
+    }
+    static_assert(stepPinRoutes(), "STEP_PIN is not an output of this timer channel");
+
+public:
+    using StepPin = STEP_PIN;
+    using DirPin = DIR_PIN;
+    using EnablePin = ENABLE_PIN;
+
+    // Longest period the counter supports (ARR + 1)
+    static constexpr uint32_t MAX_PERIOD = (TIMER == 2 || TIMER == 5) ? 0xFFFFFFFFU : 0x10000U;
+
+    static TIM_TypeDef* timer() {
+        if constexpr (TIMER == 1) {
+            return TIM1;
+        } else if constexpr (TIMER == 2) {
+            return TIM2;
+        } else if constexpr (TIMER == 3) {
+            return TIM3;
+        } else if constexpr (TIMER == 4) {
+            return TIM4;
+        } else if constexpr (TIMER == 5) {
+            return TIM5;
+        } else if constexpr (TIMER == 9) {
+            return TIM9;
+        } else if constexpr (TIMER == 10) {
+            return TIM10;
+        } else {
+            return TIM11;
+        }
+    }
+
+    /**
+     * @brief Compare register of the step channel
+     */
+    static volatile uint32_t& compare() {
+        return (&timer()->CCR1)[INDEX];
+    }
+
+    /**
+     * @brief Buffer ARR and CCR, then stop with the driver disabled and direction forward
+     */
+    static void init() {
+        TIM_TypeDef* tim = timer();
+        tim->CR1 |= TIM_CR1_ARPE;
+        if constexpr (INDEX < 2) {
+            tim->CCMR1 |= (INDEX == 0) ? TIM_CCMR1_OC1PE : TIM_CCMR1_OC2PE;
+        } else {
+            tim->CCMR2 |= (INDEX == 2) ? TIM_CCMR2_OC3PE : TIM_CCMR2_OC4PE;
+        }
+        setEnabled(false);
+        setDirection(true);
+        stop();
+    }
+
+    /**
+     * @brief Enable/disable the motor driver (one BSRR store)
+     */
+    static void setEnabled(bool enabled) {
+        ENABLE_PIN::write(enabled);
+    }
+
+    /**
+     * @brief Set rotation direction (one BSRR store, safe from the step ISR)
+     * @param forward true for forward, false for reverse
+     */
+    static void setDirection(bool forward) {
+        DIR_PIN::write(forward);
+    }
+
+    static bool isEnabled() { return ENABLE_PIN::isActive(); }
+    static bool isForward() { return DIR_PIN::isActive(); }
+    static bool isRunning() { return (timer()->CCER & CCER_ENABLE) != 0; }
+
+    /**
+     * @brief Set step rate (velocity)
+     * @param steps_per_sec Desired speed in steps/second (0 to stop, at least 1 otherwise)
+     */
+    static void setStepRate(float steps_per_sec) {
+        if (steps_per_sec <= 0.0f) {
+            stop();
+            return;
+        }
+        TIM_TypeDef* tim = timer();
+        const uint32_t clock = TimerClock::getClock(tim);
+        TimerClock::Setting timing;
+        TimerClock::solve(clock, std::max(steps_per_sec, 1.0f), MAX_PERIOD, 2, timing);
+
+        const float tick_hz = static_cast<float>(clock) / static_cast<float>(timing.prescaler + 1U);
+        const uint32_t max_pulse =
+            std::max(static_cast<uint32_t>(StepperMotor::MAX_PULSE_WIDTH * tick_hz), static_cast<uint32_t>(1));
+        const uint32_t pulse = std::min(timing.period / 2, max_pulse);
+
+        if (isRunning()) {
+            reload(timing.prescaler, timing.period, pulse);
+        } else {
+            start(timing.prescaler, timing.period, pulse);
+        }
+    }
+
+    /**
+     * @brief Stop stepping immediately (as HAL_TIM_PWM_Stop() in StepperMotor::stop())
+     */
+    static void stop() {
+        TIM_TypeDef* tim = timer();
+        tim->CCER &= ~CCER_ENABLE;
+        if ((tim->CCER & (TIM_CCER_CC1E | TIM_CCER_CC2E | TIM_CCER_CC3E | TIM_CCER_CC4E)) == 0) {
+            tim->CR1 &= ~TIM_CR1_CEN;
+        }
+    }
+
+private:
+    static constexpr uint32_t CCER_ENABLE = TIM_CCER_CC1E << CHANNEL;
+
+    static inline StepPhase phase_;
+
+    // Same sequence as StepperMotor::restartPWM()
+    static void start(uint32_t prescaler, uint32_t period, uint32_t pulse) {
+        TIM_TypeDef* tim = timer();
+        stop();
+
+        // Park OCxREF low (compare 0 at count 0): a stop mid-pulse leaves it
+        // high, and the restart must be a rising edge. The barrier completes
+        // the stop and the park before the new values go in, as
+        // HAL_TIM_GenerateEvent() does for StepperMotor.
+        compare() = 0;
+        tim->EGR = TIM_EGR_UG;
+        __DSB();
+
+        tim->PSC = prescaler;
+        tim->ARR = period - 1;
+        compare() = pulse;
+        tim->EGR = TIM_EGR_UG;
+        tim->SR = ~TIM_SR_UIF;
+        phase_.start(prescaler, period, pulse);
+
+        tim->CCER |= CCER_ENABLE;
+        if constexpr (TIMER == 1) {
+            tim->BDTR |= TIM_BDTR_MOE;
+        }
+        tim->CR1 |= TIM_CR1_CEN;
+    }
+
+    static void reload(uint32_t prescaler, uint32_t period, uint32_t pulse) {
+        TIM_TypeDef* tim = timer();
+
+        // UDIS holds off the shadow load until PSC, ARR and CCR are all written
+        tim->CR1 |= TIM_CR1_UDIS;
+        uint32_t count = tim->CNT;
+        const uint32_t read = count;
+        const bool overflowed = (tim->SR & TIM_SR_UIF) != 0;
+        if (overflowed) {
+            tim->SR = ~TIM_SR_UIF;
+        }
+        bool step_now = false;
+        const uint32_t next_period = phase_.reload(count, overflowed, prescaler, period, pulse, MAX_PERIOD, step_now);
+        if (count != read) {
+            tim->CNT += count - read;
+        }
+
+        tim->PSC = prescaler;
+        tim->ARR = next_period - 1;
+        compare() = pulse;
+        tim->CR1 &= ~TIM_CR1_UDIS;
+
+        if (step_now) {
+            tim->EGR = TIM_EGR_UG;
+            tim->SR = ~TIM_SR_UIF;
+        }
+    }
+};
+
+#endif /* INC_MODULES_MOTOR_STEPPERDRIVER_HPP_ */
@@ -2,6 +2,8 @@
 #define INC_MODULES_MOTOR_STEPPERMOTOR_HPP_
 
 #include "stm32f4xx_hal.h"
+#include "hal/TimerClock.hpp"
+#include "motor/StepPhase.hpp"
 #include <cstdint>
 
 /**
@@ -12,6 +14,20 @@
  */
 class StepperMotor {
 public:
+    /**
+     * @brief How step rate changes are applied to a running timer
+     */
+    enum class UpdateMode {
+        RESTART,     // Stop, reprogram and restart the timer (truncates the current pulse)
+        CONTINUOUS   // Buffered PSC/ARR/CCR (ARPE/OCxPE), new period starts at the next update event
+                     // (below one step per rate update, steps keep their phase across changes)
+    };
+    
+    // Step pulses are half the period up to here (50% duty above 25 kHz).
+    // Slow rates keep short pulses, so a faster rate can start the next step
+    // as soon as its period has elapsed.
+    static constexpr float MAX_PULSE_WIDTH = 20.0e-6f;  // Seconds
+    
     /**
      * @brief Configuration for stepper motor pins
      */
@@ -28,6 +44,13 @@ public:
         GPIO_TypeDef* enable_port;
         uint16_t enable_pin;
         bool enable_active_low;  // true if LOW = enabled
+        
+        // Rate change strategy
+        UpdateMode update_mode = UpdateMode::CONTINUOUS;
+        
+        // Step counter (optional): 16-bit timer in external clock mode 1 on
+        // the step timer's TRGO (MMS = OC1REF, step_channel must be CH1)
+        TIM_HandleTypeDef* count_timer = nullptr;
     };
     
     /**
@@ -72,11 +95,34 @@ public:
      */
     void stop();
     
+    /**
+     * @brief Stop the step output but leave the step timer counting
+     *
+     * A trigger-mode slave whose counter is stopped starts again on the
+     * master's next TRGO edge; this keeps it on the time base it started
+     * on. The next setStepRate() restarts the output (and re-arms the
+     * slave, as after stop()). Not for a timer that clocks a step counter.
+     */
+    void stopOutput();
+    
     /**
      * @brief Get current commanded step rate
      */
     float getStepRate() const { return current_step_rate_; }
     
+    /**
+     * @brief Step rate the timer actually produces (steps/s, 0 when stopped)
+     * 
+     * The commanded rate (at least 1 Hz) rounded to whole timer ticks; the
+     * prescaler and period are chosen per step timer width and clock.
+     */
+    float getAchievedStepRate() const { return timing_.frequency; }
+    
+    /**
+     * @brief Relative error of the achieved step rate (achieved / commanded - 1, from 1 Hz)
+     */
+    float getStepRateError() const { return timing_.error; }
+    
     /**
      * @brief Check if motor is enabled
      */
@@ -86,16 +132,50 @@ public:
      * @brief Get current direction
      */
     bool isForward() const { return is_forward_; }
+    
+    /**
+     * @brief Get step timer handle
+     */
+    TIM_HandleTypeDef* getTimer() const { return config_.step_timer; }
+    
+    /**
+     * @brief Check if emitted steps are counted in hardware
+     */
+    bool hasStepCounter() const { return config_.count_timer != nullptr; }
+    
+    /**
+     * @brief Position from the step counter (steps, signed by direction)
+     * 
+     * Adds the pulses counted since the last call with the current
+     * direction. Call at least once every 65535 steps (16-bit counter);
+     * safe from the control-loop ISR and the main loop. Without a counter
+     * nothing is counted: it returns the last setStepCount() position.
+     */
+    int32_t getStepCount();
+    
+    /**
+     * @brief Set the step counter position (steps)
+     */
+    void setStepCount(int32_t steps);
 
 private:
     Config config_;
     float current_step_rate_;
     bool is_enabled_;
     bool is_forward_;
+    bool is_running_;  // Step timer output active
+    int32_t step_count_;  // Counted position up to count_last_
+    uint16_t count_last_;  // Count timer value at the last accumulation
+    TimerClock::Setting timing_;  // Prescaler and period of the step timer
+    
+    StepPhase phase_;  // CONTINUOUS mode: the step in progress across rate changes
     
     // Helper to calculate timer settings
     void updatePWMFrequency(float frequency_hz);
+    void restartPWM(uint32_t prescaler, uint32_t period, uint32_t pulse);
+    void reloadPWM(uint32_t prescaler, uint32_t period, uint32_t pulse);
     uint32_t getTimerClock() const;
+    void accumulateSteps();
 };
 
 #endif /* INC_MODULES_MOTOR_STEPPERMOTOR_HPP_ */
@@ -0,0 +1,65 @@
+#ifndef INC_MODULES_MOTOR_VELOCITYRAMP_HPP_
+#define INC_MODULES_MOTOR_VELOCITYRAMP_HPP_
+
+#include <cstdint>
+
+/**
+ * @brief Jerk-limited tracker of a velocity setpoint, one control tick at a time
+ *
+ * Velocity and acceleration are signed, so a setpoint of the other sign is
+ * reached through zero without stopping there. Each tick the acceleration
+ * moves by at most max_jerk * dt towards the largest value (within
+ * max_acceleration) that can still be ramped back to zero at max_jerk by
+ * the time the velocity reaches the setpoint. Once it is there, velocity
+ * is held exactly and acceleration is zero.
+ *
+ * The setpoint and limits may change on any tick; the ramp continues from
+ * the current velocity and acceleration, which are never reset.
+ */
+class VelocityRamp {
+public:
+    VelocityRamp();
+
+    /**
+     * @brief Take over from a motion in progress
+     * @param velocity Current velocity (steps/sec, signed)
+     * @param acceleration Current acceleration (steps/sec², signed)
+     */
+    void reset(float velocity, float acceleration);
+
+    /**
+     * @brief Set the velocity to track and the limits to track it with
+     * @param velocity Setpoint (steps/sec, signed)
+     * @param max_acceleration Maximum acceleration (steps/sec², > 0)
+     * @param max_jerk Maximum jerk (steps/sec³, > 0)
+     * @return false if a limit is not positive (nothing is changed)
+     */
+    bool setTarget(float velocity, float max_acceleration, float max_jerk);
+
+    /**
+     * @brief Advance by one tick
+     * @param dt Tick period (seconds)
+     * @return Distance covered during the tick (steps, signed)
+     */
+    float step(float dt);
+
+    float getVelocity() const { return velocity_; }
+    float getAcceleration() const { return acceleration_; }
+    float getTarget() const { return target_; }
+    float getMaxAcceleration() const { return max_acceleration_; }
+    float getMaxJerk() const { return max_jerk_; }
+
+    /**
+     * @brief Check if the setpoint is reached (velocity held, no acceleration)
+     */
+    bool isSettled() const { return velocity_ == target_ && acceleration_ == 0.0f; }
+
+private:
+    float velocity_;
+    float acceleration_;
+    float target_;
+    float max_acceleration_;
+    float max_jerk_;
+};
+
+#endif /* INC_MODULES_MOTOR_VELOCITYRAMP_HPP_ */
@@ -6,15 +6,195 @@
 #ifndef MOTOR_CONTROL_H
 #define MOTOR_CONTROL_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * @brief Motor control test/main function
+ * @brief Create motor, state machine and planner, and start the TIM4 control loop
+ */
+void motor_control_init(void);
+
+/**
+ * @brief Motor control main loop (GUI commands, or the test cycle)
  */
 void motor_control_main(void);
 
+/**
+ * @brief Execute received COMMAND frames and acknowledge them
+ *
+ * Call from the main loop; reception runs on USART2 RX DMA in the
+ * background. Also steps the state machine along the running move.
+ */
+void motor_command_service(void);
+
+/**
+ * @brief Command-to-motion latency of the last START (microseconds)
+ *
+ * From the reception event that delivered the command to the control-loop
+ * tick that started the move.
+ */
+uint32_t motor_command_latency_us(void);
+
+/**
+ * @brief Largest command-to-motion latency since start-up (microseconds)
+ */
+uint32_t motor_command_latency_max_us(void);
+
+/**
+ * @brief Frame queued telemetry samples and hand them to the console sink
+ *
+ * Call from the main loop at least every few milliseconds; samples are
+ * taken in the control-loop interrupt and queued until then. Also sends
+ * the control-loop jitter and deadline-miss statistics once a second.
+ */
+void motor_telemetry_service(void);
+
+/**
+ * @brief Telemetry samples lost because the main loop did not keep up
+ */
+uint32_t motor_telemetry_dropped(void);
+
+/**
+ * @brief Start an S-curve move to an absolute position
+ * @param target_steps Target position in steps
+ * @param max_velocity Maximum velocity (steps/sec)
+ * @param max_acceleration Maximum acceleration (steps/sec²)
+ * @param max_jerk Maximum jerk (steps/sec³)
+ * @return true if the move was accepted
+ *
+ * While a move runs the new target replaces its target without stopping
+ * (queued moves are discarded); see MotionPlanner::retarget().
+ */
+bool motor_move_to(float target_steps, float max_velocity, float max_acceleration, float max_jerk);
+
+/**
+ * @brief Run axis 0 at a velocity (velocity mode), or change its velocity
+ * @param velocity Setpoint (steps/sec, negative is reverse)
+ * @param max_acceleration Maximum acceleration (steps/sec²)
+ * @param max_jerk Maximum jerk (steps/sec³)
+ * @return false if the limits are invalid, another axis move runs or the
+ *         DMA step engine is in use
+ *
+ * Stream setpoints by calling it again; the control loop ramps to each
+ * within the limits, through zero when the sign changes. A setpoint of 0
+ * ends the jog once the axis is at rest. See MotionPlanner::jog().
+ */
+bool motor_jog(float velocity, float max_acceleration, float max_jerk);
+
+/**
+ * @brief Queue an S-curve move to start as soon as the previous one completes
+ * @param target_steps Target position in steps
+ * @param max_velocity Maximum velocity (steps/sec)
+ * @param max_acceleration Maximum acceleration (steps/sec²)
+ * @param max_jerk Maximum jerk (steps/sec³)
+ * @return false if the queue is full or the move is invalid
+ */
+bool motor_queue_move(float target_steps, float max_velocity, float max_acceleration, float max_jerk);
+
+/**
+ * @brief Moves waiting in the queue behind the current one
+ */
+uint32_t motor_queue_depth(void);
+
+/**
+ * @brief Select step generation for subsequent moves
+ * @param enable true: DMA step engine, false: PWM rate per control tick
+ * @return false if a move is in progress
+ */
+bool motor_use_step_engine(bool enable);
+
+/**
+ * @brief Close the position loop on axis 0 through the TIM3 encoder
+ * @param enable true: feedforward + PID on the encoder position, false: open loop
+ * @return false if a move is in progress, or (enabling) the encoder did not
+ *         start or the DMA step engine is in use
+ *
+ * In closed loop the encoder is axis 0's position; enabling adopts it as
+ * the planner's position, so steps lost before are not made up. Gains come
+ * from SET_GAINS. A following error beyond the limit stops the axis and
+ * posts ERROR_DETECTED.
+ */
+bool motor_use_closed_loop(bool enable);
+
+/**
+ * @brief Check whether the position loop is closed (motor_use_closed_loop())
+ */
+bool motor_is_closed_loop(void);
+
+/**
+ * @brief Following error of the last control tick in closed loop (steps, commanded - measured)
+ */
+float motor_get_following_error(void);
+
+/**
+ * @brief Check whether a following error fault stopped axis 0
+ *
+ * Latched until the loop is closed again with motor_use_closed_loop(true).
+ */
+bool motor_has_position_fault(void);
+
+/**
+ * @brief Check whether a move is in progress
+ */
+bool motor_is_moving(void);
+
+/**
+ * @brief Abort the current move at once (emergency stop)
+ */
+void motor_stop(void);
+
+/**
+ * @brief Ramp the current move down to rest (jerk-limited, within its limits)
+ * @return false if no single-axis move is running or it cannot be ramped
+ *         (DMA step engine); use motor_stop() then
+ */
+bool motor_decelerate_to_stop(void);
+
+/**
+ * @brief Position in steps: the encoder in closed loop, otherwise emitted
+ *        step pulses as counted by TIM9
+ */
+float motor_get_position(void);
+
+/**
+ * @brief Planned velocity in steps per second (signed)
+ */
+float motor_get_velocity(void);
+
+/**
+ * @brief Number of coordinated axes (axis 0 is the motor above)
+ */
+uint32_t motor_axis_count(void);
+
+/**
+ * @brief Start a coordinated move; all axes start and finish together
+ * @param targets Absolute target per axis in steps (motor_axis_count() entries)
+ * @param max_velocity Maximum velocity of any axis (steps/sec)
+ * @param max_acceleration Maximum acceleration of any axis (steps/sec²)
+ * @param max_jerk Maximum jerk of any axis (steps/sec³)
+ * @return false if rejected or a single-axis move is in progress
+ */
+bool motor_axes_move_to(const float* targets, float max_velocity, float max_acceleration, float max_jerk);
+
+/**
+ * @brief Check whether a coordinated move is in progress
+ */
+bool motor_axes_are_moving(void);
+
+/**
+ * @brief Position of an axis in steps (counted for axis 0, planned for the others)
+ */
+float motor_axis_get_position(uint32_t axis);
+
+/**
+ * @brief Enable or disable the drivers of all axes
+ */
+void motor_axes_enable(bool enable);
+
 /**
  * @brief Enable or disable the motor
  * @param enable true to enable, false to disable
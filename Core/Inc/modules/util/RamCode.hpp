@@ -0,0 +1,31 @@
+#ifndef INC_MODULES_UTIL_RAMCODE_HPP_
+#define INC_MODULES_UTIL_RAMCODE_HPP_
+
+/**
+ * @brief Run a function from SRAM instead of flash
+ *
+ * At 84 MHz flash needs two wait states (FLASH_LATENCY_2). The ART
+ * accelerator hides them on instruction cache hits only, so the cycle
+ * count of flash code depends on what ran before it (a control tick after
+ * a burst of main-loop code misses). Functions marked RAM_CODE are linked
+ * into .ram_text (STM32F411XX_FLASH.ld), stored in flash after the code and
+ * copied to SRAM by Reset_Handler before main(); they fetch with no wait
+ * states and no cache, so their timing repeats tick after tick. The fetches
+ * share the system bus with data accesses, so a function is not faster on
+ * average than one that hits the cache, only never slower.
+ *
+ * Mark the definition:
+ *   RAM_CODE void MotionPlanner::update() { ... }
+ * Calls between SRAM and flash go through long-branch veneers the linker
+ * adds (a few cycles); callees left in flash (HAL, libm) still see the
+ * wait states. A copy inlined into a flash caller runs from flash. The
+ * build lists what landed in SRAM in <project>.ram_text.txt. Host builds
+ * (HOST_SIM) ignore the marker.
+ */
+#ifdef HOST_SIM
+#define RAM_CODE
+#else
+#define RAM_CODE __attribute__((section(".ram_text")))
+#endif
+
+#endif /* INC_MODULES_UTIL_RAMCODE_HPP_ */
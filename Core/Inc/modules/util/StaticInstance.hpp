@@ -0,0 +1,72 @@
+#ifndef INC_MODULES_UTIL_STATICINSTANCE_HPP_
+#define INC_MODULES_UTIL_STATICINSTANCE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+/**
+ * @brief Storage for one object of type T in .bss, constructed on demand
+ *
+ * Replaces heap allocation (std::make_unique) for objects that live for the
+ * whole run: the storage is sized and aligned for T at compile time, so it
+ * cannot be too small, and the linker accounts for it in RAM usage. The
+ * wrapper itself is constant-initialized (no static constructor, no
+ * destructor registered with atexit), so objects come to life exactly when
+ * construct() is called, in the order the init code calls it.
+ *
+ * Until construct() returns, get() is nullptr and the instance tests false,
+ * so interrupt handlers can check it before touching the object. It
+ * replaces a unique_ptr in place: ->, * and boolean tests work the same.
+ *
+ * @tparam T Object type
+ */
+template <typename T>
+class StaticInstance {
+public:
+    constexpr StaticInstance() : storage_{}, constructed_(false) {}
+
+    StaticInstance(const StaticInstance&) = delete;
+    StaticInstance& operator=(const StaticInstance&) = delete;
+
+    /**
+     * @brief Construct the object in place (destroying a previous one)
+     * @return The new object
+     */
+    template <typename... Args>
+    T& construct(Args&&... args) {
+        destroy();
+        T* object = new (storage_) T(std::forward<Args>(args)...);
+        // Published only once fully built, for handlers that test the instance
+        std::atomic_signal_fence(std::memory_order_release);
+        constructed_ = true;
+        return *object;
+    }
+
+    /**
+     * @brief Run the destructor; the storage stays reserved
+     */
+    void destroy() {
+        if (constructed_) {
+            constructed_ = false;
+            std::atomic_signal_fence(std::memory_order_release);
+            object()->~T();
+        }
+    }
+
+    T* get() const { return constructed_ ? object() : nullptr; }
+    T* operator->() const { return object(); }
+    T& operator*() const { return *object(); }
+    explicit operator bool() const { return constructed_; }
+
+private:
+    T* object() const {
+        return std::launder(reinterpret_cast<T*>(const_cast<uint8_t*>(storage_)));
+    }
+
+    alignas(T) uint8_t storage_[sizeof(T)];
+    volatile bool constructed_;
+};
+
+#endif /* INC_MODULES_UTIL_STATICINSTANCE_HPP_ */
@@ -10,6 +10,9 @@
 #include "main.h"
 #include <stdio.h>  // For printf
 
+// stdout buffer (newlib would otherwise malloc one on the first printf)
+static char g_stdout_buffer[256];
+
 // C linkage for functions called from C code
 extern "C" {
 
@@ -19,6 +22,8 @@ extern "C" {
  * This function is called from main.c after all hardware initialization
  */
 void cpp_main(void) {
+    setvbuf(stdout, g_stdout_buffer, _IOLBF, sizeof(g_stdout_buffer));
+    
     // Print startup message
     printf("\r\n=== STM32 Robotics Control System ===\r\n");
     printf("System Clock: %lu Hz\r\n", SystemCoreClock);
@@ -0,0 +1,156 @@
+#include "comm/CommandReceiver.hpp"
+#include "hal/UartLogSink.hpp"
+#include <cstring>
+
+extern UART_HandleTypeDef huart2;  // Declared in main.c
+
+namespace {
+
+CommandReceiver g_console_receiver(&huart2);
+
+}  // namespace
+
+CommandReceiver::CommandReceiver(UART_HandleTypeDef* huart)
+    : huart_(huart)
+    , buffer_{}
+    , scratch_{}
+    , head_(0)
+    , event_cycles_(0)
+    , restarts_(0)
+    , last_position_(0)
+    , tail_(0)
+    , scan_(0)
+    , seen_restarts_(0)
+    , in_frame_(false)
+    , command_cycles_(0)
+    , frame_errors_(0)
+    , overruns_(0)
+{
+}
+
+CommandReceiver& CommandReceiver::console() {
+    return g_console_receiver;
+}
+
+bool CommandReceiver::start() {
+    last_position_ = 0;
+    return HAL_UARTEx_ReceiveToIdle_DMA(huart_, buffer_, static_cast<uint16_t>(BUFFER_SIZE)) == HAL_OK;
+}
+
+void CommandReceiver::onRxEvent(uint16_t position) {
+    // Bytes since the last event; the position restarts at 0 after a full lap
+    const uint32_t received = (position >= last_position_)
+                                  ? position - last_position_
+                                  : BUFFER_SIZE - last_position_ + position;
+    last_position_ = static_cast<uint16_t>(position & MASK);
+    event_cycles_ = DWT->CYCCNT;
+    head_ = head_ + received;
+}
+
+void CommandReceiver::onError() {
+    // Only act once the HAL has given up the reception (RxState back to ready)
+    if (huart_->RxState != HAL_UART_STATE_READY) {
+        return;
+    }
+    // The DMA starts again at offset 0: move head to the next lap so ring
+    // offsets still match, and let poll() drop what it has not read
+    head_ = (head_ + MASK) & ~MASK;
+    restarts_ = restarts_ + 1;
+    start();
+}
+
+bool CommandReceiver::poll(TelemetryProtocol::Command& command) {
+    // Write position and its stamp must belong to the same event
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const uint32_t head = head_;
+    const uint32_t cycles = event_cycles_;
+    const uint32_t restarts = restarts_;
+    __set_PRIMASK(primask);
+
+    if (restarts != seen_restarts_ || head - tail_ > BUFFER_SIZE) {
+        seen_restarts_ = restarts;
+        overruns_++;
+        discard(head);
+        return false;
+    }
+
+    while (scan_ != head) {
+        const uint32_t pos = scan_++;
+        if (buffer_[pos & MASK] != TelemetryProtocol::DELIMITER) {
+            continue;
+        }
+
+        // Every delimiter closes the open candidate and opens the next one
+        const uint32_t start = tail_;
+        const uint32_t length = pos - start;
+        const bool was_frame = in_frame_;
+        tail_ = pos + 1;
+        in_frame_ = true;
+        if (!was_frame || length == 0) {
+            continue;
+        }
+        if (length <= MAX_ENCODED_FRAME && decode(start, length, command)) {
+            in_frame_ = false;
+            command_cycles_ = cycles;
+            return true;
+        }
+        frame_errors_++;
+    }
+
+    // No delimiter in sight: not a frame, drop it so the buffer never fills
+    if (scan_ - tail_ > MAX_ENCODED_FRAME) {
+        if (in_frame_) {
+            frame_errors_++;
+        }
+        tail_ = scan_;
+        in_frame_ = false;
+    }
+    return false;
+}
+
+bool CommandReceiver::decode(uint32_t start, uint32_t length, TelemetryProtocol::Command& command) {
+    const uint32_t offset = start & MASK;
+    uint8_t* data = &buffer_[offset];
+    if (offset + length > BUFFER_SIZE) {
+        // Wraps around the buffer end
+        const uint32_t first = BUFFER_SIZE - offset;
+        std::memcpy(scratch_, data, first);
+        std::memcpy(scratch_ + first, buffer_, length - first);
+        data = scratch_;
+    }
+
+    // In place: the payload overwrites the encoded bytes already consumed
+    const size_t payload_length = TelemetryProtocol::decodeFrame(data, length, data, length);
+    if (payload_length == 0 || head_ - start > BUFFER_SIZE) {
+        return false;  // Invalid, or overwritten by the DMA while decoding
+    }
+    return TelemetryProtocol::decodeCommand(data, payload_length, command);
+}
+
+void CommandReceiver::discard(uint32_t head) {
+    tail_ = head;
+    scan_ = head;
+    in_frame_ = false;
+}
+
+// C linkage for HAL callbacks
+extern "C" {
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size) {
+    if (huart == g_console_receiver.getUart()) {
+        g_console_receiver.onRxEvent(Size);
+    }
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart) {
+    // Errors end whichever direction the HAL aborted; each side checks its state
+    if (huart == UartLogSink::console().getUart()) {
+        UartLogSink::console().onError();
+    }
+    if (huart == g_console_receiver.getUart()) {
+        g_console_receiver.onError();
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,429 @@
+#include "comm/TelemetryProtocol.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// CRC-16/CCITT-FALSE, one entry per leading byte
+constexpr uint16_t crcEntry(uint8_t index) {
+    uint16_t crc = static_cast<uint16_t>(index << 8);
+    for (int bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+    return crc;
+}
+
+struct CrcTable {
+    uint16_t entries[256];
+    constexpr CrcTable() : entries{} {
+        for (int i = 0; i < 256; i++) {
+            entries[i] = crcEntry(static_cast<uint8_t>(i));
+        }
+    }
+};
+
+constexpr CrcTable CRC_TABLE;
+
+constexpr size_t COBS_BLOCK = 254;  // Data bytes per COBS code byte
+
+void putU16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void putU32(uint8_t* p, uint32_t value) {
+    putU16(p, static_cast<uint16_t>(value));
+    putU16(p + 2, static_cast<uint16_t>(value >> 16));
+}
+
+uint16_t getU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return getU16(p) | (static_cast<uint32_t>(getU16(p + 2)) << 16);
+}
+
+void putFloat(uint8_t* p, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU32(p, bits);
+}
+
+float getFloat(const uint8_t* p) {
+    const uint32_t bits = getU32(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int32_t quantisePosition(float steps) {
+    return static_cast<int32_t>(std::lround(steps * TelemetryProtocol::POSITION_SCALE));
+}
+
+void putHeader(uint8_t* payload, TelemetryProtocol::MessageType type, uint8_t sequence) {
+    payload[0] = TelemetryProtocol::PROTOCOL_VERSION;
+    payload[1] = static_cast<uint8_t>(type);
+    payload[2] = sequence;
+}
+
+}  // namespace
+
+uint16_t TelemetryProtocol::crc16(const uint8_t* data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc = static_cast<uint16_t>((crc << 8) ^ CRC_TABLE.entries[((crc >> 8) ^ data[i]) & 0xFF]);
+    }
+    return crc;
+}
+
+size_t TelemetryProtocol::encodeFrame(const uint8_t* payload, size_t length, uint8_t* frame, size_t capacity) {
+    const size_t total = length + 2;
+    if (capacity < total + total / COBS_BLOCK + 1 + 2) {
+        return 0;
+    }
+
+    uint8_t crc_bytes[2];
+    putU16(crc_bytes, crc16(payload, length));
+
+    // COBS: each code byte gives the distance to the next zero (or block end)
+    size_t out = 0;
+    frame[out++] = DELIMITER;
+    size_t code_pos = out++;
+    uint8_t code = 1;
+    for (size_t i = 0; i < total; i++) {
+        const uint8_t byte = (i < length) ? payload[i] : crc_bytes[i - length];
+        if (byte == 0) {
+            frame[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+            continue;
+        }
+        frame[out++] = byte;
+        if (++code == COBS_BLOCK + 1) {
+            frame[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+        }
+    }
+    frame[code_pos] = code;
+    frame[out++] = DELIMITER;
+    return out;
+}
+
+size_t TelemetryProtocol::decodeFrame(const uint8_t* data, size_t length, uint8_t* payload, size_t capacity) {
+    size_t out = 0;
+    size_t pos = 0;
+    while (pos < length) {
+        const uint8_t code = data[pos++];
+        if (code == 0 || pos + code - 1 > length || out + code - 1 > capacity) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (data[pos] == 0) {
+                return 0;
+            }
+            payload[out++] = data[pos++];
+        }
+        // A short block implies a zero, except at the very end
+        if (code != COBS_BLOCK + 1 && pos < length) {
+            if (out >= capacity) {
+                return 0;
+            }
+            payload[out++] = 0;
+        }
+    }
+
+    if (out < HEADER_SIZE + 2 || payload[0] != PROTOCOL_VERSION) {
+        return 0;
+    }
+    const size_t payload_length = out - 2;
+    if (crc16(payload, payload_length) != getU16(&payload[payload_length])) {
+        return 0;
+    }
+    return payload_length;
+}
+
+uint32_t TelemetryProtocol::decodeTelemetry(const uint8_t* payload, size_t length, Sample* samples,
+                                            uint32_t max_samples) {
+    if (length < HEADER_SIZE + TELEMETRY_HEADER_SIZE || getType(payload) != MessageType::TELEMETRY) {
+        return 0;
+    }
+    const uint8_t* body = payload + HEADER_SIZE;
+    const uint32_t t0 = getU32(body);
+    const uint16_t period = getU16(body + 4);
+    const uint32_t count = body[6];
+    if (length != HEADER_SIZE + TELEMETRY_HEADER_SIZE + count * SAMPLE_SIZE || count > max_samples) {
+        return 0;
+    }
+
+    int32_t target = static_cast<int32_t>(getU32(body + 8));
+    int32_t actual = static_cast<int32_t>(getU32(body + 12));
+    const uint8_t* p = body + TELEMETRY_HEADER_SIZE;
+    for (uint32_t i = 0; i < count; i++, p += SAMPLE_SIZE) {
+        target += static_cast<int16_t>(getU16(p));
+        actual += static_cast<int16_t>(getU16(p + 2));
+
+        Sample& sample = samples[i];
+        sample.time_us = t0 + i * period;
+        sample.target_position = static_cast<float>(target) / POSITION_SCALE;
+        sample.actual_position = static_cast<float>(actual) / POSITION_SCALE;
+        sample.target_velocity = halfToFloat(getU16(p + 4));
+        sample.actual_velocity = halfToFloat(getU16(p + 6));
+        sample.pid_output = static_cast<int8_t>(p[8]);
+        sample.phase = p[9];
+    }
+    return count;
+}
+
+size_t TelemetryProtocol::encodeCommand(const Command& command, uint8_t* frame, size_t capacity) {
+    if (command.arg_count > MAX_COMMAND_ARGS) {
+        return 0;
+    }
+    uint8_t payload[HEADER_SIZE + 1 + MAX_COMMAND_ARGS * 4];
+    putHeader(payload, MessageType::COMMAND, command.sequence);
+    payload[HEADER_SIZE] = static_cast<uint8_t>(command.opcode);
+    for (uint8_t i = 0; i < command.arg_count; i++) {
+        putFloat(&payload[HEADER_SIZE + 1 + i * 4], command.args[i]);
+    }
+    return encodeFrame(payload, HEADER_SIZE + 1 + command.arg_count * 4U, frame, capacity);
+}
+
+bool TelemetryProtocol::decodeCommand(const uint8_t* payload, size_t length, Command& command) {
+    if (length < HEADER_SIZE + 1 || getType(payload) != MessageType::COMMAND) {
+        return false;
+    }
+    const size_t arg_bytes = length - HEADER_SIZE - 1;
+    if (arg_bytes % 4 != 0 || arg_bytes / 4 > MAX_COMMAND_ARGS) {
+        return false;
+    }
+    command.sequence = payload[2];
+    command.opcode = static_cast<CommandOpcode>(payload[HEADER_SIZE]);
+    command.arg_count = static_cast<uint8_t>(arg_bytes / 4);
+    for (uint8_t i = 0; i < command.arg_count; i++) {
+        command.args[i] = getFloat(&payload[HEADER_SIZE + 1 + i * 4]);
+    }
+    return true;
+}
+
+size_t TelemetryProtocol::encodeAck(const Ack& ack, uint8_t sequence, uint8_t* frame, size_t capacity) {
+    uint8_t payload[HEADER_SIZE + 7];
+    putHeader(payload, MessageType::ACK, sequence);
+    payload[HEADER_SIZE] = ack.sequence;
+    payload[HEADER_SIZE + 1] = static_cast<uint8_t>(ack.opcode);
+    payload[HEADER_SIZE + 2] = static_cast<uint8_t>(ack.status);
+    putU32(&payload[HEADER_SIZE + 3], ack.value);
+    return encodeFrame(payload, sizeof(payload), frame, capacity);
+}
+
+bool TelemetryProtocol::decodeAck(const uint8_t* payload, size_t length, Ack& ack) {
+    if (length != HEADER_SIZE + 7 || getType(payload) != MessageType::ACK) {
+        return false;
+    }
+    ack.sequence = payload[HEADER_SIZE];
+    ack.opcode = static_cast<CommandOpcode>(payload[HEADER_SIZE + 1]);
+    ack.status = static_cast<AckStatus>(payload[HEADER_SIZE + 2]);
+    ack.value = getU32(&payload[HEADER_SIZE + 3]);
+    return true;
+}
+
+size_t TelemetryProtocol::encodeLoopTiming(const LoopTiming& timing, uint8_t sequence, uint8_t* frame,
+                                           size_t capacity) {
+    const uint32_t fields[] = {
+        timing.clock_hz, timing.period_cycles, timing.iterations,
+        static_cast<uint32_t>(timing.jitter_min), static_cast<uint32_t>(timing.jitter_max),
+        timing.duration_max, timing.misses, timing.lost_ticks, timing.worst_iteration,
+        static_cast<uint32_t>(timing.worst_lateness), timing.worst_duration, timing.worst_context
+    };
+    uint8_t payload[LOOP_TIMING_PAYLOAD];
+    putHeader(payload, MessageType::LOOP_TIMING, sequence);
+    uint8_t* p = &payload[HEADER_SIZE];
+    for (const uint32_t field : fields) {
+        putU32(p, field);
+        p += 4;
+    }
+    for (const uint32_t count : timing.histogram) {
+        putU32(p, count);
+        p += 4;
+    }
+    return encodeFrame(payload, sizeof(payload), frame, capacity);
+}
+
+bool TelemetryProtocol::decodeLoopTiming(const uint8_t* payload, size_t length, LoopTiming& timing) {
+    if (length != LOOP_TIMING_PAYLOAD || getType(payload) != MessageType::LOOP_TIMING) {
+        return false;
+    }
+    const uint8_t* p = &payload[HEADER_SIZE];
+    timing.clock_hz = getU32(p);
+    timing.period_cycles = getU32(p + 4);
+    timing.iterations = getU32(p + 8);
+    timing.jitter_min = static_cast<int32_t>(getU32(p + 12));
+    timing.jitter_max = static_cast<int32_t>(getU32(p + 16));
+    timing.duration_max = getU32(p + 20);
+    timing.misses = getU32(p + 24);
+    timing.lost_ticks = getU32(p + 28);
+    timing.worst_iteration = getU32(p + 32);
+    timing.worst_lateness = static_cast<int32_t>(getU32(p + 36));
+    timing.worst_duration = getU32(p + 40);
+    timing.worst_context = getU32(p + 44);
+    p += 48;
+    for (uint32_t& count : timing.histogram) {
+        count = getU32(p);
+        p += 4;
+    }
+    return true;
+}
+
+uint16_t TelemetryProtocol::floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const uint32_t abs_bits = bits & 0x7FFFFFFF;
+
+    if (abs_bits >= 0x7F800000) {
+        return sign | ((abs_bits > 0x7F800000) ? 0x7E00 : 0x7C00);  // NaN / infinity
+    }
+    if (abs_bits >= 0x477FF000) {
+        return sign | 0x7C00;  // Rounds above 65504: infinity
+    }
+    if (abs_bits < 0x38800000) {
+        // Subnormal half (or zero): shift the implicit-one mantissa down
+        if (abs_bits < 0x33000000) {
+            return sign;
+        }
+        const uint32_t exponent = abs_bits >> 23;
+        const uint32_t mantissa = (abs_bits & 0x7FFFFF) | 0x800000;
+        const uint32_t shift = 126 - exponent;  // 14..24
+        uint32_t half = mantissa >> shift;
+        const uint32_t rest = mantissa & ((1U << shift) - 1);
+        const uint32_t halfway = 1U << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) {
+            half++;
+        }
+        return sign | static_cast<uint16_t>(half);
+    }
+
+    // Normal: rebias the exponent, round the mantissa to 10 bits
+    uint32_t half = ((abs_bits >> 13) - ((127 - 15) << 10));
+    const uint32_t rest = abs_bits & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+        half++;  // May carry into the exponent, which is still correct
+    }
+    return sign | static_cast<uint16_t>(half);
+}
+
+float TelemetryProtocol::halfToFloat(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t bits;
+
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // Subnormal: normalise
+        exponent = 127 - 15 + 1;
+        while ((mantissa & 0x400) == 0) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+TelemetryEncoder::TelemetryEncoder()
+    : payload_{}
+    , frame_{}
+    , frame_length_(0)
+    , count_(0)
+    , next_time_us_(0)
+    , period_us_(0)
+    , last_target_(0)
+    , last_actual_(0)
+    , sequence_(0)
+{
+}
+
+bool TelemetryEncoder::add(const TelemetryProtocol::Sample& sample, uint16_t period_us) {
+    bool completed = false;
+
+    if (count_ > 0 && (period_us != period_us_ || sample.time_us != next_time_us_ || !append(sample))) {
+        completed = flush();
+    }
+    if (count_ == 0) {
+        begin(sample, period_us);
+        append(sample);
+    }
+
+    if (count_ == TelemetryProtocol::MAX_BATCH_SAMPLES) {
+        completed = flush();
+    }
+    return completed;
+}
+
+bool TelemetryEncoder::flush() {
+    if (count_ == 0) {
+        return false;
+    }
+    using P = TelemetryProtocol;
+    payload_[P::HEADER_SIZE + 6] = static_cast<uint8_t>(count_);
+    const size_t length = P::HEADER_SIZE + P::TELEMETRY_HEADER_SIZE + count_ * P::SAMPLE_SIZE;
+    frame_length_ = P::encodeFrame(payload_, length, frame_, sizeof(frame_));
+    count_ = 0;
+    sequence_++;
+    return frame_length_ > 0;
+}
+
+void TelemetryEncoder::begin(const TelemetryProtocol::Sample& sample, uint16_t period_us) {
+    using P = TelemetryProtocol;
+    putHeader(payload_, P::MessageType::TELEMETRY, sequence_);
+
+    // Deltas of the first sample are zero against these bases
+    last_target_ = quantisePosition(sample.target_position);
+    last_actual_ = quantisePosition(sample.actual_position);
+
+    uint8_t* body = payload_ + P::HEADER_SIZE;
+    putU32(body, sample.time_us);
+    putU16(body + 4, period_us);
+    body[6] = 0;
+    body[7] = 0;
+    putU32(body + 8, static_cast<uint32_t>(last_target_));
+    putU32(body + 12, static_cast<uint32_t>(last_actual_));
+
+    period_us_ = period_us;
+    next_time_us_ = sample.time_us;
+}
+
+bool TelemetryEncoder::append(const TelemetryProtocol::Sample& sample) {
+    using P = TelemetryProtocol;
+    const int32_t target = quantisePosition(sample.target_position);
+    const int32_t actual = quantisePosition(sample.actual_position);
+    const int32_t d_target = target - last_target_;
+    const int32_t d_actual = actual - last_actual_;
+    if (d_target < INT16_MIN || d_target > INT16_MAX || d_actual < INT16_MIN || d_actual > INT16_MAX) {
+        return false;
+    }
+
+    uint8_t* p = payload_ + P::HEADER_SIZE + P::TELEMETRY_HEADER_SIZE + count_ * P::SAMPLE_SIZE;
+    putU16(p, static_cast<uint16_t>(d_target));
+    putU16(p + 2, static_cast<uint16_t>(d_actual));
+    putU16(p + 4, P::floatToHalf(sample.target_velocity));
+    putU16(p + 6, P::floatToHalf(sample.actual_velocity));
+    p[8] = static_cast<uint8_t>(static_cast<int8_t>(
+        std::lround(std::clamp(sample.pid_output, static_cast<float>(INT8_MIN), static_cast<float>(INT8_MAX)))));
+    p[9] = sample.phase;
+
+    last_target_ = target;
+    last_actual_ = actual;
+    next_time_us_ = sample.time_us + period_us_;
+    count_++;
+    return true;
+}
@@ -0,0 +1,144 @@
+#include "hal/CycleProfiler.hpp"
+#include "main.h"
+#include <stdio.h>
+#include <algorithm>
+#include <cstring>
+
+CycleProfiler::Stats CycleProfiler::stats_[PROBE_COUNT];
+uint32_t CycleProfiler::overhead_ = 0;
+volatile bool CycleProfiler::enabled_ = true;
+
+namespace {
+
+const char* const PROBE_NAMES[CycleProfiler::PROBE_COUNT] = {
+    "CONTROL_LOOP",
+    "PLANNER_UPDATE",
+    "COORDINATOR_UPDATE",
+    "PROFILE_EVALUATE",
+    "PROFILE_STEP",
+    "PWM_UPDATE",
+    "MOVE_START"
+};
+
+constexpr uint32_t CALIBRATION_RUNS = 64;
+
+/**
+ * @brief Histogram bin of a measurement: floor(log2(ticks)), capped
+ */
+uint32_t histogram_bin(uint32_t ticks) {
+    if (ticks == 0) {
+        return 0;
+    }
+    const uint32_t bin = 31U - static_cast<uint32_t>(__builtin_clz(ticks));
+    return std::min(bin, CycleProfiler::HISTOGRAM_BINS - 1);
+}
+
+}  // namespace
+
+void CycleProfiler::init() {
+#ifndef HOST_SIM
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    // Cheapest empty measurement: what a probe adds to what it measures
+    uint32_t overhead = UINT32_MAX;
+    for (uint32_t i = 0; i < CALIBRATION_RUNS; i++) {
+        const uint32_t start = now();
+        overhead = std::min(overhead, now() - start);
+    }
+    overhead_ = overhead;
+    reset();
+}
+
+uint32_t CycleProfiler::getTickRate() {
+#ifdef HOST_SIM
+    return 1000000000U;
+#else
+    return SystemCoreClock;
+#endif
+}
+
+void CycleProfiler::record(Probe probe, uint32_t ticks) {
+    const uint32_t index = static_cast<uint32_t>(probe);
+    if (index >= PROBE_COUNT) {
+        return;
+    }
+    ticks = (ticks > overhead_) ? ticks - overhead_ : 0;
+
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    Stats& stats = stats_[index];
+    if (stats.count == 0 || ticks < stats.min) {
+        stats.min = ticks;
+    }
+    stats.max = std::max(stats.max, ticks);
+    stats.count++;
+    stats.total += ticks;
+    stats.histogram[histogram_bin(ticks)]++;
+    __set_PRIMASK(primask);
+}
+
+CycleProfiler::Stats CycleProfiler::getStats(Probe probe) {
+    Stats copy = {};
+    const uint32_t index = static_cast<uint32_t>(probe);
+    if (index < PROBE_COUNT) {
+        const uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        copy = stats_[index];
+        __set_PRIMASK(primask);
+    }
+    return copy;
+}
+
+void CycleProfiler::reset() {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    std::memset(stats_, 0, sizeof(stats_));
+    __set_PRIMASK(primask);
+}
+
+const char* CycleProfiler::getName(Probe probe) {
+    const uint32_t index = static_cast<uint32_t>(probe);
+    return (index < PROBE_COUNT) ? PROBE_NAMES[index] : "?";
+}
+
+bool CycleProfiler::report(uint32_t budget_hz) {
+#ifdef HOST_SIM
+    const char* unit = "ns";
+#else
+    const char* unit = "cycles";
+#endif
+    printf("PROFILE,%s,%lu ticks/s,overhead %lu\r\n", unit, getTickRate(), overhead_);
+
+    // name,count,min,mean,max,then bin:count for every non-empty log2 bin
+    for (uint32_t i = 0; i < PROBE_COUNT; i++) {
+        const Stats stats = getStats(static_cast<Probe>(i));
+        if (stats.count == 0) {
+            continue;
+        }
+        char line[256];
+        int length = snprintf(line, sizeof(line), "PROBE,%s,%lu,%lu,%lu,%lu,",
+                              PROBE_NAMES[i], stats.count, stats.min,
+                              static_cast<uint32_t>(stats.total / stats.count), stats.max);
+        for (uint32_t bin = 0; bin < HISTOGRAM_BINS && length < static_cast<int>(sizeof(line)); bin++) {
+            if (stats.histogram[bin] != 0) {
+                length += snprintf(line + length, sizeof(line) - length, " %lu:%lu",
+                                   bin, stats.histogram[bin]);
+            }
+        }
+        // One write per line so telemetry frames never land inside it
+        printf("%s\r\n", line);
+    }
+
+    if (budget_hz == 0) {
+        return true;
+    }
+    const Stats loop = getStats(Probe::CONTROL_LOOP);
+    const uint32_t budget = getTickRate() / budget_hz;
+    const bool fits = loop.max <= budget;
+    printf("BUDGET,%lu Hz,%lu of %lu %s (%lu%%),%s\r\n", budget_hz, loop.max, budget, unit,
+           static_cast<uint32_t>(static_cast<uint64_t>(loop.max) * 100U / budget),
+           fits ? "OK" : "OVER");
+    return fits;
+}
@@ -0,0 +1,106 @@
+#include "hal/LoopTimingRecorder.hpp"
+#include "main.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+/**
+ * @brief Histogram bin of a jitter magnitude: floor(log2(cycles)), capped
+ */
+uint32_t histogram_bin(uint32_t cycles) {
+    if (cycles == 0) {
+        return 0;
+    }
+    const uint32_t bin = 31U - static_cast<uint32_t>(__builtin_clz(cycles));
+    return std::min(bin, LoopTimingRecorder::HISTOGRAM_BINS - 1);
+}
+
+}  // namespace
+
+LoopTimingRecorder::LoopTimingRecorder()
+    : stats_{}
+    , last_entry_(0)
+    , due_(0)
+    , started_(false)
+{
+}
+
+void LoopTimingRecorder::start(uint32_t period_cycles) {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stats_ = Snapshot{};
+    stats_.period_cycles = period_cycles;
+    started_ = false;
+    __set_PRIMASK(primask);
+}
+
+void LoopTimingRecorder::onEntry(uint32_t cycles) {
+    const uint32_t period = stats_.period_cycles;
+    if (!started_) {
+        // The first entry anchors the schedule
+        started_ = true;
+        due_ = cycles;
+        last_entry_ = cycles;
+        stats_.iterations++;
+        return;
+    }
+
+    const int32_t jitter = static_cast<int32_t>(cycles - last_entry_ - period);
+    if (stats_.iterations < 2) {
+        stats_.jitter_min = jitter;
+        stats_.jitter_max = jitter;
+    } else {
+        stats_.jitter_min = std::min(stats_.jitter_min, jitter);
+        stats_.jitter_max = std::max(stats_.jitter_max, jitter);
+    }
+    stats_.histogram[histogram_bin(static_cast<uint32_t>(std::abs(jitter)))]++;
+    last_entry_ = cycles;
+    stats_.iterations++;
+
+    // A whole period behind schedule: those timer updates were lost
+    due_ += period;
+    const int32_t late = static_cast<int32_t>(cycles - due_);
+    if (period != 0 && late >= static_cast<int32_t>(period)) {
+        const uint32_t lost = static_cast<uint32_t>(late) / period;
+        stats_.lost_ticks += lost;
+        due_ += lost * period;
+    }
+}
+
+void LoopTimingRecorder::onExit(uint32_t cycles, uint32_t context) {
+    if (!started_) {
+        return;
+    }
+    const uint32_t duration = cycles - last_entry_;
+    stats_.duration_max = std::max(stats_.duration_max, duration);
+
+    // Must be done before the next update is due
+    const int32_t lateness = static_cast<int32_t>(cycles - (due_ + stats_.period_cycles));
+    if (lateness > 0) {
+        stats_.misses++;
+        if (lateness > stats_.worst_lateness) {
+            stats_.worst_iteration = stats_.iterations - 1;
+            stats_.worst_lateness = lateness;
+            stats_.worst_duration = duration;
+            stats_.worst_context = context;
+        }
+    }
+}
+
+LoopTimingRecorder::Snapshot LoopTimingRecorder::getSnapshot() const {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const Snapshot copy = stats_;
+    __set_PRIMASK(primask);
+    return copy;
+}
+
+void LoopTimingRecorder::reset() {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const uint32_t period = stats_.period_cycles;
+    stats_ = Snapshot{};
+    stats_.period_cycles = period;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,37 @@
+#include "hal/QuadratureEncoder.hpp"
+#include "util/RamCode.hpp"
+
+QuadratureEncoder::QuadratureEncoder(const Config& config)
+    : config_(config)
+    , running_(false)
+    , count_(0)
+    , count_last_(0)
+{
+    running_ = HAL_TIM_Encoder_Start(config_.timer, TIM_CHANNEL_ALL) == HAL_OK;
+    count_last_ = static_cast<uint16_t>(config_.timer->Instance->CNT);
+}
+
+RAM_CODE int32_t QuadratureEncoder::getCount() {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    accumulate();
+    const int32_t count = count_;
+    __set_PRIMASK(primask);
+    return count;
+}
+
+void QuadratureEncoder::setCount(int32_t count) {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    accumulate();
+    count_ = count;
+    __set_PRIMASK(primask);
+}
+
+RAM_CODE void QuadratureEncoder::accumulate() {
+    // Modulo 2^16, signed: correct while less than 32768 counts came in between
+    const uint16_t count = static_cast<uint16_t>(config_.timer->Instance->CNT);
+    const int32_t delta = static_cast<int16_t>(static_cast<uint16_t>(count - count_last_));
+    count_last_ = count;
+    count_ += config_.invert ? -delta : delta;
+}
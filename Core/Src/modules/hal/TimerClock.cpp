@@ -0,0 +1,51 @@
+#include "hal/TimerClock.hpp"
+#include "util/RamCode.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float LARGEST_PERIOD = 4294967040.0f;  // Largest float below 2^32
+
+bool on_apb2(const TIM_TypeDef* instance) {
+    return instance == TIM1 || instance == TIM9 || instance == TIM10 || instance == TIM11;
+}
+
+}  // namespace
+
+uint32_t TimerClock::getClock(const TIM_TypeDef* instance) {
+    const bool apb2 = on_apb2(instance);
+    const uint32_t pclk = apb2 ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+    const uint32_t ppre = apb2 ? (RCC->CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos
+                               : (RCC->CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos;
+    // PPREx: 0xx = not divided, 100 = /2, 101 = /4, 110 = /8, 111 = /16
+    const bool divided = (ppre & 0x4U) != 0;
+
+    if ((RCC->DCKCFGR & RCC_DCKCFGR_TIMPRE) != 0) {
+        // Up to /4 the timers run at HCLK, beyond at 4x PCLK
+        return (!divided || ppre <= 0x5U) ? HAL_RCC_GetHCLKFreq() : 4U * pclk;
+    }
+    return divided ? 2U * pclk : pclk;
+}
+
+uint32_t TimerClock::getMaxPeriod(const TIM_TypeDef* instance) {
+    return (instance == TIM2 || instance == TIM5) ? 0xFFFFFFFFU : 0x10000U;
+}
+
+RAM_CODE bool TimerClock::solve(uint32_t clock, float frequency, uint32_t max_period, uint32_t min_period,
+                                Setting& setting) {
+    const float longest = std::min(static_cast<float>(max_period), LARGEST_PERIOD);
+    const float ticks = (frequency > 0.0f) ? static_cast<float>(clock) / frequency
+                                           : longest * (MAX_PRESCALER + 1);
+
+    // Smallest prescaler that fits the period: the finest frequency steps
+    const float divider = std::clamp(std::ceil(ticks / longest), 1.0f, static_cast<float>(MAX_PRESCALER + 1));
+    const float exact = ticks / divider;
+    const float period = std::clamp(std::round(exact), static_cast<float>(min_period), longest);
+
+    setting.prescaler = static_cast<uint32_t>(divider) - 1U;
+    setting.period = static_cast<uint32_t>(period);
+    setting.frequency = static_cast<float>(clock) / (divider * period);
+    setting.error = (frequency > 0.0f) ? setting.frequency / frequency - 1.0f : 0.0f;
+    return frequency > 0.0f && exact >= static_cast<float>(min_period) - 0.5f && exact <= longest + 0.5f;
+}
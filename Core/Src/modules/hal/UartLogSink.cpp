@@ -0,0 +1,128 @@
+#include "hal/UartLogSink.hpp"
+#include <algorithm>
+#include <cstring>
+
+extern UART_HandleTypeDef huart2;  // Declared in main.c
+
+namespace {
+
+UartLogSink g_console(&huart2);
+
+}  // namespace
+
+UartLogSink::UartLogSink(UART_HandleTypeDef* huart)
+    : huart_(huart)
+    , buffer_{}
+    , head_(0)
+    , tail_(0)
+    , in_flight_(0)
+    , dropped_writes_(0)
+    , dropped_bytes_(0)
+{
+}
+
+UartLogSink& UartLogSink::console() {
+    return g_console;
+}
+
+bool UartLogSink::write(const char* data, uint32_t length) {
+    if (length == 0) {
+        return true;
+    }
+
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (length > BUFFER_SIZE - (head_ - tail_)) {
+        dropped_writes_ = dropped_writes_ + 1;
+        dropped_bytes_ = dropped_bytes_ + length;
+        __set_PRIMASK(primask);
+        return false;
+    }
+
+    // Copy in at most two pieces around the wrap
+    const uint32_t offset = head_ & MASK;
+    const uint32_t first = std::min(length, BUFFER_SIZE - offset);
+    std::memcpy(&buffer_[offset], data, first);
+    std::memcpy(&buffer_[0], data + first, length - first);
+    head_ = head_ + length;
+
+    if (in_flight_ == 0) {
+        startTransfer();
+    }
+
+    __set_PRIMASK(primask);
+    return true;
+}
+
+bool UartLogSink::flush(uint32_t timeout_ms) {
+    const uint32_t start = HAL_GetTick();
+    while (getPending() > 0) {
+        if (HAL_GetTick() - start >= timeout_ms) {
+            return false;
+        }
+        // A transfer that failed to start is retried here
+        const uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (in_flight_ == 0) {
+            startTransfer();
+        }
+        __set_PRIMASK(primask);
+        HAL_Delay(1);
+    }
+    return true;
+}
+
+void UartLogSink::onTransferComplete() {
+    tail_ = tail_ + in_flight_;
+    in_flight_ = 0;
+    startTransfer();
+}
+
+void UartLogSink::onError() {
+    // Only a TX DMA error ends the transfer (gState back to ready); what was
+    // on the wire is lost. Receive errors leave the transfer running.
+    if (in_flight_ != 0 && huart_->gState == HAL_UART_STATE_READY) {
+        onTransferComplete();
+    }
+}
+
+void UartLogSink::startTransfer() {
+    const uint32_t pending = head_ - tail_;
+    if (pending == 0) {
+        return;
+    }
+
+    // Contiguous run up to the wrap, in chunks so space frees up steadily
+    const uint32_t offset = tail_ & MASK;
+    const uint32_t length = std::min({pending, BUFFER_SIZE - offset, MAX_TRANSFER});
+    if (HAL_UART_Transmit_DMA(huart_, &buffer_[offset], static_cast<uint16_t>(length)) == HAL_OK) {
+        in_flight_ = length;
+    }
+    // Otherwise the next write() or flush() tries again
+}
+
+// C linkage for HAL callbacks and newlib
+extern "C" {
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart) {
+    if (huart == g_console.getUart()) {
+        g_console.onTransferComplete();
+    }
+}
+
+#ifndef HOST_SIM
+/**
+ * @brief printf() back end - overrides the blocking weak one in syscalls.c
+ */
+int _write(int file, char* ptr, int len) {
+    (void)file;
+    if (len > 0) {
+        g_console.write(ptr, static_cast<uint32_t>(len));
+    }
+    // Dropped output still counts as written so stdio does not retry
+    return len;
+}
+#endif
+
+} // extern "C"
@@ -1,4 +1,8 @@
 #include "motor/MotionPlanner.hpp"
+#include "hal/CycleProfiler.hpp"
+#include "hal/TimerClock.hpp"
+#include "util/RamCode.hpp"
+#include <algorithm>
 #include <cmath>
 
 MotionPlanner::MotionPlanner()
@@ -6,129 +10,596 @@ MotionPlanner::MotionPlanner()
     , current_position_(0.0f)
     , current_velocity_(0.0f)
     , target_position_(0.0f)
-    , start_time_ms_(0)
+    , start_position_(0.0f)
+    , direction_(1.0f)
+    , planned_position_(0.0f)
+    , ticks_(0)
+    , exit_velocity_(0.0f)
+    , limits_{}
+    , stopping_(false)
+    , jog_()
+    , jogging_(false)
     , update_freq_hz_(1000)
     , dt_(0.001f)
     , htim_(nullptr)
+    , step_engine_(nullptr)
     , speed_callback_(nullptr)
     , direction_callback_(nullptr)
+    , position_callback_(nullptr)
 {
 }
 
 void MotionPlanner::init(TIM_HandleTypeDef* htim, uint32_t update_freq_hz) {
     htim_ = htim;
-    update_freq_hz_ = update_freq_hz;
-    dt_ = 1.0f / static_cast<float>(update_freq_hz);
+    update_freq_hz_ = std::clamp(update_freq_hz, MIN_UPDATE_FREQ_HZ, MAX_UPDATE_FREQ_HZ);
+    dt_ = 1.0f / static_cast<float>(update_freq_hz_);
     state_ = State::IDLE;
+    
+    if (htim_ != nullptr) {
+        configureTimer();
+    }
+}
+
+void MotionPlanner::configureTimer() {
+    HAL_TIM_Base_Stop_IT(htim_);
+    
+    // Count at 1 MHz so every rate in range is an integer number of ticks
+    const uint32_t timer_clock = TimerClock::getClock(htim_->Instance);
+    const uint32_t tick_hz = 1000000;
+    const uint32_t prescaler = timer_clock / tick_hz - 1;
+    const uint32_t period = tick_hz / update_freq_hz_;
+    
+    __HAL_TIM_SET_PRESCALER(htim_, prescaler);
+    __HAL_TIM_SET_AUTORELOAD(htim_, period - 1);
+    __HAL_TIM_SET_COUNTER(htim_, 0);
+    
+    // Load PSC now, without taking an interrupt for it
+    htim_->Instance->EGR = TIM_EGR_UG;
+    __HAL_TIM_CLEAR_FLAG(htim_, TIM_FLAG_UPDATE);
+    
+    dt_ = static_cast<float>(period) * static_cast<float>(prescaler + 1) / static_cast<float>(timer_clock);
+    
+    HAL_TIM_Base_Start_IT(htim_);
+}
+
+void MotionPlanner::maskUpdates() {
+    if (htim_ != nullptr) {
+        __HAL_TIM_DISABLE_IT(htim_, TIM_IT_UPDATE);
+    }
+}
+
+void MotionPlanner::unmaskUpdates() {
+    if (htim_ != nullptr) {
+        __HAL_TIM_ENABLE_IT(htim_, TIM_IT_UPDATE);
+    }
 }
 
 bool MotionPlanner::moveTo(float target_steps, float max_velocity, 
                            float max_acceleration, float max_jerk) {
-    if (state_ == State::RUNNING) {
-        return false;  // Already running
+    if (state_ == State::RUNNING || !queue_.empty()) {
+        return retarget(target_steps, max_velocity, max_acceleration, max_jerk);
     }
     
-    // Calculate relative move from current position
-    float distance = target_steps - current_position_;
-    bool forward = distance >= 0;
-    float abs_distance = std::fabs(distance);
-    
-    if (abs_distance < 0.1f) {
+    // Calculate relative move from current position (as counted, so the
+    // error of earlier moves is made up here)
+    current_position_ = measuredPosition();
+    planned_position_ = current_position_;
+    if (std::fabs(target_steps - current_position_) < 0.1f) {
         // Already at target
         state_ = State::COMPLETED;
         return true;
     }
     
-    // Set direction
-    if (direction_callback_) {
-        direction_callback_(forward);
+    Segment segment;
+    if (!buildSegment(segment, planned_position_, target_steps, max_velocity, max_acceleration, max_jerk)) {
+        state_ = State::ERROR;
+        return false;
+    }
+    
+    // Start now rather than on the next tick, bypassing the queue
+    maskUpdates();
+    profile_ = segment.plans[0].profile;
+    const bool started = startMove(segment, 0.0f);
+    if (started) {
+        planned_position_ = target_steps;
+    } else {
+        state_ = State::ERROR;
+    }
+    unmaskUpdates();
+    return started;
+}
+
+bool MotionPlanner::queueMove(float target_steps, float max_velocity,
+                              float max_acceleration, float max_jerk) {
+    if (isJogging()) {
+        return false;
+    }
+    if (isComplete()) {
+        planned_position_ = current_position_;  // A jog ended away from any target
+    }
+    if (std::fabs(target_steps - planned_position_) < 0.1f) {
+        return true;  // Ends where the previous move ends
+    }
+    return pushSegment(target_steps, max_velocity, max_acceleration, max_jerk);
+}
+
+bool MotionPlanner::buildSegment(Segment& segment, float from, float target_steps, float max_velocity,
+                                 float max_acceleration, float max_jerk) {
+    const float distance = target_steps - from;
+    
+    segment.limits = SCurveProfile::Config();
+    segment.limits.max_velocity = max_velocity;
+    segment.limits.max_acceleration = max_acceleration;
+    segment.limits.max_jerk = max_jerk;
+    segment.target_position = target_steps;
+    segment.distance = std::fabs(distance);
+    segment.forward = distance >= 0;
+    segment.plans[0].entry_velocity = 0.0f;
+    segment.plans[0].exit_velocity = 0.0f;
+    segment.plan.store(0, std::memory_order_relaxed);
+    
+    // Reject bad limits here, where the caller can see it; the junction
+    // velocities planned later keep every profile feasible
+    return segment.plans[0].profile.calculate(segment.distance, segment.limits);
+}
+
+bool MotionPlanner::pushSegment(float target_steps, float max_velocity,
+                                float max_acceleration, float max_jerk) {
+    // Built in the free slot, unseen by the ISR until published
+    Segment* segment = queue_.reserve();
+    if (segment == nullptr ||
+        !buildSegment(*segment, planned_position_, target_steps, max_velocity, max_acceleration, max_jerk)) {
+        return false;
+    }
+    
+    // Engine restarts between moves, so each one must end at rest
+    if (step_engine_ != nullptr) {
+        queue_.publish();
+        planned_position_ = target_steps;
+        return true;
+    }
+    
+    // Window: the queued moves the ISR has not started yet, newest first
+    // while collecting; the oldest one's entry is fixed by the move before
+    uint32_t count = 0;
+    while (count < LOOKAHEAD_MOVES) {
+        Segment* queued = queue_.back(count);
+        if (queued == nullptr) {
+            break;
+        }
+        const uint8_t plan = queued->plan.load(std::memory_order_acquire);
+        if ((plan & PLAN_STARTED) != 0) {
+            break;
+        }
+        window_[count].segment = queued;
+        window_[count].plan = plan;
+        window_[count].entry_velocity = queued->plans[plan].entry_velocity;
+        window_[count].exit_velocity = queued->plans[plan].exit_velocity;
+        count++;
+    }
+    std::reverse(window_, window_ + count);
+    window_[count].segment = segment;
+    window_[count].plan = 0;
+    window_[count].entry_velocity = 0.0f;
+    window_[count].exit_velocity = 0.0f;
+    
+    float exits[LOOKAHEAD_MOVES + 1];
+    for (uint32_t i = 0; i <= count; i++) {
+        exits[i] = window_[i].exit_velocity;
+    }
+    planJunctions(window_, count + 1);
+    
+    // Replan the moves with a raised junction at either end into their
+    // spare plans (the new one was planned from rest, in place)
+    bool replan[LOOKAHEAD_MOVES + 1];
+    bool entry_raised = false;
+    for (uint32_t i = 0; i <= count; i++) {
+        const bool exit_raised = window_[i].exit_velocity != exits[i];
+        replan[i] = entry_raised || exit_raised;
+        entry_raised = exit_raised;
+        if (!replan[i]) {
+            continue;
+        }
+        
+        Segment& move = *window_[i].segment;
+        Plan& plan = move.plans[(i < count) ? (window_[i].plan ^ 1) : 0];
+        SCurveProfile::Config config = move.limits;
+        config.start_velocity = window_[i].entry_velocity;
+        config.end_velocity = window_[i].exit_velocity;
+        if (!plan.profile.calculate(move.distance, config)) {
+            return false;
+        }
+        plan.entry_velocity = window_[i].entry_velocity;
+        plan.exit_velocity = window_[i].exit_velocity;
     }
+    queue_.publish();
+    planned_position_ = target_steps;
     
-    // Setup S-curve profile
-    SCurveProfile::Config config;
-    config.max_velocity = max_velocity;
-    config.max_acceleration = max_acceleration;
-    config.max_jerk = max_jerk;
-    config.start_velocity = 0.0f;  // Start from rest
+    // Swap the new plans in newest first, up to the first move the ISR has
+    // started meanwhile: everything older has started too, and the move
+    // after it just starts lower than planned
+    for (uint32_t i = count; i-- > 0;) {
+        if (!replan[i]) {
+            continue;
+        }
+        uint8_t expected = window_[i].plan;
+        if (!window_[i].segment->plan.compare_exchange_strong(expected, expected ^ 1, std::memory_order_acq_rel)) {
+            break;
+        }
+    }
+    return true;
+}
+
+void MotionPlanner::planJunctions(WindowMove* window, uint32_t count) {
+    // Backward pass: the newest move ends at rest, each junction is bounded
+    // by both moves' limits and by what the later move can shed
+    window[count - 1].exit_velocity = 0.0f;
+    for (uint32_t i = count - 1; i >= 1; i--) {
+        const WindowMove& next = window[i];
+        WindowMove& prev = window[i - 1];
+        if (prev.segment->forward != next.segment->forward) {
+            prev.exit_velocity = 0.0f;  // Reversal: meet at rest
+            continue;
+        }
+        const float entry_velocity = SCurveProfile::reachableVelocity(next.exit_velocity, next.segment->distance, next.segment->limits);
+        prev.exit_velocity = std::min(std::min(prev.segment->limits.max_velocity, next.segment->limits.max_velocity), entry_velocity);
+    }
     
-    if (!profile_.calculate(abs_distance, config)) {
+    // Forward: no faster than each move can accelerate to from its entry
+    for (uint32_t i = 0; i < count; i++) {
+        WindowMove& move = window[i];
+        move.exit_velocity = std::min(move.exit_velocity,
+            SCurveProfile::reachableVelocity(move.entry_velocity, move.segment->distance, move.segment->limits));
+        if (i + 1 < count) {
+            window[i + 1].entry_velocity = move.exit_velocity;
+        }
+    }
+}
+
+bool MotionPlanner::startQueuedMove(float start_time) {
+    Segment* segment = queue_.peek();
+    if (segment == nullptr) {
+        return false;
+    }
+    PROFILE_SCOPE(MOVE_START);
+    
+    // Lock the plan pushSegment() swapped in last
+    const Plan& plan = segment->plans[segment->plan.fetch_or(PLAN_STARTED, std::memory_order_acq_rel) & 1];
+    bool started = true;
+    if (plan.entry_velocity == exit_velocity_) {
+        profile_ = plan.profile;
+    } else {
+        // The move before started on its older plan, at a lower exit
+        SCurveProfile::Config config = segment->limits;
+        config.start_velocity = exit_velocity_;
+        config.end_velocity = std::min(plan.exit_velocity,
+            SCurveProfile::reachableVelocity(exit_velocity_, segment->distance, segment->limits));
+        started = profile_.calculate(segment->distance, config);
+    }
+    if (!started || !startMove(*segment, start_time)) {
+        // Later moves were planned from this one's target
+        queue_.clear();
+        exit_velocity_ = 0.0f;
         state_ = State::ERROR;
         return false;
     }
+    queue_.pop();
+    return true;
+}
+
+bool MotionPlanner::startMove(const Segment& segment, float start_time) {
+    if (direction_callback_) {
+        // Set direction (unchanged when entering at speed)
+        direction_callback_(segment.forward);
+    }
+    if (step_engine_ != nullptr &&
+        !step_engine_->start(profile_, static_cast<uint32_t>(std::lround(segment.distance)))) {
+        return false;
+    }
     
-    // Start motion
-    target_position_ = target_steps;
-    start_time_ms_ = HAL_GetTick();
+    // Start motion along profile_
+    limits_ = segment.limits;
+    stopping_ = false;
+    jogging_ = false;
+    target_position_ = segment.target_position;
+    start_position_ = current_position_;
+    direction_ = segment.forward ? 1.0f : -1.0f;
+    exit_velocity_ = profile_.getEndVelocity();
+    stepper_.start(profile_, dt_, start_time);
     state_ = State::RUNNING;
-    
     return true;
 }
 
 void MotionPlanner::stop() {
+    // Held off while the state is reset; the ISR drops the queued moves
+    maskUpdates();
+    if (step_engine_) {
+        step_engine_->stop();
+    }
     if (speed_callback_) {
         speed_callback_(0.0f);
     }
+    queue_.discard();
     state_ = State::IDLE;
+    stopping_ = false;
+    jogging_ = false;
     current_velocity_ = 0.0f;
+    exit_velocity_ = 0.0f;
+    // Where the axis stopped, not where the profile was
+    current_position_ = measuredPosition();
+    planned_position_ = current_position_;
+    unmaskUpdates();
+}
+
+bool MotionPlanner::decelerateToStop() {
+    maskUpdates();
+    if (state_ != State::RUNNING || step_engine_ != nullptr) {
+        unmaskUpdates();
+        return false;
+    }
+    
+    if (jogging_) {
+        jog_.setTarget(0.0f, jog_.getMaxAcceleration(), jog_.getMaxJerk());
+        stopping_ = true;
+        unmaskUpdates();
+        return true;
+    }
+    
+    // Ramp from the state the last tick commanded, within the move's limits
+    const SCurveProfile::State& live = stepper_.getState();
+    SCurveProfile ramp;
+    if (live.is_complete || !ramp.calculateStop(live.velocity, live.acceleration, limits_)) {
+        unmaskUpdates();
+        return false;
+    }
+    queue_.discard();
+    startTransition(ramp, limits_);
+    stopping_ = true;
+    unmaskUpdates();
+    return true;
+}
+
+bool MotionPlanner::retarget(float target_steps, float max_velocity,
+                             float max_acceleration, float max_jerk) {
+    if (step_engine_ != nullptr) {
+        return false;  // The running profile is already in the DMA table
+    }
+    
+    SCurveProfile::Config limits;
+    limits.max_velocity = max_velocity;
+    limits.max_acceleration = max_acceleration;
+    limits.max_jerk = max_jerk;
+    
+    // Solve from a snapshot of the last tick with the ISR running, then
+    // take the result over only if no tick ran meanwhile (a tick is far
+    // longer than the solves, so this rarely goes round twice)
+    for (;;) {
+        maskUpdates();
+        if (state_ != State::RUNNING) {
+            queue_.discard();
+            unmaskUpdates();
+            return moveTo(target_steps, max_velocity, max_acceleration, max_jerk);
+        }
+        const uint32_t tick = ticks_;
+        const SCurveProfile::State live = liveState();
+        // The commanded position: mid-move the counter trails it by the
+        // pulses of the current tick
+        const float position = current_position_;
+        const float direction = direction_;
+        unmaskUpdates();
+        
+        // Same direction: a profile from the live velocity and acceleration,
+        // if it can still stop at the target
+        const float remaining = direction * (target_steps - position);
+        SCurveProfile transition;
+        bool has_transition = false;
+        if (remaining > 0.0f && live.velocity <= max_velocity) {
+            SCurveProfile::Config config = limits;
+            config.start_velocity = live.velocity;
+            config.start_acceleration = live.acceleration;
+            has_transition = transition.calculate(remaining, config);
+        }
+        
+        // Otherwise stop first (or start from rest) and move from there
+        Segment segment;
+        bool has_move = false;
+        float stop_position = position;
+        if (!has_transition) {
+            has_transition = transition.calculateStop(live.velocity, live.acceleration, limits);
+            // The ramp ends between steps; the move from there starts on the
+            // one the counter rests on, as moveTo() starts on a counted one
+            if (has_transition) {
+                stop_position = std::round(position + direction * transition.getDistance());
+            }
+            has_move = std::fabs(target_steps - stop_position) >= 0.1f;
+            if (has_move && !buildSegment(segment, stop_position, target_steps, max_velocity, max_acceleration, max_jerk)) {
+                return false;  // Invalid limits: keep the running move
+            }
+        }
+        
+        maskUpdates();
+        if (ticks_ != tick) {
+            unmaskUpdates();
+            continue;
+        }
+        queue_.discard();
+        stopping_ = false;
+        jogging_ = false;
+        if (has_transition) {
+            startTransition(transition, limits);
+            if (has_move) {
+                planned_position_ = stop_position;
+            }
+        } else if (has_move) {
+            // No transition to run first: the new move starts on this tick's state
+            exit_velocity_ = 0.0f;
+            profile_ = segment.plans[0].profile;
+            if (startMove(segment, 0.0f)) {
+                planned_position_ = target_steps;
+            } else {
+                state_ = State::ERROR;
+            }
+        } else {
+            planned_position_ = current_position_;
+            exit_velocity_ = 0.0f;
+            current_velocity_ = 0.0f;
+            updateMotorSpeed(0.0f);
+            state_ = State::COMPLETED;
+        }
+        const bool ok = state_ != State::ERROR;
+        unmaskUpdates();
+        
+        // The move after the transition, planned from rest as any other
+        if (has_transition && has_move) {
+            pushSegment(target_steps, max_velocity, max_acceleration, max_jerk);
+        }
+        return ok;
+    }
+}
+
+void MotionPlanner::startTransition(const SCurveProfile& transition, const SCurveProfile::Config& limits) {
+    // Continues from the current tick along the running move's direction
+    profile_ = transition;
+    limits_ = limits;
+    start_position_ = current_position_;
+    target_position_ = current_position_ + direction_ * profile_.getDistance();
+    planned_position_ = target_position_;
+    exit_velocity_ = profile_.getEndVelocity();
+    jogging_ = false;
+    stepper_.start(profile_, dt_);
+    state_ = State::RUNNING;
+}
+
+bool MotionPlanner::jog(float velocity, float max_acceleration, float max_jerk) {
+    if (step_engine_ != nullptr || !std::isfinite(velocity) ||
+        !(max_acceleration > 0.0f) || !(max_jerk > 0.0f)) {
+        return false;
+    }
+    
+    maskUpdates();
+    if (!isJogging()) {
+        if (state_ == State::RUNNING) {
+            // Take over the running move where the last tick left it
+            const SCurveProfile::State& live = stepper_.getState();
+            jog_.reset(direction_ * live.velocity, direction_ * live.acceleration);
+        } else if (velocity == 0.0f) {
+            unmaskUpdates();
+            return true;  // Already at rest
+        } else {
+            jog_.reset(0.0f, 0.0f);
+            current_position_ = measuredPosition();
+            direction_ = (velocity > 0.0f) ? 1.0f : -1.0f;
+            if (direction_callback_) {
+                direction_callback_(velocity > 0.0f);
+            }
+        }
+        queue_.discard();
+        exit_velocity_ = 0.0f;
+        jogging_ = true;
+        state_ = State::RUNNING;
+    }
+    jog_.setTarget(velocity, max_acceleration, max_jerk);
+    stopping_ = false;
+    unmaskUpdates();
+    return true;
+}
+
+void MotionPlanner::updateJog() {
+    current_position_ += jog_.step(dt_);
+    const float velocity = jog_.getVelocity();
+    
+    // Reversing: the direction pin follows the sign of the velocity. The
+    // step output is stopped first, so the new direction starts on a fresh
+    // period rather than the long one buffered near zero velocity
+    if (velocity * direction_ < 0.0f) {
+        updateMotorSpeed(0.0f);
+        direction_ = -direction_;
+        if (direction_callback_) {
+            direction_callback_(direction_ > 0.0f);
+        }
+    }
+    current_velocity_ = velocity;
+    target_position_ = current_position_;
+    updateMotorSpeed(velocity);
+    
+    if (jog_.isSettled() && velocity == 0.0f) {
+        jogging_ = false;
+        state_ = State::COMPLETED;
+    }
+}
+
+SCurveProfile::State MotionPlanner::liveState() const {
+    if (!jogging_) {
+        return stepper_.getState();
+    }
+    // Along the current direction, as a profile state would be
+    SCurveProfile::State state = {};
+    state.velocity = direction_ * jog_.getVelocity();
+    state.acceleration = direction_ * jog_.getAcceleration();
+    return state;
 }
 
 MotionPlanner::Status MotionPlanner::getStatus() const {
     Status status;
     status.state = state_;
-    status.current_position = current_position_;
+    status.current_position = measuredPosition();
+    status.commanded_position = current_position_;
     status.current_velocity = current_velocity_;
     status.target_position = target_position_;
+    status.queue_depth = queue_.size();
     
-    if (state_ == State::RUNNING && profile_.isValid()) {
-        float elapsed = (HAL_GetTick() - start_time_ms_) / 1000.0f;
-        status.progress = elapsed / profile_.getTotalTime();
+    if (state_ == State::RUNNING && !jogging_ && profile_.isValid()) {
+        status.progress = stepper_.getTime() / profile_.getTotalTime();
         if (status.progress > 1.0f) status.progress = 1.0f;
+        status.phase = stepper_.getState().phase;
     } else {
         status.progress = (state_ == State::COMPLETED) ? 1.0f : 0.0f;
+        status.phase = 0;
     }
     
     return status;
 }
 
-void MotionPlanner::update() {
-    if (state_ != State::RUNNING) {
+RAM_CODE void MotionPlanner::update() {
+    PROFILE_SCOPE(PLANNER_UPDATE);
+    ticks_++;
+    if (state_ != State::RUNNING && !startQueuedMove(0.0f)) {
         return;
     }
-    
-    // Calculate elapsed time
-    uint32_t now = HAL_GetTick();
-    float elapsed_sec = (now - start_time_ms_) / 1000.0f;
-    
-    // Get state from S-curve profile
-    SCurveProfile::State profile_state = profile_.getStateAtTime(elapsed_sec);
-    
-    if (profile_state.is_complete) {
-        // Motion complete
-        current_position_ = target_position_;
-        current_velocity_ = 0.0f;
-        updateMotorSpeed(0.0f);
-        state_ = State::COMPLETED;
+    if (jogging_) {
+        updateJog();
         return;
     }
     
-    // Update current state
-    bool forward = (target_position_ >= current_position_);
+    // Advance profile time by one control period
+    const SCurveProfile::State* profile_state = &stepper_.step();
     
-    if (forward) {
-        current_position_ = target_position_ - profile_.getTotalTime() * profile_state.velocity 
-                          + elapsed_sec * profile_state.velocity;
-    } else {
-        current_position_ = target_position_ + profile_.getTotalTime() * profile_state.velocity 
-                          - elapsed_sec * profile_state.velocity;
+    // In engine mode the move ends with the last emitted step
+    if (profile_state->is_complete && !(step_engine_ && step_engine_->isRunning())) {
+        current_position_ = target_position_;
+        
+        // Next move takes over on this tick, keeping the time past the end
+        if (!startQueuedMove(stepper_.getTimePastEnd())) {
+            // Motion complete
+            current_velocity_ = 0.0f;
+            updateMotorSpeed(0.0f);
+            state_ = State::COMPLETED;
+            return;
+        }
+        profile_state = &stepper_.getState();
     }
     
-    current_velocity_ = profile_state.velocity;
+    // Update current state (profile is along the move, from rest at start)
+    current_position_ = start_position_ + direction_ * profile_state->position;
+    current_velocity_ = direction_ * profile_state->velocity;
     
-    // Update motor speed
-    updateMotorSpeed(profile_state.velocity);
+    // Update motor speed (steps come from the engine's DMA table otherwise)
+    if (step_engine_ == nullptr) {
+        updateMotorSpeed(profile_state->velocity);
+    }
 }
 
-void MotionPlanner::updateMotorSpeed(float velocity) {
+RAM_CODE void MotionPlanner::updateMotorSpeed(float velocity) {
     if (speed_callback_) {
         speed_callback_(std::fabs(velocity));
     }
@@ -142,3 +613,11 @@ void MotionPlanner::setDirectionCallback(void (*callback)(bool forward)) {
     direction_callback_ = callback;
 }
 
+void MotionPlanner::setPositionCallback(int32_t (*callback)()) {
+    position_callback_ = callback;
+}
+
+float MotionPlanner::measuredPosition() const {
+    return position_callback_ ? static_cast<float>(position_callback_()) : current_position_;
+}
+
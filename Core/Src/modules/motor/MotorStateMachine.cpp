@@ -1,5 +1,130 @@
 #include "motor/MotorStateMachine.hpp"
-#include <stdio.h>
+
+namespace {
+
+using State = MotorStateMachine::State;
+using Event = MotorStateMachine::Event;
+
+struct Transition {
+    State from;
+    Event event;
+    State to;
+};
+
+/**
+ * @brief Every legal transition; any other (state, event) pair is ignored
+ */
+constexpr Transition TRANSITIONS[] = {
+    { State::UNINITIALIZED, Event::INITIALIZE,      State::IDLE },
+    
+    { State::IDLE,          Event::ENABLE,          State::READY },
+    
+    { State::READY,         Event::DISABLE,         State::IDLE },
+    { State::READY,         Event::START_MOTION,    State::ACCELERATING },
+    { State::READY,         Event::HOME_COMMAND,    State::HOMING },
+    { State::READY,         Event::ERROR_DETECTED,  State::ERROR },
+    
+    { State::ACCELERATING,  Event::MOTION_COMPLETE, State::RUNNING },
+    { State::ACCELERATING,  Event::STOP,            State::DECELERATING },
+    { State::ACCELERATING,  Event::EMERGENCY_STOP,  State::STOPPING },
+    { State::ACCELERATING,  Event::ERROR_DETECTED,  State::ERROR },
+    
+    { State::RUNNING,       Event::MOTION_COMPLETE, State::DECELERATING },
+    { State::RUNNING,       Event::STOP,            State::DECELERATING },
+    { State::RUNNING,       Event::EMERGENCY_STOP,  State::STOPPING },
+    { State::RUNNING,       Event::ERROR_DETECTED,  State::ERROR },
+    
+    { State::DECELERATING,  Event::MOTION_COMPLETE, State::READY },
+    { State::DECELERATING,  Event::EMERGENCY_STOP,  State::STOPPING },
+    { State::DECELERATING,  Event::ERROR_DETECTED,  State::ERROR },
+    
+    { State::STOPPING,      Event::MOTION_COMPLETE, State::READY },
+    { State::STOPPING,      Event::ERROR_DETECTED,  State::ERROR },
+    
+    { State::HOMING,        Event::HOME_COMPLETE,   State::READY },
+    { State::HOMING,        Event::EMERGENCY_STOP,  State::STOPPING },
+    { State::HOMING,        Event::ERROR_DETECTED,  State::ERROR },
+    
+    { State::ERROR,         Event::ERROR_CLEARED,   State::IDLE },
+};
+
+constexpr uint32_t STATE_COUNT = MotorStateMachine::STATE_COUNT;
+constexpr uint32_t EVENT_COUNT = MotorStateMachine::EVENT_COUNT;
+constexpr uint8_t NO_TRANSITION = 0xFF;
+
+constexpr uint32_t ordinal(State state) { return static_cast<uint32_t>(state); }
+constexpr uint32_t ordinal(Event event) { return static_cast<uint32_t>(event); }
+
+/**
+ * @brief TRANSITIONS flattened to next-state indices, NO_TRANSITION elsewhere
+ */
+struct NextStateTable {
+    uint8_t next[STATE_COUNT][EVENT_COUNT];
+};
+
+constexpr NextStateTable buildTable() {
+    NextStateTable table = {};
+    for (uint32_t s = 0; s < STATE_COUNT; s++) {
+        for (uint32_t e = 0; e < EVENT_COUNT; e++) {
+            table.next[s][e] = NO_TRANSITION;
+        }
+    }
+    for (const Transition& t : TRANSITIONS) {
+        table.next[ordinal(t.from)][ordinal(t.event)] = static_cast<uint8_t>(ordinal(t.to));
+    }
+    return table;
+}
+
+constexpr bool noDuplicateTransitions() {
+    for (uint32_t i = 0; i < sizeof(TRANSITIONS) / sizeof(TRANSITIONS[0]); i++) {
+        for (uint32_t j = i + 1; j < sizeof(TRANSITIONS) / sizeof(TRANSITIONS[0]); j++) {
+            if (TRANSITIONS[i].from == TRANSITIONS[j].from && TRANSITIONS[i].event == TRANSITIONS[j].event) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+constexpr bool allStatesReachable() {
+    bool reached[STATE_COUNT] = {};
+    reached[ordinal(State::UNINITIALIZED)] = true;
+    // Relax until nothing changes; STATE_COUNT passes always suffice
+    for (uint32_t pass = 0; pass < STATE_COUNT; pass++) {
+        for (const Transition& t : TRANSITIONS) {
+            if (reached[ordinal(t.from)]) {
+                reached[ordinal(t.to)] = true;
+            }
+        }
+    }
+    for (uint32_t s = 0; s < STATE_COUNT; s++) {
+        if (!reached[s]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool noDeadEndStates() {
+    for (uint32_t s = 0; s < STATE_COUNT; s++) {
+        bool leaves = false;
+        for (const Transition& t : TRANSITIONS) {
+            leaves = leaves || (ordinal(t.from) == s && t.to != t.from);
+        }
+        if (!leaves) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(noDuplicateTransitions(), "Two transitions for the same state and event");
+static_assert(allStatesReachable(), "A state cannot be reached from UNINITIALIZED");
+static_assert(noDeadEndStates(), "A state has no transition out of it");
+
+constexpr NextStateTable NEXT_STATE = buildTable();
+
+}  // namespace
 
 MotorStateMachine::MotorStateMachine()
     : current_state_(State::UNINITIALIZED)
@@ -7,112 +132,45 @@ MotorStateMachine::MotorStateMachine()
     , transition_callback_(nullptr)
     , state_entry_callback_(nullptr)
     , state_exit_callback_(nullptr)
+    , events_()
+    , dropped_events_(0)
 {
 }
 
 bool MotorStateMachine::processEvent(Event event) {
-    State next_state = current_state_;
-    
-    // State transition logic
-    switch (current_state_) {
-        case State::UNINITIALIZED:
-            if (event == Event::INITIALIZE) {
-                next_state = State::IDLE;
-            }
-            break;
-            
-        case State::IDLE:
-            if (event == Event::ENABLE) {
-                next_state = State::READY;
-            }
-            break;
-            
-        case State::READY:
-            if (event == Event::DISABLE) {
-                next_state = State::IDLE;
-            } else if (event == Event::START_MOTION) {
-                next_state = State::ACCELERATING;
-            } else if (event == Event::HOME_COMMAND) {
-                next_state = State::HOMING;
-            } else if (event == Event::ERROR_DETECTED) {
-                next_state = State::ERROR;
-            }
-            break;
-            
-        case State::ACCELERATING:
-            if (event == Event::MOTION_COMPLETE) {
-                next_state = State::RUNNING;
-            } else if (event == Event::STOP) {
-                next_state = State::DECELERATING;
-            } else if (event == Event::EMERGENCY_STOP) {
-                next_state = State::STOPPING;
-            } else if (event == Event::ERROR_DETECTED) {
-                next_state = State::ERROR;
-            }
-            break;
-            
-        case State::RUNNING:
-            if (event == Event::MOTION_COMPLETE) {
-                next_state = State::DECELERATING;
-            } else if (event == Event::STOP) {
-                next_state = State::DECELERATING;
-            } else if (event == Event::EMERGENCY_STOP) {
-                next_state = State::STOPPING;
-            } else if (event == Event::ERROR_DETECTED) {
-                next_state = State::ERROR;
-            }
-            break;
-            
-        case State::DECELERATING:
-            if (event == Event::MOTION_COMPLETE) {
-                next_state = State::READY;
-            } else if (event == Event::EMERGENCY_STOP) {
-                next_state = State::STOPPING;
-            } else if (event == Event::ERROR_DETECTED) {
-                next_state = State::ERROR;
-            }
-            break;
-            
-        case State::STOPPING:
-            if (event == Event::MOTION_COMPLETE) {
-                next_state = State::READY;
-            } else if (event == Event::ERROR_DETECTED) {
-                next_state = State::ERROR;
-            }
-            break;
-            
-        case State::HOMING:
-            if (event == Event::HOME_COMPLETE) {
-                next_state = State::READY;
-            } else if (event == Event::EMERGENCY_STOP) {
-                next_state = State::STOPPING;
-            } else if (event == Event::ERROR_DETECTED) {
-                next_state = State::ERROR;
-            }
-            break;
-            
-        case State::ERROR:
-            if (event == Event::ERROR_CLEARED) {
-                next_state = State::IDLE;
-            }
-            break;
+    // Whatever interrupts posted before this event happened before it
+    dispatch();
+    return handle(event);
+}
+
+bool MotorStateMachine::post(Event event) {
+    if (!events_.push(event)) {
+        dropped_events_.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
-    
-    // Execute transition if state changed
-    if (next_state != current_state_) {
-        if (isTransitionValid(current_state_, next_state, event)) {
-            transitionTo(next_state, event);
-            return true;
-        } else {
-            printf("WARNING: Invalid transition from %s to %s on event %s\r\n",
-                   getStateName(current_state_),
-                   getStateName(next_state),
-                   getEventName(event));
-            return false;
-        }
+    return true;
+}
+
+uint32_t MotorStateMachine::dispatch(uint32_t max_events) {
+    uint32_t processed = 0;
+    Event event;
+    while (processed < max_events && events_.pop(event)) {
+        handle(event);
+        processed++;
     }
-    
-    return false;
+    return processed;
+}
+
+bool MotorStateMachine::handle(Event event) {
+    if (ordinal(event) >= EVENT_COUNT) {
+        return false;
+    }
+    const uint8_t next = NEXT_STATE.next[ordinal(current_state_)][ordinal(event)];
+    if (next == NO_TRANSITION) {
+        return false;
+    }
+    transitionTo(static_cast<State>(next), event);
+    return true;
 }
 
 bool MotorStateMachine::canMove() const {
@@ -129,15 +187,6 @@ void MotorStateMachine::reset() {
     transitionTo(State::IDLE, Event::ERROR_CLEARED);
 }
 
-bool MotorStateMachine::isTransitionValid(State from, State to, Event event) const {
-    // All transitions defined in processEvent() are valid
-    // This function can add additional validation logic if needed
-    (void)from;
-    (void)to;
-    (void)event;
-    return true;
-}
-
 void MotorStateMachine::transitionTo(State new_state, Event event) {
     State old_state = current_state_;
     
@@ -159,11 +208,6 @@ void MotorStateMachine::transitionTo(State new_state, Event event) {
     if (state_entry_callback_) {
         state_entry_callback_(new_state);
     }
-    
-    printf("STATE: %s -> %s (event: %s)\r\n",
-           getStateName(old_state),
-           getStateName(new_state),
-           getEventName(event));
 }
 
 const char* MotorStateMachine::getStateName(State state) {
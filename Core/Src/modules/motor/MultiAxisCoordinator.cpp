@@ -0,0 +1,218 @@
+#include "motor/MultiAxisCoordinator.hpp"
+#include "hal/CycleProfiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+MultiAxisCoordinator::MultiAxisCoordinator()
+    : axes_{}
+    , axis_count_(0)
+    , state_(State::IDLE)
+    , start_slaves_(false)
+    , htim_(nullptr)
+    , dt_(0.001f)
+    , move_time_(0.0f)
+{
+}
+
+int MultiAxisCoordinator::addAxis(StepperMotor* motor) {
+    if (motor == nullptr || axis_count_ >= MAX_AXES || state_ == State::RUNNING) {
+        return -1;
+    }
+    Axis& axis = axes_[axis_count_];
+    axis.motor = motor;
+    axis.position = 0.0f;
+    axis.active = false;
+    axis.stepping = false;
+    return static_cast<int>(axis_count_++);
+}
+
+void MultiAxisCoordinator::init(TIM_HandleTypeDef* htim, float update_freq_hz) {
+    htim_ = htim;
+    dt_ = 1.0f / update_freq_hz;
+    state_ = State::IDLE;
+}
+
+void MultiAxisCoordinator::maskUpdates() {
+    if (htim_ != nullptr) {
+        __HAL_TIM_DISABLE_IT(htim_, TIM_IT_UPDATE);
+    }
+}
+
+void MultiAxisCoordinator::unmaskUpdates() {
+    if (htim_ != nullptr) {
+        __HAL_TIM_ENABLE_IT(htim_, TIM_IT_UPDATE);
+    }
+}
+
+bool MultiAxisCoordinator::moveTo(const float targets[], const Limits limits[]) {
+    if (state_ == State::RUNNING || axis_count_ == 0) {
+        return false;
+    }
+    
+    // The control-loop ISR must not see half-written profiles
+    maskUpdates();
+    
+    // Plan every axis at its own limits; the slowest sets the move time
+    float move_time = 0.0f;
+    for (uint32_t i = 0; i < axis_count_; i++) {
+        Axis& axis = axes_[i];
+        const float distance = std::fabs(targets[i] - axis.position);
+        axis.active = distance >= 0.1f;
+        if (!axis.active) {
+            continue;
+        }
+        
+        SCurveProfile::Config config;
+        config.max_velocity = limits[i].max_velocity;
+        config.max_acceleration = limits[i].max_acceleration;
+        config.max_jerk = limits[i].max_jerk;
+        config.start_velocity = 0.0f;
+        if (!axis.profile.calculate(distance, config)) {
+            state_ = State::ERROR;
+            unmaskUpdates();
+            return false;
+        }
+        move_time = std::max(move_time, axis.profile.getTotalTime());
+    }
+    
+    if (move_time <= 0.0f) {
+        // Every axis already at target
+        state_ = State::COMPLETED;
+        unmaskUpdates();
+        return true;
+    }
+    
+    for (uint32_t i = 0; i < axis_count_; i++) {
+        Axis& axis = axes_[i];
+        if (!axis.active) {
+            continue;
+        }
+        
+        // Stretch faster axes to the common duration: p(t) -> p(k t)
+        const float total_time = axis.profile.getTotalTime();
+        if (total_time < move_time) {
+            const float k = total_time / move_time;
+            SCurveProfile::Config config;
+            config.max_velocity = limits[i].max_velocity * k;
+            config.max_acceleration = limits[i].max_acceleration * k * k;
+            config.max_jerk = limits[i].max_jerk * k * k * k;
+            config.start_velocity = 0.0f;
+            if (!axis.profile.calculate(std::fabs(targets[i] - axis.position), config)) {
+                state_ = State::ERROR;
+                unmaskUpdates();
+                return false;
+            }
+        }
+    }
+    
+    for (uint32_t i = 0; i < axis_count_; i++) {
+        Axis& axis = axes_[i];
+        if (!axis.active) {
+            continue;
+        }
+        const bool forward = targets[i] >= axis.position;
+        axis.motor->setDirection(forward);
+        axis.direction = forward ? 1.0f : -1.0f;
+        axis.start_position = axis.position;
+        axis.target_position = targets[i];
+        axis.steps = static_cast<uint32_t>(std::lround(std::fabs(targets[i] - axis.position)));
+        axis.made = 0.0f;
+        axis.rate = 0.0f;
+        axis.stepping = axis.steps > 0;
+        axis.stepper.start(axis.profile, dt_);
+    }
+    
+    move_time_ = move_time;
+    start_slaves_ = !axes_[0].stepping;
+    state_ = State::RUNNING;
+    
+    unmaskUpdates();
+    return true;
+}
+
+void MultiAxisCoordinator::stop() {
+    maskUpdates();
+    for (uint32_t i = 0; i < axis_count_; i++) {
+        axes_[i].motor->stop();
+        axes_[i].active = false;
+        axes_[i].stepping = false;
+    }
+    state_ = State::IDLE;
+    unmaskUpdates();
+}
+
+void MultiAxisCoordinator::setPosition(uint32_t axis, float position) {
+    if (axis < axis_count_ && state_ != State::RUNNING) {
+        axes_[axis].position = position;
+    }
+}
+
+void MultiAxisCoordinator::update() {
+    PROFILE_SCOPE(COORDINATOR_UPDATE);
+    if (state_ != State::RUNNING) {
+        return;
+    }
+    
+    // Slaves first: they are armed by their first rate update and start
+    // counting on the master's next step edge (TRGO)
+    bool moving = false;
+    for (uint32_t i = axis_count_; i-- > 0;) {
+        Axis& axis = axes_[i];
+        if (!axis.active) {
+            continue;
+        }
+        
+        const SCurveProfile::State& profile_state = axis.stepper.step();
+        if (axis.stepping) {
+            axis.made += axis.rate * dt_;
+            if (profile_state.is_complete || axis.made >= static_cast<float>(axis.steps) - 0.5f + STEP_MARGIN) {
+                // Step N is out, and step N + 1 is not due yet. The master
+                // stops (its counter would clock TIM9); slaves keep counting
+                // on its time base, or its next step would restart them
+                if (i == 0) {
+                    axis.motor->stop();
+                } else {
+                    axis.motor->stopOutput();
+                }
+                axis.stepping = false;
+            } else {
+                // Not as far as step N + 1 by the next tick (the motor
+                // raises a rate below 1 Hz to 1 Hz, which keeps it running)
+                const float room = (static_cast<float>(axis.steps) + 0.5f - STEP_MARGIN - axis.made) / dt_;
+                axis.motor->setStepRate(std::min(std::max(profile_state.velocity, 1.0f), room));
+                axis.rate = axis.motor->getAchievedStepRate();
+            }
+        }
+        if (profile_state.is_complete) {
+            axis.position = axis.target_position;
+            axis.active = false;
+            continue;
+        }
+        
+        axis.position = axis.start_position + axis.direction * profile_state.position;
+        moving = true;
+    }
+    
+    if (start_slaves_) {
+        // Master axis makes no steps, so no trigger comes
+        start_slaves_ = false;
+        startArmedSlaves();
+    }
+    if (!moving) {
+        // The master is stopped: no trigger restarts the slaves now
+        for (uint32_t i = 1; i < axis_count_; i++) {
+            axes_[i].motor->stop();
+        }
+        state_ = State::COMPLETED;
+    }
+}
+
+void MultiAxisCoordinator::startArmedSlaves() {
+    // Running the master's counter without output would still toggle
+    // OC1REF and clock its step counter, so the slaves start in software
+    for (uint32_t i = 1; i < axis_count_; i++) {
+        if (axes_[i].stepping) {
+            __HAL_TIM_ENABLE(axes_[i].motor->getTimer());
+        }
+    }
+}
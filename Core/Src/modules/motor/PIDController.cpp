@@ -0,0 +1,88 @@
+#include "motor/PIDController.hpp"
+#include "util/RamCode.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float VELOCITY_FILTER_HZ = 50.0f;  // Cutoff of the measured velocity
+constexpr float TWO_PI = 6.28318531f;
+
+}  // namespace
+
+PIDController::PIDController()
+    : gains_{ 0.0f, 0.0f, 0.0f, 1.0f }
+    , limits_{ 1000.0f, 100.0f, 0.5f }
+    , integral_(0.0f)
+    , error_(0.0f)
+    , correction_(0.0f)
+    , measured_velocity_(0.0f)
+    , last_measured_(0.0f)
+    , primed_(false)
+    , faulted_(false)
+{
+}
+
+bool PIDController::setGains(const Gains& gains) {
+    for (const float gain : { gains.kp, gains.ki, gains.kd, gains.kf }) {
+        if (!std::isfinite(gain) || gain < 0.0f) {
+            return false;
+        }
+    }
+    gains_ = gains;
+    return true;
+}
+
+bool PIDController::setLimits(const Limits& limits) {
+    if (!(limits.max_correction > 0.0f) || !(limits.max_following_error > 0.0f) ||
+        !(limits.deadband >= 0.0f) || !std::isfinite(limits.max_correction) ||
+        !std::isfinite(limits.max_following_error)) {
+        return false;
+    }
+    limits_ = limits;
+    return true;
+}
+
+void PIDController::reset() {
+    integral_ = 0.0f;
+    error_ = 0.0f;
+    correction_ = 0.0f;
+    measured_velocity_ = 0.0f;
+    primed_ = false;
+    faulted_ = false;
+}
+
+RAM_CODE float PIDController::update(float commanded_position, float commanded_velocity,
+                                     float measured_position, float dt) {
+    if (primed_) {
+        const float raw = (measured_position - last_measured_) / dt;
+        const float alpha = dt / (dt + 1.0f / (TWO_PI * VELOCITY_FILTER_HZ));
+        measured_velocity_ += alpha * (raw - measured_velocity_);
+    }
+    last_measured_ = measured_position;
+    primed_ = true;
+
+    error_ = commanded_position - measured_position;
+    if (std::fabs(error_) > limits_.max_following_error) {
+        faulted_ = true;
+    }
+    if (faulted_) {
+        correction_ = 0.0f;
+        return 0.0f;
+    }
+    if (commanded_velocity == 0.0f && std::fabs(error_) < limits_.deadband) {
+        // Settled: nothing to make up, and no bias into the next move
+        integral_ = 0.0f;
+        correction_ = 0.0f;
+        return 0.0f;
+    }
+
+    const float integral = integral_ + error_ * dt;
+    const float unclamped = gains_.kp * error_ + gains_.ki * integral +
+                            gains_.kd * (commanded_velocity - measured_velocity_);
+    correction_ = std::clamp(unclamped, -limits_.max_correction, limits_.max_correction);
+    if (correction_ == unclamped || (unclamped > 0.0f) != (error_ > 0.0f)) {
+        integral_ = integral;
+    }
+    return gains_.kf * commanded_velocity + correction_;
+}
@@ -1,18 +1,113 @@
 #include "motor/SCurveProfile.hpp"
+#include "hal/CycleProfiler.hpp"
+#include "util/RamCode.hpp"
 #include <algorithm>
 #include <cmath>
 
-SCurveProfile::SCurveProfile() 
+namespace {
+
+constexpr int PEAK_SOLVER_ITERATIONS = 32;
+constexpr int REACH_SOLVER_ITERATIONS = 6;
+constexpr int REACH_ROUNDING_STEPS = 8;
+
+// Relative slack on the distance check, for junction velocities computed
+// from slightly different float expressions
+constexpr float DISTANCE_TOLERANCE = 1.0e-4f;
+
+/**
+ * @brief Jerk-limited velocity ramp: jerk, constant accel, jerk
+ */
+struct Ramp {
+    float jerk_time;   // Duration of each jerk phase
+    float accel_time;  // Duration of the constant acceleration phase
+};
+
+Ramp rampFor(float delta_v, float a_max, float j_max) {
+    Ramp ramp;
+    if (delta_v <= 0.0f) {
+        ramp.jerk_time = 0.0f;
+        ramp.accel_time = 0.0f;
+    } else if (delta_v * j_max >= a_max * a_max) {
+        // a_max reached: jerk to a_max, hold, jerk back to zero
+        ramp.jerk_time = a_max / j_max;
+        ramp.accel_time = delta_v / a_max - ramp.jerk_time;
+    } else {
+        // Triangular acceleration, peak a = sqrt(delta_v * j_max)
+        ramp.jerk_time = std::sqrt(delta_v / j_max);
+        ramp.accel_time = 0.0f;
+    }
+    return ramp;
+}
+
+// Acceleration is symmetric in time, so the mean velocity is the midpoint
+float rampDistance(float v_from, float v_to, float a_max, float j_max) {
+    const Ramp ramp = rampFor(std::fabs(v_to - v_from), a_max, j_max);
+    return 0.5f * (v_from + v_to) * (2.0f * ramp.jerk_time + ramp.accel_time);
+}
+
+/**
+ * @brief Ramp up to v_to from a non-zero acceleration a_from
+ *
+ * Phase 1 jerks a_from to the peak, phase 2 holds it, phase 3 jerks back
+ * to zero. Velocity gained: (2 a_p^2 - a_from^2) / (2j) + a_p * hold.
+ * Above a_max (limits lowered mid-move) phase 1 jerks down to a_max
+ * instead, gaining (a_from^2 - a_p^2) / (2j). v_to must be at least where
+ * the acceleration can first return to zero.
+ */
+struct AcceleratedRamp {
+    float durations[3];
+    float jerk;  // Phase 1: j_max, or -j_max down to a_max
+};
+
+AcceleratedRamp rampFrom(float v_from, float a_from, float v_to, float a_max, float j_max) {
+    const float delta_v = v_to - v_from;
+    const float a_triangle = std::sqrt(std::max(j_max * delta_v + 0.5f * a_from * a_from, 0.0f));
+    const float a_peak = std::min(std::max(std::min(a_triangle, a_max), std::max(a_from, 0.0f)), a_max);
+    AcceleratedRamp ramp;
+    ramp.jerk = (a_peak < a_from) ? -j_max : j_max;
+    const float jerk_gain = (a_peak * a_peak - a_from * a_from) / (2.0f * ramp.jerk) +
+                            a_peak * a_peak / (2.0f * j_max);
+    ramp.durations[0] = (a_peak - a_from) / ramp.jerk;
+    ramp.durations[1] = (a_peak > 0.0f) ? std::max((delta_v - jerk_gain) / a_peak, 0.0f) : 0.0f;
+    ramp.durations[2] = a_peak / j_max;
+    return ramp;
+}
+
+float rampFromDistance(float v_from, float a_from, float v_to, float a_max, float j_max) {
+    const AcceleratedRamp ramp = rampFrom(v_from, a_from, v_to, a_max, j_max);
+    const float jerks[3] = { ramp.jerk, 0.0f, -j_max };
+    float s = 0.0f;
+    float v = v_from;
+    float a = a_from;
+    for (int i = 0; i < 3; i++) {
+        const float t = ramp.durations[i];
+        s += v * t + a * t * t * 0.5f + jerks[i] * t * t * t / 6.0f;
+        v += a * t + jerks[i] * t * t * 0.5f;
+        a += jerks[i] * t;
+    }
+    return s;
+}
+
+}  // namespace
+
+SCurveProfile::SCurveProfile()
     : target_pos_(0.0f)
     , v_max_(0.0f)
     , a_max_(0.0f)
     , j_max_(0.0f)
     , v_start_(0.0f)
+    , a_start_(0.0f)
+    , v_end_(0.0f)
+    , v_peak_(0.0f)
     , total_time_(0.0f)
     , is_valid_(false)
 {
     for (int i = 0; i < 8; i++) {
         t_[i] = 0.0f;
+        pos_[i] = 0.0f;
+        vel_[i] = 0.0f;
+        acc_[i] = 0.0f;
+        jerk_[i] = 0.0f;
     }
 }
 
@@ -23,137 +118,304 @@ bool SCurveProfile::calculate(float target_position, const Config& config) {
     a_max_ = config.max_acceleration;
     j_max_ = config.max_jerk;
     v_start_ = config.start_velocity;
-    
+    a_start_ = config.start_acceleration;
+    v_end_ = config.end_velocity;
+    is_valid_ = false;
+
     // Validate inputs
     if (target_pos_ <= 0 || v_max_ <= 0 || a_max_ <= 0 || j_max_ <= 0) {
-        is_valid_ = false;
         return false;
     }
-    
-    // **SIMPLIFIED 3-PHASE S-CURVE**
-    // Phase 1: Acceleration (0 → v_max with jerk)
-    // Phase 2: Constant velocity (v_max)
-    // Phase 3: Deceleration (v_max → 0 with jerk)
-    
-    // Time to accelerate from 0 to v_max with jerk
-    float t_accel = v_max_ / a_max_;
-    
-    // Distance during acceleration (trapezoidal approximation)
-    float s_accel = 0.5f * v_max_ * t_accel;
-    
-    // Distance during deceleration (symmetric)
-    float s_decel = s_accel;
-    
-    // Remaining distance at constant velocity
-    float s_const = target_pos_ - s_accel - s_decel;
-    
-    // Time at constant velocity
-    float t_const = 0.0f;
-    if (s_const > 0) {
-        t_const = s_const / v_max_;
+    if (v_start_ < 0 || v_start_ > v_max_ || v_end_ < 0 || v_end_ > v_max_) {
+        return false;
+    }
+
+    // Must be able to get from the start to the end velocity within the distance
+    if (a_start_ == 0.0f) {
+        if (rampDistance(v_start_, v_end_, a_max_, j_max_) > target_pos_ * (1.0f + DISTANCE_TOLERANCE)) {
+            return false;
+        }
     } else {
-        // Can't reach v_max, reduce peak velocity
-        s_const = 0.0f;
-        t_const = 0.0f;
-        
-        // Recalculate for shorter distance
-        // v_peak^2 = 2 * a_max * (distance/2)
-        float v_peak = std::sqrt(a_max_ * target_pos_);
-        v_peak = std::min(v_peak, v_max_);
-        
-        t_accel = v_peak / a_max_;
-        s_accel = 0.5f * v_peak * t_accel;
-        s_decel = s_accel;
-    }
-    
-    float t_decel = t_accel;  // Symmetric
-    
-    // Set phase timings (simplified 3-phase)
-    t_[0] = 0.0f;
-    t_[1] = t_accel;           // End of acceleration
-    t_[2] = t_[1] + t_const;   // End of constant velocity  
-    t_[3] = t_[2] + t_decel;   // End of deceleration
-    t_[4] = t_[3];
-    t_[5] = t_[3];
-    t_[6] = t_[3];
-    t_[7] = t_[3];
-    
-    total_time_ = t_[3];
+        // Slowest peak: where the acceleration can first be back at zero
+        const float v_settle = settleVelocity();
+        const float v_low = std::max(v_settle, v_end_);
+        if (v_settle < 0.0f || v_settle > v_max_ ||
+            rampFromDistance(v_start_, a_start_, v_low, a_max_, j_max_) +
+            rampDistance(v_low, v_end_, a_max_, j_max_) > target_pos_ * (1.0f + DISTANCE_TOLERANCE)) {
+            return false;
+        }
+    }
+
+    v_peak_ = findPeakVelocity();
+    calculatePhaseTimings(v_peak_);
+
+    is_valid_ = true;
+    return true;
+}
+
+float SCurveProfile::reachableVelocity(float v_from, float distance, const Config& limits) {
+    const float v_max = limits.max_velocity;
+    const float a_max = limits.max_acceleration;
+    const float j_max = limits.max_jerk;
+    if (v_from >= v_max || distance <= 0.0f) {
+        return std::min(v_from, v_max);
+    }
+    if (rampDistance(v_from, v_max, a_max, j_max) <= distance) {
+        return v_max;
+    }
+
+    // Ramp reaches a_max: v^2/(2a) + v*a/(2j) + (v0*a/(2j) - v0^2/(2a) - d) = 0
+    const float qa = 0.5f / a_max;
+    const float qb = 0.5f * a_max / j_max;
+    const float qc = v_from * qb - v_from * v_from * qa - distance;
+    float v = (-qb + std::sqrt(qb * qb - 4.0f * qa * qc)) / (2.0f * qa);
+    if (v - v_from < a_max * a_max / j_max) {
+        // Triangular ramp of jerk time s: j*s^3 + 2*v0*s = d. Newton from an
+        // upper bound converges monotonically (convex, increasing in s)
+        float s = std::cbrt(distance / j_max);
+        if (v_from > 0.0f) {
+            s = std::min(s, distance / (2.0f * v_from));
+        }
+        for (int i = 0; i < REACH_SOLVER_ITERATIONS; i++) {
+            s -= (j_max * s * s * s + 2.0f * v_from * s - distance) / (3.0f * j_max * s * s + 2.0f * v_from);
+        }
+        v = v_from + j_max * s * s;
+    }
+    v = std::min(v, v_max);
+
+    // A small velocity change on top of a large v_from is only resolved to
+    // float precision; step down until calculate() accepts the pair
+    for (int i = 0; i < REACH_ROUNDING_STEPS && v > v_from &&
+                    rampDistance(v_from, v, a_max, j_max) > distance; i++) {
+        v = std::nextafter(v, v_from);
+    }
+    return (rampDistance(v_from, v, a_max, j_max) > distance) ? v_from : v;
+}
+
+float SCurveProfile::settleVelocity() const {
+    return v_start_ + a_start_ * std::fabs(a_start_) / (2.0f * j_max_);
+}
+
+float SCurveProfile::findPeakVelocity() const {
+    if (a_start_ != 0.0f) {
+        // Moving start: distance is monotonic in v_peak above the settle velocity
+        float v_lo = std::max(settleVelocity(), v_end_);
+        float v_hi = v_max_;
+        auto distance = [this](float v_peak) {
+            return rampFromDistance(v_start_, a_start_, v_peak, a_max_, j_max_) +
+                   rampDistance(v_peak, v_end_, a_max_, j_max_);
+        };
+        if (distance(v_hi) <= target_pos_) {
+            return v_hi;
+        }
+        for (int i = 0; i < PEAK_SOLVER_ITERATIONS; i++) {
+            const float v_mid = 0.5f * (v_lo + v_hi);
+            if (distance(v_mid) > target_pos_) {
+                v_hi = v_mid;
+            } else {
+                v_lo = v_mid;
+            }
+        }
+        return v_lo;
+    }
+
+    // v_max reachable: cruise phase absorbs the rest of the distance
+    if (rampDistance(v_start_, v_max_, a_max_, j_max_) +
+        rampDistance(v_max_, v_end_, a_max_, j_max_) <= target_pos_) {
+        return v_max_;
+    }
+
+    // Both ramps reach a_max: distance is quadratic in v_peak
+    //   v^2/a + v*a/j + ((v0+v1)*a/(2j) - (v0^2+v1^2)/(2a) - d) = 0
+    const float a_limited = a_max_ * a_max_ / j_max_;  // Smallest delta-v reaching a_max
+    const float qa = 1.0f / a_max_;
+    const float qb = a_max_ / j_max_;
+    const float qc = (v_start_ + v_end_) * qb * 0.5f -
+                     (v_start_ * v_start_ + v_end_ * v_end_) * qa * 0.5f - target_pos_;
+    const float v_peak = (-qb + std::sqrt(qb * qb - 4.0f * qa * qc)) / (2.0f * qa);
+    if (v_peak - v_start_ >= a_limited && v_peak - v_end_ >= a_limited && v_peak <= v_max_) {
+        return v_peak;
+    }
+
+    // Rest to rest without reaching a_max: 2 * v * sqrt(v/j) = d
+    if (v_start_ <= 0.0f && v_end_ <= 0.0f) {
+        const float v_tri = std::cbrt(0.25f * target_pos_ * target_pos_ * j_max_);
+        if (v_tri <= a_limited) {
+            return std::min(v_tri, v_max_);
+        }
+    }
+
+    // Mixed cases (one ramp saturated): distance is monotonic in v_peak
+    float v_lo = std::max(v_start_, v_end_);  // Peak can't be below either end
+    float v_hi = v_max_;
+    for (int i = 0; i < PEAK_SOLVER_ITERATIONS; i++) {
+        const float v_mid = 0.5f * (v_lo + v_hi);
+        const float d = rampDistance(v_start_, v_mid, a_max_, j_max_) +
+                        rampDistance(v_mid, v_end_, a_max_, j_max_);
+        if (d > target_pos_) {
+            v_hi = v_mid;
+        } else {
+            v_lo = v_mid;
+        }
+    }
+    return v_lo;
+}
+
+void SCurveProfile::calculatePhaseTimings(float v_peak) {
+    const Ramp accel = rampFor(v_peak - v_start_, a_max_, j_max_);
+    const Ramp decel = rampFor(v_peak - v_end_, a_max_, j_max_);
+    AcceleratedRamp accel_from = { { accel.jerk_time, accel.accel_time, accel.jerk_time }, j_max_ };
+    float s_accel = rampDistance(v_start_, v_peak, a_max_, j_max_);
+    if (a_start_ != 0.0f) {
+        accel_from = rampFrom(v_start_, a_start_, v_peak, a_max_, j_max_);
+        s_accel = rampFromDistance(v_start_, a_start_, v_peak, a_max_, j_max_);
+    }
+
+    const float s_decel = rampDistance(v_peak, v_end_, a_max_, j_max_);
+    const float s_cruise = std::max(target_pos_ - s_accel - s_decel, 0.0f);
+    const float t_cruise = (v_peak > 0.0f) ? s_cruise / v_peak : 0.0f;
+
+    const float durations[8] = {
+        0.0f,
+        accel_from.durations[0], accel_from.durations[1], accel_from.durations[2],
+        t_cruise,
+        decel.jerk_time, decel.accel_time, decel.jerk_time,
+    };
+    const float jerks[8] = { 0.0f, accel_from.jerk, 0.0f, -j_max_, 0.0f, -j_max_, 0.0f, j_max_ };
+
+    integratePhases(durations, jerks, a_start_);
+
+    // Jerk phases return acceleration to exactly zero
+    acc_[3] = 0.0f;
+    acc_[7] = 0.0f;
+    vel_[7] = v_end_;
+
+    total_time_ = t_[7];
+}
+
+bool SCurveProfile::calculateStop(float velocity, float acceleration, const Config& limits) {
+    v_max_ = limits.max_velocity;
+    a_max_ = limits.max_acceleration;
+    j_max_ = limits.max_jerk;
+    v_start_ = velocity;
+    a_start_ = acceleration;
+    v_end_ = 0.0f;
+    v_peak_ = velocity;
+    is_valid_ = false;
+
+    if (a_max_ <= 0 || j_max_ <= 0 || velocity < 0 || (velocity <= 0 && acceleration <= 0)) {
+        return false;
+    }
+
+    const float a0 = acceleration;
+    const float j = j_max_;
+    float jerk_down;   // Phase 5: a0 -> -a_peak
+    float hold;        // Phase 6: -a_peak
+    float jerk_up;     // Phase 7: -a_peak -> 0
+    float phase5_jerk = -j;
+    if (a0 < 0.0f && j * velocity < 0.5f * a0 * a0) {
+        // Decelerating too hard to unwind before rest: ease off until v = 0
+        jerk_down = 0.0f;
+        hold = 0.0f;
+        jerk_up = (-a0 - std::sqrt(a0 * a0 - 2.0f * j * velocity)) / j;
+    } else if (a0 < -a_max_) {
+        // Decelerating harder than the limits allow (lowered mid-move): ease
+        // off to a_max, hold it and unwind, v0 - a0^2/(2j) = a_max * hold
+        phase5_jerk = j;
+        jerk_down = (-a_max_ - a0) / j;
+        hold = (velocity - a0 * a0 / (2.0f * j)) / a_max_;
+        jerk_up = a_max_ / j;
+    } else {
+        // Without a hold, v0 + (a0^2 - a^2)/(2j) = a^2/(2j) at the peak
+        const float a_peak = std::min(std::sqrt(j * velocity + 0.5f * a0 * a0), a_max_);
+        jerk_down = (a0 + a_peak) / j;
+        const float v_held = velocity + (a0 * a0 - a_peak * a_peak) / (2.0f * j);
+        hold = std::max((v_held - a_peak * a_peak / (2.0f * j)) / a_peak, 0.0f);
+        jerk_up = a_peak / j;
+    }
+
+    const float durations[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, jerk_down, hold, jerk_up };
+    const float jerks[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, phase5_jerk, 0.0f, j };
+    integratePhases(durations, jerks, a0);
+
+    // At rest; a cut-short phase 7 ends with some deceleration left
+    vel_[7] = 0.0f;
+    acc_[7] = 0.0f;
+    target_pos_ = pos_[7];
+    total_time_ = t_[7];
+    if (target_pos_ <= 0.0f || total_time_ <= 0.0f) {
+        return false;
+    }
+
     is_valid_ = true;
-    
     return true;
 }
 
-SCurveProfile::State SCurveProfile::getStateAtTime(float time_sec) const {
+void SCurveProfile::integratePhases(const float durations[8], const float jerks[8], float a_start) {
+    t_[0] = 0.0f;
+    pos_[0] = 0.0f;
+    vel_[0] = v_start_;
+    acc_[0] = a_start;
+    jerk_[0] = 0.0f;
+
+    for (uint32_t phase = 1; phase <= 7; phase++) {
+        const float dt = durations[phase];
+        jerk_[phase] = jerks[phase];
+        t_[phase] = t_[phase - 1] + dt;
+        pos_[phase] = pos_[phase - 1] + vel_[phase - 1] * dt +
+                      acc_[phase - 1] * dt * dt * 0.5f + jerks[phase] * dt * dt * dt / 6.0f;
+        vel_[phase] = vel_[phase - 1] + acc_[phase - 1] * dt + jerks[phase] * dt * dt * 0.5f;
+        acc_[phase] = acc_[phase - 1] + jerks[phase] * dt;
+    }
+}
+
+RAM_CODE SCurveProfile::State SCurveProfile::getStateAtTime(float time_sec) const {
+    PROFILE_SCOPE(PROFILE_EVALUATE);
     State state;
     state.position = 0.0f;
     state.velocity = 0.0f;
     state.acceleration = 0.0f;
     state.phase = 0;
     state.is_complete = false;
-    
+
     if (!is_valid_) {
         return state;
     }
-    
-    float t = time_sec;
-    
+
     // Clamp time to valid range
-    if (t < 0.0f) t = 0.0f;
-    if (t > total_time_) {
-        t = total_time_;
+    if (time_sec >= total_time_) {
+        state.position = target_pos_;
+        state.velocity = v_end_;
+        state.phase = 7;
         state.is_complete = true;
+        return state;
+    }
+    float t = std::max(time_sec, 0.0f);
+
+    // Find the phase containing t (zero-length phases are skipped)
+    uint32_t phase = 1;
+    while (phase < 7 && t > t_[phase]) {
+        phase++;
     }
-    
-    // **3-PHASE CALCULATION**
-    
-    if (t <= t_[1]) {
-        // Phase 1: ACCELERATION (0 → v_max)
-        state.phase = 1;
-        float t_accel = t_[1];
-        float progress = t / t_accel;  // 0.0 to 1.0
-        
-        state.velocity = v_max_ * progress;  // Linear ramp
-        state.acceleration = a_max_;
-        state.position = 0.5f * v_max_ * t * progress;  // Trapezoidal area
-        
-    } else if (t <= t_[2]) {
-        // Phase 2: CONSTANT VELOCITY
-        state.phase = 4;
-        float t_const = t - t_[1];
-        float s_accel = 0.5f * v_max_ * t_[1];
-        
-        state.velocity = v_max_;
-        state.acceleration = 0.0f;
-        state.position = s_accel + v_max_ * t_const;
-        
-    } else {
-        // Phase 3: DECELERATION (v_max → 0)
-        state.phase = 7;
-        float t_decel_phase = t - t_[2];
-        float t_decel_total = t_[3] - t_[2];
-        float progress = t_decel_phase / t_decel_total;  // 0.0 to 1.0
-        
-        float s_accel = 0.5f * v_max_ * t_[1];
-        float s_const = v_max_ * (t_[2] - t_[1]);
-        
-        state.velocity = v_max_ * (1.0f - progress);  // Linear ramp down
-        state.acceleration = -a_max_;
-        state.position = s_accel + s_const + v_max_ * t_decel_phase * (1.0f - 0.5f * progress);
-    }
-    
-    // Clamp velocity to never be negative
-    if (state.velocity < 0.0f) state.velocity = 0.0f;
-    
-    return state;
-}
 
-SCurveProfile::State SCurveProfile::calculateStateInPhase(float t, uint32_t phase) const {
-    // Not used in simplified version
-    return getStateAtTime(t);
+    return calculateStateInPhase(t, phase);
 }
 
-float SCurveProfile::positionAtPhaseEnd(uint32_t phase) const {
-    if (phase == 0 || phase > 7) return 0.0f;
-    return getStateAtTime(t_[phase]).position;
+RAM_CODE SCurveProfile::State SCurveProfile::calculateStateInPhase(float t, uint32_t phase) const {
+    const float dt = t - t_[phase - 1];
+    const float j = jerk_[phase];
+    const float a0 = acc_[phase - 1];
+    const float v0 = vel_[phase - 1];
+
+    State state;
+    state.position = pos_[phase - 1] + v0 * dt + a0 * dt * dt * 0.5f + j * dt * dt * dt / 6.0f;
+    state.velocity = v0 + a0 * dt + j * dt * dt * 0.5f;
+    state.acceleration = a0 + j * dt;
+    state.phase = phase;
+    state.is_complete = false;
+
+    // Rounding near the end of phase 7 must not reverse the motion
+    if (state.velocity < 0.0f) state.velocity = 0.0f;
+
+    return state;
 }
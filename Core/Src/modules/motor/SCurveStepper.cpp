@@ -0,0 +1,121 @@
+#include "motor/SCurveStepper.hpp"
+#include "hal/CycleProfiler.hpp"
+#include "util/RamCode.hpp"
+#include <algorithm>
+#include <cmath>
+
+SCurveStepper::SCurveStepper()
+    : segments_{}
+    , segment_count_(0)
+    , segment_index_(0)
+    , tick_(0)
+    , complete_tick_(0)
+    , dt_(0.0f)
+    , start_time_(0.0f)
+    , total_time_(0.0f)
+    , final_position_(0.0f)
+    , final_velocity_(0.0f)
+    , state_{}
+{
+}
+
+bool SCurveStepper::start(const SCurveProfile& profile, float dt, float start_time) {
+    segment_count_ = 0;
+    segment_index_ = 0;
+    tick_ = 0;
+    complete_tick_ = 0;
+    dt_ = dt;
+    start_time_ = start_time;
+    total_time_ = 0.0f;
+    state_ = SCurveProfile::State{};
+    
+    if (!profile.isValid() || dt <= 0.0f) {
+        return false;
+    }
+    
+    // getStateAtTime() reports completion once t0 + n * dt >= total time
+    const float total_time = profile.getTotalTime();
+    const float t0 = start_time;
+    total_time_ = total_time;
+    complete_tick_ = static_cast<uint32_t>(std::max(std::ceil((total_time - t0) / dt), 0.0f));
+    while (complete_tick_ > 0 && t0 + static_cast<float>(complete_tick_ - 1) * dt >= total_time) {
+        complete_tick_--;
+    }
+    while (t0 + static_cast<float>(complete_tick_) * dt < total_time) {
+        complete_tick_++;
+    }
+    
+    const SCurveProfile::State final_state = profile.getStateAtTime(total_time);
+    final_position_ = final_state.position;
+    final_velocity_ = final_state.velocity;
+    state_ = profile.getStateAtTime(t0);
+    
+    uint32_t first_tick = 1;
+    for (uint32_t phase = 1; phase <= 7 && first_tick < complete_tick_; phase++) {
+        // Ticks n with t[phase-1] < t0 + n * dt <= t[phase]
+        const float phase_end = profile.getPhaseEndTime(phase) - t0;
+        uint32_t last_tick = (phase_end > 0.0f) ? static_cast<uint32_t>(std::floor(phase_end / dt)) : 0;
+        if (phase == 7 || last_tick >= complete_tick_) {
+            last_tick = complete_tick_ - 1;
+        }
+        if (last_tick < first_tick) {
+            continue;  // Phase shorter than one tick
+        }
+        
+        // Taylor expansion about the first tick, in units of ticks
+        const SCurveProfile::State anchor = profile.getStateAtTime(t0 + static_cast<float>(first_tick) * dt);
+        const float jerk = profile.getPhaseJerk(phase);
+        const float dt2 = dt * dt;
+        
+        Segment& segment = segments_[segment_count_++];
+        segment.first_tick = first_tick;
+        segment.last_tick = last_tick;
+        segment.phase = phase;
+        segment.p0 = anchor.position;
+        segment.p1 = anchor.velocity * dt;
+        segment.p2 = anchor.acceleration * dt2 * 0.5f;
+        segment.p3 = jerk * dt2 * dt / 6.0f;
+        segment.v0 = anchor.velocity;
+        segment.v1 = anchor.acceleration * dt;
+        segment.v2 = jerk * dt2 * 0.5f;
+        segment.a0 = anchor.acceleration;
+        segment.a1 = jerk * dt;
+        
+        first_tick = last_tick + 1;
+    }
+    
+    return true;
+}
+
+RAM_CODE const SCurveProfile::State& SCurveStepper::step() {
+    PROFILE_SCOPE(PROFILE_STEP);
+    if (tick_ >= complete_tick_) {
+        return state_;
+    }
+    
+    tick_++;
+    if (tick_ >= complete_tick_) {
+        state_.position = final_position_;
+        state_.velocity = final_velocity_;
+        state_.acceleration = 0.0f;
+        state_.phase = 7;
+        state_.is_complete = true;
+        return state_;
+    }
+    
+    while (tick_ > segments_[segment_index_].last_tick) {
+        segment_index_++;
+    }
+    const Segment& s = segments_[segment_index_];
+    const float n = static_cast<float>(tick_ - s.first_tick);
+    
+    state_.position = s.p0 + n * (s.p1 + n * (s.p2 + n * s.p3));
+    state_.velocity = s.v0 + n * (s.v1 + n * s.v2);
+    state_.acceleration = s.a0 + n * s.a1;
+    state_.phase = s.phase;
+    
+    // Rounding near the end of phase 7 must not reverse the motion
+    if (state_.velocity < 0.0f) state_.velocity = 0.0f;
+    
+    return state_;
+}
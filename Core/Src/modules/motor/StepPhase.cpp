@@ -0,0 +1,106 @@
+#include "motor/StepPhase.hpp"
+#include "util/RamCode.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float LARGEST_PERIOD = 4294967040.0f;  // Largest float below 2^32
+
+// Timer clocks CNT may run between its read and write-back in the reload
+constexpr float WRITE_BACK_CLOCKS = 1024.0f;
+
+}  // namespace
+
+StepPhase::StepPhase()
+    : live_{}
+    , written_{}
+    , step_(0.0f)
+    , reload_count_(0)
+    , step_phase_(0.0f)
+    , next_phase_(0.0f)
+    , interval_(0.0f)
+{
+}
+
+void StepPhase::start(uint32_t prescaler, uint32_t period, uint32_t compare) {
+    live_ = { prescaler, period, compare };
+    written_ = live_;
+    step_ = static_cast<float>(period) * static_cast<float>(prescaler + 1U);
+    reload_count_ = 0;
+    // Half a step in hand: the reloads stretch the live period to 1.5 steps
+    step_phase_ = -0.5f;
+    next_phase_ = -0.5f;
+    interval_ = 0.0f;
+}
+
+RAM_CODE uint32_t StepPhase::reload(uint32_t& count, bool overflowed, uint32_t prescaler, uint32_t period,
+                                    uint32_t pulse, uint32_t max_period, bool& step_now) {
+    const float old_step = step_;
+    const float new_step = static_cast<float>(period) * static_cast<float>(prescaler + 1U);
+
+    // Fraction of a step made since the last one, at the rate commanded until
+    // now, and the timer clocks since the last reload
+    float elapsed = static_cast<float>(count - reload_count_) * static_cast<float>(live_.prescaler + 1U);
+    if (overflowed || count < reload_count_) {
+        // A step started since the last reload, with the values written then
+        // (unless that overflow fell inside the UDIS window)
+        const uint32_t before = (live_.period > reload_count_) ? live_.period - reload_count_ : 0U;
+        elapsed = static_cast<float>(before) * static_cast<float>(live_.prescaler + 1U);
+        if (overflowed) {
+            live_ = written_;
+        }
+        const float since = static_cast<float>(count) * static_cast<float>(live_.prescaler + 1U);
+        // Several steps may have started: the reloads keep their pace
+        elapsed = std::max(elapsed + since, interval_);
+        step_phase_ = next_phase_ + since / old_step;
+    } else {
+        step_phase_ += elapsed / old_step;
+        interval_ = elapsed;
+    }
+
+    // A step that is due starts at once when its pulse is over. Otherwise the
+    // counter moves so the live period ends as the step falls due at the new
+    // rate, within the low part of the period (below the compare it would
+    // make a pulse) and clear of the overflow, since CNT keeps counting until
+    // the change is added to it
+    const float clock = static_cast<float>(live_.prescaler + 1U);
+    step_now = step_phase_ >= 1.0f && count >= live_.compare;
+    if (step_now) {
+        step_phase_ -= 1.0f;
+        next_phase_ = step_phase_;
+    } else {
+        uint32_t remaining = (live_.period > count) ? live_.period - count : 0U;
+        const float guard = std::ceil(WRITE_BACK_CLOCKS / clock);
+        if (count >= live_.compare && static_cast<float>(remaining) > guard) {
+            const float due = (1.0f - step_phase_) * new_step / clock;
+            const float lowest = static_cast<float>(live_.compare);
+            const float highest = static_cast<float>(live_.period) - guard;
+            count = static_cast<uint32_t>(std::clamp(static_cast<float>(live_.period) - due, lowest, highest) + 0.5f);
+            remaining = live_.period - count;
+        }
+        next_phase_ = step_phase_ - 1.0f + static_cast<float>(remaining) * clock / new_step;
+    }
+
+    // Steps behind (> 0) or ahead (< 0) when the next period starts. Below
+    // one step per reload that period makes it up; faster, the periods just
+    // follow the rate and the counter moves at the next reload
+    float next = static_cast<float>(period);
+    if (new_step >= elapsed) {
+        const float longest = std::min(static_cast<float>(max_period), LARGEST_PERIOD);
+        next = std::clamp(next * (1.0f - next_phase_), static_cast<float>(pulse + 1U), longest);
+        if (step_now) {
+            next_phase_ = 0.0f;
+        }
+    }
+    const uint32_t next_period = static_cast<uint32_t>(next);
+
+    written_ = { prescaler, next_period, pulse };
+    step_ = new_step;
+    reload_count_ = count;
+    if (step_now) {
+        live_ = written_;
+        reload_count_ = 0;
+    }
+    return next_period;
+}
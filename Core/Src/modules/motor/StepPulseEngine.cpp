@@ -0,0 +1,171 @@
+#include "motor/StepPulseEngine.hpp"
+#include "hal/TimerClock.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Timer words of one burst must be contiguous for the DMA
+constexpr uint32_t BURST_WORDS = 3;
+
+constexpr float IDLE_PERIOD_SEC = 100e-6f;      // Idle entries after the last step
+constexpr float START_PERIOD_SEC = 1e-6f;       // Before the first DMA burst lands
+constexpr float MIN_STEP_PERIOD_SEC = 4e-6f;    // 250 kHz ceiling, keeps pulses >= 2 us
+
+}  // namespace
+
+StepPulseEngine::StepPulseEngine(const Config& config)
+    : config_(config)
+    , scheduler_()
+    , buffer_{}
+    , half_steps_{0, 0}
+    , total_steps_(0)
+    , steps_queued_(0)
+    , tick_hz_(0.0f)
+    , step_time_(0.0f)
+    , last_period_(0.0f)
+    , tick_remainder_(0.0f)
+    , lead_in_done_(false)
+    , is_running_(false)
+{
+    static_assert(sizeof(BurstEntry) == BURST_WORDS * sizeof(uint32_t), "DMA burst entry must be packed");
+}
+
+bool StepPulseEngine::start(const SCurveProfile& profile, uint32_t steps) {
+    if (config_.step_channel != TIM_CHANNEL_1 || steps == 0 || !profile.isValid()) {
+        return false;
+    }
+
+    stop();
+
+    scheduler_.start(profile, steps);
+    total_steps_ = steps;
+    steps_queued_ = 0;
+    step_time_ = 0.0f;
+    last_period_ = profile.getTotalTime() / static_cast<float>(steps);
+    tick_remainder_ = 0.0f;
+    lead_in_done_ = false;
+
+    // Full timer clock resolution (32-bit ARR covers periods up to ~51 s)
+    tick_hz_ = static_cast<float>(TimerClock::getClock(config_.step_timer->Instance));
+
+    fillHalf(0);
+    fillHalf(1);
+
+    TIM_TypeDef* tim = config_.step_timer->Instance;
+
+    // DMA writes land in the preload registers and take effect at the
+    // following update event, one period ahead of the pulse they describe
+    tim->CR1 |= TIM_CR1_ARPE;
+    __HAL_TIM_ENABLE_OCxPRELOAD(config_.step_timer, config_.step_channel);
+
+    // Short idle period until the first burst is loaded
+    tim->PSC = 0;
+    tim->ARR = static_cast<uint32_t>(START_PERIOD_SEC * tick_hz_) - 1;
+    __HAL_TIM_SET_COMPARE(config_.step_timer, config_.step_channel, 0);
+    __HAL_TIM_SET_COUNTER(config_.step_timer, 0);
+    tim->EGR = TIM_EGR_UG;
+    __HAL_TIM_CLEAR_FLAG(config_.step_timer, TIM_FLAG_UPDATE);
+
+    is_running_ = true;
+    if (HAL_TIM_DMABurst_MultiWriteStart(config_.step_timer, TIM_DMABASE_ARR, TIM_DMA_UPDATE,
+                                         reinterpret_cast<const uint32_t*>(buffer_),
+                                         TIM_DMABURSTLENGTH_3TRANSFERS,
+                                         BUFFER_STEPS * BURST_WORDS) != HAL_OK) {
+        is_running_ = false;
+        return false;
+    }
+
+    HAL_TIM_PWM_Start(config_.step_timer, config_.step_channel);
+    return true;
+}
+
+void StepPulseEngine::stop() {
+    if (!is_running_) {
+        return;
+    }
+    is_running_ = false;
+    HAL_TIM_PWM_Stop(config_.step_timer, config_.step_channel);
+    HAL_TIM_DMABurst_WriteStop(config_.step_timer, TIM_DMA_UPDATE);
+}
+
+void StepPulseEngine::onHalfTransfer() {
+    if (!is_running_) {
+        return;
+    }
+    // First half consumed (its last entry is now in the preload registers)
+    if (steps_queued_ >= total_steps_ && half_steps_[0] == 0) {
+        stop();
+        return;
+    }
+    fillHalf(0);
+}
+
+void StepPulseEngine::onTransferComplete() {
+    if (!is_running_) {
+        return;
+    }
+    if (steps_queued_ >= total_steps_ && half_steps_[1] == 0) {
+        stop();
+        return;
+    }
+    fillHalf(1);
+}
+
+void StepPulseEngine::fillHalf(uint32_t half) {
+    BurstEntry* entry = &buffer_[half * HALF_BUFFER_STEPS];
+    uint32_t steps = 0;
+
+    for (uint32_t i = 0; i < HALF_BUFFER_STEPS; i++) {
+        if (nextEntry(entry[i])) {
+            steps++;
+        }
+    }
+    half_steps_[half] = steps;
+}
+
+bool StepPulseEngine::nextEntry(BurstEntry& entry) {
+    entry.rcr = 0;
+
+    if (!lead_in_done_) {
+        // Idle until the first step edge
+        scheduler_.next(step_time_);
+        entry.arr = std::max(toTicks(step_time_), static_cast<uint32_t>(2)) - 1;
+        entry.ccr = 0;
+        lead_in_done_ = true;
+        return false;
+    }
+
+    if (steps_queued_ < total_steps_) {
+        // Step edge at step_time_, entry lasts until the next step edge
+        const uint32_t step = steps_queued_ + 1;
+        float period = last_period_;
+        float next_time = step_time_;
+        if (step < total_steps_ && scheduler_.next(next_time)) {
+            period = next_time - step_time_;
+            step_time_ = next_time;
+        }
+        last_period_ = period;
+
+        const uint32_t ticks = toTicks(period);
+        entry.arr = ticks - 1;
+        entry.ccr = ticks / 2;
+        steps_queued_++;
+        return true;
+    }
+
+    entry.arr = static_cast<uint32_t>(IDLE_PERIOD_SEC * tick_hz_) - 1;
+    entry.ccr = 0;
+    return false;
+}
+
+uint32_t StepPulseEngine::toTicks(float seconds) {
+    const float exact = seconds * tick_hz_ + tick_remainder_;
+    const float min_ticks = MIN_STEP_PERIOD_SEC * tick_hz_;
+    const float max_ticks = 4294967040.0f;  // Largest float below 2^32
+    const float ticks = std::floor(std::clamp(exact, min_ticks, max_ticks));
+
+    // Carry the fraction so quantisation never accumulates into drift
+    tick_remainder_ = exact - ticks;
+    return static_cast<uint32_t>(ticks);
+}
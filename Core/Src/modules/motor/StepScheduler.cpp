@@ -0,0 +1,117 @@
+#include "motor/StepScheduler.hpp"
+#include "util/RamCode.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float POSITION_TOLERANCE = 1e-3f;     // Steps
+constexpr float MIN_SEED_VELOCITY = 1e-3f;      // Steps/s, below it the series is useless
+constexpr int MAX_NEWTON_ITERATIONS = 8;
+
+}  // namespace
+
+StepScheduler::StepScheduler()
+    : profile_(nullptr)
+    , steps_(0)
+    , step_(0)
+    , phase_(0)
+    , phase_start_(0.0f)
+    , phase_length_(0.0f)
+    , phase_end_position_(0.0f)
+    , p0_(0.0f)
+    , v0_(0.0f)
+    , a0_(0.0f)
+    , jerk_(0.0f)
+    , tau_(0.0f)
+{
+}
+
+bool StepScheduler::start(const SCurveProfile& profile, uint32_t steps) {
+    profile_ = nullptr;
+    steps_ = 0;
+    step_ = 0;
+    if (!profile.isValid() || steps == 0) {
+        return false;
+    }
+    profile_ = &profile;
+    steps_ = steps;
+    enterPhase(1);
+    return true;
+}
+
+void StepScheduler::enterPhase(uint32_t phase) {
+    phase_ = phase;
+    tau_ = 0.0f;
+    if (phase > 7) {
+        return;
+    }
+    phase_start_ = profile_->getPhaseEndTime(phase - 1);
+    phase_length_ = profile_->getPhaseEndTime(phase) - phase_start_;
+
+    // Position, velocity and acceleration are continuous across phases
+    const SCurveProfile::State anchor = profile_->getStateAtTime(phase_start_);
+    p0_ = anchor.position;
+    v0_ = anchor.velocity;
+    a0_ = anchor.acceleration;
+    jerk_ = profile_->getPhaseJerk(phase);
+    phase_end_position_ = positionAt(phase_length_);
+}
+
+RAM_CODE float StepScheduler::positionAt(float tau) const {
+    return p0_ + tau * (v0_ + tau * (0.5f * a0_ + tau * (jerk_ / 6.0f)));
+}
+
+RAM_CODE bool StepScheduler::next(float& time) {
+    if (profile_ == nullptr || step_ >= steps_) {
+        return false;
+    }
+    const float target = static_cast<float>(step_ + 1);
+
+    // Phases (including empty ones) that end before the step
+    while (phase_ <= 7 && (phase_length_ <= 0.0f || target > phase_end_position_ + POSITION_TOLERANCE)) {
+        enterPhase(phase_ + 1);
+    }
+    step_++;
+    if (phase_ > 7) {
+        time = profile_->getTotalTime();  // Rounded-up last step
+        return true;
+    }
+
+    // Local state at the previous step, and the Taylor inverse to the next
+    float lo = tau_;
+    float hi = phase_length_;
+    const float velocity = v0_ + tau_ * (a0_ + 0.5f * jerk_ * tau_);
+    const float acceleration = a0_ + jerk_ * tau_;
+    const float distance = target - positionAt(tau_);
+    float tau;
+    if (velocity > MIN_SEED_VELOCITY) {
+        const float delta = distance / velocity;
+        tau = tau_ + delta - 0.5f * acceleration * delta * delta / velocity;
+    } else if (acceleration > 0.0f) {
+        tau = tau_ + std::sqrt(2.0f * distance / acceleration);
+    } else {
+        tau = tau_ + std::cbrt(6.0f * distance / std::max(jerk_, 1.0f));
+    }
+
+    for (int i = 0; i < MAX_NEWTON_ITERATIONS; i++) {
+        if (!(tau > lo && tau < hi)) {
+            tau = 0.5f * (lo + hi);  // Seed or Newton left the bracket: bisect
+        }
+        const float error = positionAt(tau) - target;
+        if (std::fabs(error) < POSITION_TOLERANCE) {
+            break;
+        }
+        if (error > 0.0f) {
+            hi = tau;
+        } else {
+            lo = tau;
+        }
+        const float v = v0_ + tau * (a0_ + 0.5f * jerk_ * tau);
+        tau = (v > 0.0f) ? tau - error / v : lo;
+    }
+
+    tau_ = std::clamp(tau, tau_, phase_length_);
+    time = phase_start_ + tau_;
+    return true;
+}
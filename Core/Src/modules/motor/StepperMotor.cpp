@@ -1,4 +1,7 @@
 #include "motor/StepperMotor.hpp"
+#include "hal/CycleProfiler.hpp"
+#include "hal/TimerClock.hpp"
+#include "util/RamCode.hpp"
 #include <algorithm>
 
 StepperMotor::StepperMotor(const Config& config)
@@ -6,7 +9,23 @@ StepperMotor::StepperMotor(const Config& config)
     , current_step_rate_(0.0f)
     , is_enabled_(false)
     , is_forward_(true)
+    , is_running_(false)
+    , step_count_(0)
+    , count_last_(0)
+    , timing_{}
+    , phase_()
 {
+    if (config_.count_timer != nullptr) {
+        HAL_TIM_Base_Start(config_.count_timer);
+        count_last_ = static_cast<uint16_t>(config_.count_timer->Instance->CNT);
+    }
+    
+    if (config_.update_mode == UpdateMode::CONTINUOUS) {
+        // Buffer ARR and CCR so rate changes only land on an update event
+        config_.step_timer->Instance->CR1 |= TIM_CR1_ARPE;
+        __HAL_TIM_ENABLE_OCxPRELOAD(config_.step_timer, config_.step_channel);
+    }
+    
     // Initialize motor in disabled state
     setEnabled(false);
     setDirection(true);
@@ -34,13 +53,20 @@ void StepperMotor::setEnabled(bool enabled) {
 }
 
 void StepperMotor::setDirection(bool forward) {
+    // Steps counted so far were made in the old direction
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (config_.count_timer != nullptr) {
+        accumulateSteps();
+    }
     is_forward_ = forward;
+    __set_PRIMASK(primask);
     
     GPIO_PinState state = forward ? GPIO_PIN_SET : GPIO_PIN_RESET;
     HAL_GPIO_WritePin(config_.dir_port, config_.dir_pin, state);
 }
 
-void StepperMotor::setStepRate(float steps_per_sec) {
+RAM_CODE void StepperMotor::setStepRate(float steps_per_sec) {
     if (steps_per_sec <= 0.0f) {
         stop();
         return;
@@ -52,43 +78,134 @@ void StepperMotor::setStepRate(float steps_per_sec) {
 
 void StepperMotor::stop() {
     current_step_rate_ = 0.0f;
+    is_running_ = false;
+    timing_.frequency = 0.0f;
+    timing_.error = 0.0f;
     HAL_TIM_PWM_Stop(config_.step_timer, config_.step_channel);
 }
 
-void StepperMotor::updatePWMFrequency(float frequency_hz) {
+void StepperMotor::stopOutput() {
+    current_step_rate_ = 0.0f;
+    is_running_ = false;
+    timing_.frequency = 0.0f;
+    timing_.error = 0.0f;
+    config_.step_timer->Instance->CCER &= ~(TIM_CCER_CC1E << config_.step_channel);
+}
+
+RAM_CODE void StepperMotor::updatePWMFrequency(float frequency_hz) {
+    PROFILE_SCOPE(PWM_UPDATE);
     if (frequency_hz <= 0.0f) {
         stop();
         return;
     }
     
-    // Calculate timer settings for desired PWM frequency
-    uint32_t timer_clock = getTimerClock();
-    uint32_t target_freq = static_cast<uint32_t>(frequency_hz);
+    // Sub-1 Hz rates run at the slowest rate instead
+    const float target_freq = std::max(frequency_hz, 1.0f);
     
-    const uint32_t prescaler = 99;  // 84 MHz / 100 = 840 kHz base freq
-    uint32_t period = (timer_clock / (prescaler + 1)) / target_freq;
+    // Shortest period 2 ticks, so the pulse is never empty
+    const uint32_t timer_clock = getTimerClock();
+    TimerClock::Setting timing;
+    TimerClock::solve(timer_clock, target_freq,
+                      TimerClock::getMaxPeriod(config_.step_timer->Instance), 2, timing);
     
-    // Clamp period to valid range
-    period = std::max(static_cast<uint32_t>(2), std::min(period, static_cast<uint32_t>(65535)));
+    const float tick_hz = static_cast<float>(timer_clock) / static_cast<float>(timing.prescaler + 1U);
+    const uint32_t max_pulse = std::max(static_cast<uint32_t>(MAX_PULSE_WIDTH * tick_hz), static_cast<uint32_t>(1));
+    const uint32_t pulse = std::min(timing.period / 2, max_pulse);
     
-    // ALWAYS stop, reconfigure, and restart
-    // On-the-fly updates with UG event seem unreliable
+    if (config_.update_mode == UpdateMode::CONTINUOUS && is_running_) {
+        reloadPWM(timing.prescaler, timing.period, pulse);
+    } else {
+        restartPWM(timing.prescaler, timing.period, pulse);
+    }
+    timing_ = timing;
+}
+
+void StepperMotor::restartPWM(uint32_t prescaler, uint32_t period, uint32_t pulse) {
     HAL_TIM_PWM_Stop(config_.step_timer, config_.step_channel);
     
+    // Park OC1REF low (compare 0 at count 0): a stop mid-pulse leaves it
+    // high, and the restart must be a rising edge for the step counter and
+    // the trigger-mode slaves on TRGO
+    __HAL_TIM_SET_COMPARE(config_.step_timer, config_.step_channel, 0);
+    HAL_TIM_GenerateEvent(config_.step_timer, TIM_EVENTSOURCE_UPDATE);
+    
     config_.step_timer->Instance->PSC = prescaler;
     config_.step_timer->Instance->ARR = period - 1;
-    config_.step_timer->Instance->CCR1 = period / 2;
+    __HAL_TIM_SET_COMPARE(config_.step_timer, config_.step_channel, pulse);
     
     // Generate update event to load prescaler
     config_.step_timer->Instance->EGR = TIM_EGR_UG;
     __HAL_TIM_CLEAR_FLAG(config_.step_timer, TIM_FLAG_UPDATE);
+    phase_.start(prescaler, period, pulse);
     
     // Start PWM
     HAL_TIM_PWM_Start(config_.step_timer, config_.step_channel);
+    is_running_ = true;
+}
+
+RAM_CODE void StepperMotor::reloadPWM(uint32_t prescaler, uint32_t period, uint32_t pulse) {
+    TIM_TypeDef* tim = config_.step_timer->Instance;
+    
+    // PSC, ARR and CCR are buffered: the pulse in progress completes and the
+    // new period starts at the next overflow. UDIS holds off that overflow's
+    // shadow load until all are written, so no period mixes old and new
+    // values (e.g. an old CCR above the new ARR would swallow a pulse).
+    tim->CR1 |= TIM_CR1_UDIS;
+    uint32_t count = tim->CNT;
+    const uint32_t read = count;
+    const bool overflowed = __HAL_TIM_GET_FLAG(config_.step_timer, TIM_FLAG_UPDATE) != 0;
+    if (overflowed) {
+        __HAL_TIM_CLEAR_FLAG(config_.step_timer, TIM_FLAG_UPDATE);
+    }
+    bool step_now = false;
+    const uint32_t next_period =
+        phase_.reload(count, overflowed, prescaler, period, pulse, TimerClock::getMaxPeriod(tim), step_now);
+    if (count != read) {
+        tim->CNT += count - read;
+    }
+    
+    tim->PSC = prescaler;
+    tim->ARR = next_period - 1;
+    __HAL_TIM_SET_COMPARE(config_.step_timer, config_.step_channel, pulse);
+    tim->CR1 &= ~TIM_CR1_UDIS;
+    
+    if (step_now) {
+        tim->EGR = TIM_EGR_UG;
+        __HAL_TIM_CLEAR_FLAG(config_.step_timer, TIM_FLAG_UPDATE);
+    }
+}
+
+int32_t StepperMotor::getStepCount() {
+    if (config_.count_timer == nullptr) {
+        return step_count_;
+    }
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    accumulateSteps();
+    const int32_t steps = step_count_;
+    __set_PRIMASK(primask);
+    return steps;
+}
+
+void StepperMotor::setStepCount(int32_t steps) {
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (config_.count_timer != nullptr) {
+        accumulateSteps();
+    }
+    step_count_ = steps;
+    __set_PRIMASK(primask);
+}
+
+void StepperMotor::accumulateSteps() {
+    // Modulo 2^16: correct while fewer than 65536 steps came in between
+    const uint16_t count = static_cast<uint16_t>(config_.count_timer->Instance->CNT);
+    const int32_t steps = static_cast<uint16_t>(count - count_last_);
+    count_last_ = count;
+    step_count_ += is_forward_ ? steps : -steps;
 }
 
 uint32_t StepperMotor::getTimerClock() const {
-    // For STM32F411, APB1 timers run at 2x APB1 clock
-    return HAL_RCC_GetPCLK1Freq() * 2;
+    return TimerClock::getClock(config_.step_timer->Instance);
 }
 
@@ -0,0 +1,62 @@
+#include "motor/VelocityRamp.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float LANDING_TOLERANCE = 1.0e-3f;  // Relative, on one jerk step
+
+}  // namespace
+
+VelocityRamp::VelocityRamp()
+    : velocity_(0.0f)
+    , acceleration_(0.0f)
+    , target_(0.0f)
+    , max_acceleration_(0.0f)
+    , max_jerk_(0.0f)
+{
+}
+
+void VelocityRamp::reset(float velocity, float acceleration) {
+    velocity_ = velocity;
+    acceleration_ = acceleration;
+    target_ = velocity;
+}
+
+bool VelocityRamp::setTarget(float velocity, float max_acceleration, float max_jerk) {
+    if (!(max_acceleration > 0.0f) || !(max_jerk > 0.0f) || !std::isfinite(velocity)) {
+        return false;
+    }
+    target_ = velocity;
+    max_acceleration_ = max_acceleration;
+    max_jerk_ = max_jerk;
+    return true;
+}
+
+float VelocityRamp::step(float dt) {
+    if (isSettled() || max_jerk_ <= 0.0f) {
+        return velocity_ * dt;
+    }
+
+    // Acceleration is constant over a tick and moves by at most one jerk
+    // step between ticks
+    const float jerk_step = max_jerk_ * dt;
+    const float error = target_ - velocity_;
+    float acceleration = error / dt;  // Reaches the setpoint on this tick
+    // Rounding must not leave a sliver of error (or a sign change at zero) for the next tick
+    const float limit = jerk_step * (1.0f + LANDING_TOLERANCE);
+    const bool lands = std::fabs(acceleration) <= limit && std::fabs(acceleration - acceleration_) <= limit;
+    if (!lands) {
+        // Largest acceleration that still ramps down to zero in whole jerk
+        // steps before the error runs out: a^2 / (2j) + a dt / 2 = |error|
+        const float landing = max_jerk_ * (std::sqrt(0.25f * dt * dt + 2.0f * std::fabs(error) / max_jerk_) - 0.5f * dt);
+        const float aim = std::copysign(std::min(landing, max_acceleration_), error);
+        acceleration = acceleration_ + std::clamp(aim - acceleration_, -jerk_step, jerk_step);
+    }
+
+    const float velocity = lands ? target_ : velocity_ + acceleration * dt;
+    const float distance = 0.5f * (velocity_ + velocity) * dt;
+    velocity_ = velocity;
+    acceleration_ = acceleration;
+    return distance;
+}
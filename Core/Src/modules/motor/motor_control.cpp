@@ -1,21 +1,138 @@
 #include "main.h"
+#include "motor/motor_control.h"
 #include "motor/StepperMotor.hpp"
 #include "motor/SCurveProfile.hpp"
+#include "motor/SCurveStepper.hpp"
 #include "motor/MotionPlanner.hpp"
 #include "motor/MotorStateMachine.hpp"
+#include "motor/MultiAxisCoordinator.hpp"
+#include "motor/StepPulseEngine.hpp"
+#include "motor/SpscQueue.hpp"
+#include "motor/PIDController.hpp"
+#include "comm/TelemetryProtocol.hpp"
+#include "comm/CommandReceiver.hpp"
+#include "hal/UartLogSink.hpp"
+#include "hal/CycleProfiler.hpp"
+#include "hal/LoopTimingRecorder.hpp"
+#include "hal/TimerClock.hpp"
+#include "hal/QuadratureEncoder.hpp"
+#include "util/StaticInstance.hpp"
+#include "util/RamCode.hpp"
 #include <stdio.h>
-#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
+extern TIM_HandleTypeDef htim1;  // Declared in main.c
 extern TIM_HandleTypeDef htim2;  // Declared in main.c
+extern TIM_HandleTypeDef htim3;  // Declared in main.c
+extern TIM_HandleTypeDef htim4;  // Declared in main.c
+extern TIM_HandleTypeDef htim5;  // Declared in main.c
+extern TIM_HandleTypeDef htim9;  // Declared in main.c
 
-// Test mode selection
-#define TEST_MODE_BASIC   0
-#define TEST_MODE_SCURVE  1
-#define CURRENT_TEST_MODE TEST_MODE_SCURVE  // Change this to switch modes
+// Main loop: 1 = execute commands from the GUI (USART2), 0 = loop the test moves
+#define COMMAND_MODE 1
 
-// Global instances (C++ style with proper initialization)
-static std::unique_ptr<StepperMotor> g_motor;
-static std::unique_ptr<MotorStateMachine> g_state_machine;
+// Control loop rate (TIM4 update interrupt), 1000-10000 Hz
+#define MOTION_UPDATE_FREQ_HZ 1000U
+
+// Step generation: 0 = planner sets the PWM rate every control tick,
+// 1 = per-step periods streamed into TIM2 by DMA (StepPulseEngine)
+#define USE_DMA_STEP_ENGINE 0
+
+// 1 = time profile evaluation with the DWT cycle counter before the test cycle
+#define RUN_PROFILE_BENCHMARK 0
+
+// Binary telemetry frames on USART2 (TelemetryProtocol), sampled in the
+// control loop; 0 = off. ~10.8 bytes per sample on the wire, so every tick
+// of the 1 kHz loop takes ~94% of 115200 baud, next to the console text.
+#define TELEMETRY_RATE_HZ 1000U
+
+// Position feedback: 1 = the TIM3 encoder closes a feedforward + PID loop
+// around axis 0's step rate (gains from SET_GAINS), 0 = open loop on the
+// TIM9 step count. Switchable at run time with motor_use_closed_loop().
+#define CLOSED_LOOP 0
+
+// Encoder counts (x4 quadrature) per motor step, e.g. a 1000-line encoder
+// (4000 counts/rev) on 3200 steps/rev. At least 1, so the loop can settle
+// on a step.
+#define ENCODER_COUNTS_PER_STEP 1.25f
+
+// Position loop limits: largest PID correction (steps/s) and the following
+// error at which the axis is stopped with ERROR_DETECTED (steps)
+#define MAX_CORRECTION_STEPS_PER_SEC 2000.0f
+#define MAX_FOLLOWING_ERROR_STEPS 200.0f
+
+// Jerk for MOVE commands that do not give one (x max_acceleration, per second)
+#define DEFAULT_JERK_PER_ACCEL 5.0f
+
+// Control rate the profiled loop must fit (GET_PROFILE budget check)
+#define PROFILE_BUDGET_HZ 10000U
+
+// Interval of the LOOP_TIMING frames (jitter and deadline misses), 0 = off
+#define LOOP_TIMING_REPORT_MS 1000U
+
+// Global instances: static storage, constructed by motor_control_init() in order
+static StaticInstance<StepperMotor> g_motor;
+static StaticInstance<MotorStateMachine> g_state_machine;
+static StaticInstance<MotionPlanner> g_planner;
+static StaticInstance<StepPulseEngine> g_step_engine;
+static StaticInstance<StepperMotor> g_axis_motors[2];  // Axes 1-2 (axis 0 is g_motor)
+static StaticInstance<MultiAxisCoordinator> g_coordinator;
+static StaticInstance<QuadratureEncoder> g_encoder;  // TIM3, on axis 0's shaft
+static bool g_coordinator_moved_last = false;  // Which of planner/coordinator owns axis 0's position
+
+// Telemetry: sampled in the TIM4 ISR, framed and sent from the main loop
+static SpscQueue<TelemetryProtocol::Sample, 64> g_telemetry_queue;
+static TelemetryEncoder g_telemetry_encoder;
+static uint32_t g_telemetry_decimation = 0;  // Control ticks per sample (0 = off)
+static uint32_t g_telemetry_period_us = 0;
+static uint32_t g_telemetry_ticks = 0;
+static uint32_t g_telemetry_index = 0;
+static volatile uint32_t g_telemetry_dropped = 0;  // Samples lost to a full queue
+
+// Position loop: run in the TIM4 ISR after the planner, gains set from the main loop
+static PIDController g_position_loop;
+static volatile bool g_closed_loop = false;
+static bool g_position_loop_active = false;  // ISR only, drove axis 0 on the last tick
+static bool g_position_fault_posted = false;  // ISR only
+
+// Control loop timing: stamped in the TIM4 ISR, reported from the main loop
+static LoopTimingRecorder g_loop_timing;
+static uint8_t g_timing_sequence = 0;
+static uint32_t g_timing_sent_ms = 0;
+
+// Commands: received by USART2 RX DMA, executed in the main loop
+struct PlannedMove {
+    bool valid;
+    float steps;  // Relative
+    float max_velocity;
+    float max_acceleration;
+    float max_jerk;
+};
+static PlannedMove g_planned_move = {};
+static uint8_t g_ack_sequence = 0;
+static volatile bool g_start_pending = false;       // START waiting for its first control tick
+static volatile uint32_t g_start_cycles = 0;        // DWT stamp of the START reception event
+static volatile uint32_t g_command_latency_us = 0;
+static volatile uint32_t g_command_latency_max_us = 0;
+static volatile bool g_motion_started = false;      // START waiting for the ISR to follow its move
+static bool g_motion_tracked = false;                // ISR only
+static uint32_t g_motion_events_posted = 0;          // ISR only, MOTION_COMPLETEs of the tracked move
+
+/**
+ * @brief Queue a log line on the console sink directly, without stdout
+ */
+void log_line(const char* line) {
+    UartLogSink::console().write(line, static_cast<uint32_t>(std::strlen(line)));
+}
+
+/**
+ * @brief Axis 0 position measured by the encoder (steps)
+ */
+float encoder_position() {
+    return static_cast<float>(g_encoder->getCount()) / ENCODER_COUNTS_PER_STEP;
+}
 
 /**
  * @brief Initialize stepper motor with hardware configuration
@@ -28,6 +145,9 @@ StepperMotor& initializeMotor() {
     config.step_timer = &htim2;
     config.step_channel = TIM_CHANNEL_1;
     
+    // Step counter (TIM9, clocked by TIM2 TRGO = OC1REF on ITR0)
+    config.count_timer = &htim9;
+    
     // Direction control (PA8)
     config.dir_port = GPIOA;
     config.dir_pin = GPIO_PIN_8;
@@ -37,7 +157,7 @@ StepperMotor& initializeMotor() {
     config.enable_pin = GPIO_PIN_9;
     config.enable_active_low = false;  // Active HIGH enable (enable when pin is HIGH)
     
-    g_motor = std::make_unique<StepperMotor>(config);
+    g_motor.construct(config);
     return *g_motor;
 }
 
@@ -46,14 +166,19 @@ StepperMotor& initializeMotor() {
  * @return Reference to initialized state machine
  */
 MotorStateMachine& initializeStateMachine() {
-    g_state_machine = std::make_unique<MotorStateMachine>();
+    g_state_machine.construct();
     
     // Set up state transition callback
     g_state_machine->setTransitionCallback(
         [](MotorStateMachine::State from, MotorStateMachine::State to, 
            MotorStateMachine::Event event) {
-            // This is automatically logged by the state machine
-            (void)from; (void)to; (void)event;
+            // Transitions run in the main loop, never in an interrupt
+            char line[96];
+            snprintf(line, sizeof(line), "STATE: %s -> %s (event: %s)\r\n",
+                     MotorStateMachine::getStateName(from),
+                     MotorStateMachine::getStateName(to),
+                     MotorStateMachine::getEventName(event));
+            log_line(line);
         }
     );
     
@@ -62,10 +187,10 @@ MotorStateMachine& initializeStateMachine() {
         [](MotorStateMachine::State state) {
             switch (state) {
                 case MotorStateMachine::State::READY:
-                    printf("  → Motor ready for commands\r\n");
+                    log_line("  → Motor ready for commands\r\n");
                     break;
                 case MotorStateMachine::State::ERROR:
-                    printf("  → ERROR STATE - System halted!\r\n");
+                    log_line("  → ERROR STATE - System halted!\r\n");
                     break;
                 default:
                     break;
@@ -76,200 +201,593 @@ MotorStateMachine& initializeStateMachine() {
     return *g_state_machine;
 }
 
-// S-curve test with smooth acceleration/deceleration (C++ style with state machine)
-void test_scurve_motion(StepperMotor& motor, MotorStateMachine& sm) {
-    printf("\r\n=== S-Curve Motion Control Test (with State Machine) ===\r\n");
-    printf("Smooth acceleration and deceleration with controlled jerk\r\n\r\n");
+/**
+ * @brief Initialize motion planner on the TIM4 control loop
+ * @return Reference to initialized planner
+ */
+MotionPlanner& initializePlanner() {
+    g_planner.construct();
     
-    // Enable motor and transition state
-    sm.processEvent(MotorStateMachine::Event::ENABLE);
-    motor.setEnabled(true);
-    printf("  Motor enabled: PA9 should be HIGH\r\n");
-    HAL_Delay(500);  // Give time to see enable signal on logic analyzer
+    // Called from the TIM4 interrupt; in closed loop the position loop
+    // drives the motor and the encoder is the position
+    g_planner->setSpeedCallback([](float speed) {
+        if (!g_closed_loop) {
+            g_motor->setStepRate(speed);
+        }
+    });
+    g_planner->setDirectionCallback([](bool forward) {
+        if (!g_closed_loop) {
+            g_motor->setDirection(forward);
+        }
+    });
+    g_planner->setPositionCallback([]() {
+        return g_closed_loop ? static_cast<int32_t>(std::lround(encoder_position())) : g_motor->getStepCount();
+    });
     
-    // Create S-curve profile
-    SCurveProfile profile;
-    SCurveProfile::Config config;
-    
-    // Test 1: Move 1000 steps with moderate speed
-    printf("\nTest 1: Move 1000 steps (smooth acceleration)\r\n");
-    config.max_velocity = 500.0f;       // steps/sec
-    config.max_acceleration = 1000.0f;  // steps/sec²
-    config.max_jerk = 5000.0f;          // steps/sec³
-    config.start_velocity = 0.0f;
-    
-    if (profile.calculate(1000.0f, config)) {
-        printf("  Profile calculated successfully!\r\n");
-        printf("  Total time: %.2f sec\r\n", profile.getTotalTime());
-        printf("  Max velocity: %.1f steps/sec\r\n", config.max_velocity);
-        
-        motor.setDirection(true);  // Forward
-        
-        // Start motion - transition to ACCELERATING
-        sm.processEvent(MotorStateMachine::Event::START_MOTION);
-        
-        // Execute motion by updating speed every 50ms
-        uint32_t start = HAL_GetTick();
-        float elapsed = 0.0f;
-        bool reached_cruise = false;
-        
-        printf("  Starting motion loop...\r\n");
-        
-        // **TEST: Set constant speed at start and never change it**
-        printf("  TEST: Setting constant 300 steps/sec for entire profile duration\r\n");
-        motor.setStepRate(300.0f);  // Set once
-        
-        while (elapsed < profile.getTotalTime()) {
-            elapsed = (HAL_GetTick() - start) / 1000.0f;
-            
-            SCurveProfile::State state = profile.getStateAtTime(elapsed);
-            
-            // DON'T update speed - keep it constant to test if problem is with updating
-            // motor.setStepRate(state.velocity);
+    // DMA step engine shares TIM2 CH1 with the PWM output
+    StepPulseEngine::Config engine_config;
+    engine_config.step_timer = &htim2;
+    engine_config.step_channel = TIM_CHANNEL_1;
+    g_step_engine.construct(engine_config);
+    g_planner->setStepEngine(USE_DMA_STEP_ENGINE ? g_step_engine.get() : nullptr);
+    
+    g_planner->init(&htim4, MOTION_UPDATE_FREQ_HZ);
+    return *g_planner;
+}
+
+/**
+ * @brief Create the auxiliary axes and the coordinator on the TIM4 control loop
+ * @return Reference to initialized coordinator
+ * 
+ * Axis 0: TIM2 CH1 (PA0), master, TRGO = counter enable
+ * Axis 1: TIM1 CH3 (PA10), slave in trigger mode on ITR1 (TIM2)
+ * Axis 2: TIM5 CH2 (PA1), slave in trigger mode on ITR0 (TIM2)
+ */
+MultiAxisCoordinator& initializeCoordinator() {
+    StepperMotor::Config config;
+    config.enable_active_low = false;
+    
+    config.step_timer = &htim1;
+    config.step_channel = TIM_CHANNEL_3;
+    config.dir_port = AXIS1_DIR_GPIO_Port;
+    config.dir_pin = AXIS1_DIR_Pin;
+    config.enable_port = AXIS1_EN_GPIO_Port;
+    config.enable_pin = AXIS1_EN_Pin;
+    g_axis_motors[0].construct(config);
+    
+    config.step_timer = &htim5;
+    config.step_channel = TIM_CHANNEL_2;
+    config.dir_port = AXIS2_DIR_GPIO_Port;
+    config.dir_pin = AXIS2_DIR_Pin;
+    config.enable_port = AXIS2_EN_GPIO_Port;
+    config.enable_pin = AXIS2_EN_Pin;
+    g_axis_motors[1].construct(config);
+    
+    g_coordinator.construct();
+    g_coordinator->addAxis(g_motor.get());
+    g_coordinator->addAxis(g_axis_motors[0].get());
+    g_coordinator->addAxis(g_axis_motors[1].get());
+    
+    // Shares the planner's control-loop tick
+    g_coordinator->init(&htim4, g_planner->getUpdateFrequency());
+    return *g_coordinator;
+}
+
+/**
+ * @brief Start the TIM3 encoder and set up the position loop
+ *
+ * The encoder counts from zero, like the TIM9 step count, so both start
+ * from the same origin.
+ */
+void initializeEncoder() {
+    QuadratureEncoder::Config config;
+    config.timer = &htim3;
+    g_encoder.construct(config);
+    
+    g_position_loop.setGains({ 40.0f, 20.0f, 0.05f, 1.0f });
+    g_position_loop.setLimits({ MAX_CORRECTION_STEPS_PER_SEC, MAX_FOLLOWING_ERROR_STEPS, 0.5f });
+    g_closed_loop = CLOSED_LOOP && g_encoder->isRunning();
+}
+
+/**
+ * @brief Derive the telemetry decimation from the control-loop rate
+ */
+void initializeTelemetry() {
+    const float loop_hz = g_planner->getUpdateFrequency();
+    g_telemetry_decimation = 0;
+    if (TELEMETRY_RATE_HZ > 0) {
+        g_telemetry_decimation = std::max(static_cast<uint32_t>(loop_hz / TELEMETRY_RATE_HZ + 0.5f), 1U);
+        g_telemetry_period_us = static_cast<uint32_t>(1e6f * g_telemetry_decimation / loop_hz + 0.5f);
+    }
+}
+
+/**
+ * @brief Arm the jitter recorder with the control period in core cycles
+ *
+ * Taken from the TIM4 registers, so the schedule matches the hardware
+ * exactly (TIM4 counts at its APB1 timer clock, the core clock here).
+ */
+void initializeLoopTiming() {
+    TIM_HandleTypeDef* htim = g_planner->getTimer();
+    const uint64_t timer_ticks = static_cast<uint64_t>(htim->Instance->PSC + 1U) * (htim->Instance->ARR + 1U);
+    const uint32_t timer_clock = TimerClock::getClock(htim->Instance);
+    g_loop_timing.start(static_cast<uint32_t>(timer_ticks * SystemCoreClock / timer_clock));
+}
+
+/**
+ * @brief Send the loop timing statistics as a LOOP_TIMING frame (main loop)
+ */
+void send_loop_timing() {
+    const LoopTimingRecorder::Snapshot snapshot = g_loop_timing.getSnapshot();
+    TelemetryProtocol::LoopTiming timing;
+    timing.clock_hz = SystemCoreClock;
+    timing.period_cycles = snapshot.period_cycles;
+    timing.iterations = snapshot.iterations;
+    timing.jitter_min = snapshot.jitter_min;
+    timing.jitter_max = snapshot.jitter_max;
+    timing.duration_max = snapshot.duration_max;
+    timing.misses = snapshot.misses;
+    timing.lost_ticks = snapshot.lost_ticks;
+    timing.worst_iteration = snapshot.worst_iteration;
+    timing.worst_lateness = snapshot.worst_lateness;
+    timing.worst_duration = snapshot.worst_duration;
+    timing.worst_context = snapshot.worst_context;
+    static_assert(LoopTimingRecorder::HISTOGRAM_BINS == TelemetryProtocol::TIMING_BINS,
+                  "LOOP_TIMING carries the whole histogram");
+    std::copy(snapshot.histogram, snapshot.histogram + LoopTimingRecorder::HISTOGRAM_BINS, timing.histogram);
+    
+    uint8_t frame[TelemetryProtocol::MAX_FRAME];
+    const size_t length = TelemetryProtocol::encodeLoopTiming(timing, g_timing_sequence++, frame, sizeof(frame));
+    UartLogSink::console().write(reinterpret_cast<const char*>(frame), length);
+}
+
+/**
+ * @brief Queue a telemetry sample every g_telemetry_decimation ticks (TIM4 ISR)
+ */
+void sample_telemetry() {
+    if (g_telemetry_decimation == 0 || ++g_telemetry_ticks < g_telemetry_decimation) {
+        return;
+    }
+    g_telemetry_ticks = 0;
+    
+    // Actual position is the encoder in closed loop, the step count otherwise
+    const MotionPlanner::Status status = g_planner->getStatus();
+    TelemetryProtocol::Sample sample;
+    sample.time_us = g_telemetry_index++ * g_telemetry_period_us;
+    sample.target_position = status.commanded_position;
+    sample.actual_position = status.current_position;
+    sample.target_velocity = status.current_velocity;
+    sample.actual_velocity = status.current_velocity;
+    sample.pid_output = 0.0f;
+    if (g_position_loop_active) {
+        sample.actual_position = encoder_position();
+        sample.actual_velocity = g_position_loop.getMeasuredVelocity();
+        sample.pid_output = 100.0f * g_position_loop.getCorrection() / g_position_loop.getLimits().max_correction;
+    }
+    sample.phase = static_cast<uint8_t>(status.phase);
+    if (!g_telemetry_queue.push(sample)) {
+        g_telemetry_dropped = g_telemetry_dropped + 1;
+    }
+}
+
+/**
+ * @brief Emit a signed step rate on axis 0 (TIM4 ISR, closed loop)
+ *
+ * On a reversal the step output is stopped first, so the new direction
+ * starts on a fresh period, as MotionPlanner does when a jog reverses.
+ */
+void drive_axis(float velocity) {
+    const bool forward = velocity > 0.0f;
+    if (velocity != 0.0f && forward != g_motor->isForward()) {
+        g_motor->stop();
+        g_motor->setDirection(forward);
+    }
+    g_motor->setStepRate(std::fabs(velocity));
+}
+
+/**
+ * @brief Correct axis 0's step rate from the encoder (TIM4 ISR)
+ * @param commanded Planned position for this tick, read before the planner advanced
+ * @param measured Encoder position, read with it
+ *
+ * Only planner motion on an enabled driver is corrected: coordinated moves
+ * and the DMA step engine emit their steps open loop. A following error
+ * fault stops the steps and posts ERROR_DETECTED; the main loop then stops
+ * the planner.
+ */
+void update_position_loop(float commanded, float measured) {
+    const bool active = g_closed_loop && !g_coordinator_moved_last && g_motor->isEnabled();
+    if (active && !g_position_loop_active && !g_position_loop.isFaulted()) {
+        g_position_loop.reset();
+    }
+    g_position_loop_active = active;
+    if (!active) {
+        return;
+    }
+    
+    const float velocity = g_planner->getStatus().current_velocity;
+    const float rate = g_position_loop.update(commanded, velocity, measured, 1.0f / g_planner->getUpdateFrequency());
+    if (g_position_loop.isFaulted()) {
+        if (!g_position_fault_posted) {
+            g_position_fault_posted = true;
+            g_state_machine->post(MotorStateMachine::Event::ERROR_DETECTED);
+        }
+        g_motor->stop();
+        return;
+    }
+    g_position_fault_posted = false;
+    drive_axis(rate);
+}
+
+/**
+ * @brief Command-to-motion latency, on the first control tick of a started move (TIM4 ISR)
+ */
+void measure_command_latency() {
+    if (!g_start_pending || g_planner->isComplete()) {
+        return;
+    }
+    g_start_pending = false;
+    const uint32_t latency_us = (DWT->CYCCNT - g_start_cycles) / (SystemCoreClock / 1000000U);
+    g_command_latency_us = latency_us;
+    g_command_latency_max_us = std::max(static_cast<uint32_t>(g_command_latency_max_us), latency_us);
+}
+
+/**
+ * @brief Post the commanded move's progress to the state machine (TIM4 ISR)
+ *
+ * One MOTION_COMPLETE when acceleration ends (phase 4), one when
+ * deceleration starts (phase 5) and the rest when the move is over, so
+ * ACCELERATING -> RUNNING -> DECELERATING -> READY happens in order even if
+ * the move skips phases or is stopped. A switch onto a stop ramp posts
+ * STOP instead (-> DECELERATING from wherever the move was). The main loop
+ * dispatches them.
+ */
+void post_motion_events() {
+    if (g_motion_started) {
+        g_motion_started = false;
+        g_motion_tracked = true;
+        g_motion_events_posted = 0;
+    }
+    if (!g_motion_tracked) {
+        return;
+    }
+    uint32_t stages = 3;
+    if (!g_planner->isComplete()) {
+        const uint32_t phase = g_planner->getStatus().phase;
+        stages = (phase >= 5) ? 2 : (phase == 4) ? 1 : 0;
+        if (g_planner->isStopping() && g_motion_events_posted < 2) {
+            g_state_machine->post(MotorStateMachine::Event::STOP);
+            g_motion_events_posted = 2;
+        }
+    }
+    while (g_motion_events_posted < stages) {
+        g_state_machine->post(MotorStateMachine::Event::MOTION_COMPLETE);
+        g_motion_events_posted++;
+    }
+    if (stages == 3) {
+        g_motion_tracked = false;
+    }
+}
+
+/**
+ * @brief Check command arguments (all finite; the first skip_sign may be negative)
+ */
+bool valid_args(const TelemetryProtocol::Command& command, uint8_t min_count, uint8_t max_count,
+                uint8_t skip_sign, bool allow_zero) {
+    if (command.arg_count < min_count || command.arg_count > max_count) {
+        return false;
+    }
+    for (uint8_t i = 0; i < command.arg_count; i++) {
+        const float arg = command.args[i];
+        if (!std::isfinite(arg) || (i >= skip_sign && (arg < 0.0f || (!allow_zero && arg == 0.0f)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Run one command from the GUI against the planner and state machine
+ * @param command Decoded COMMAND frame
+ * @param rx_cycles DWT stamp of its reception event
+ * @return Acknowledgement to send back
+ */
+TelemetryProtocol::Ack execute_command(const TelemetryProtocol::Command& command, uint32_t rx_cycles) {
+    using Opcode = TelemetryProtocol::CommandOpcode;
+    using Status = TelemetryProtocol::AckStatus;
+    MotorStateMachine& sm = *g_state_machine;
+    TelemetryProtocol::Ack ack = { command.sequence, command.opcode, Status::OK, 0 };
+    
+    switch (command.opcode) {
+        case Opcode::GET_VERSION:
+            ack.value = TelemetryProtocol::PROTOCOL_VERSION;
+            break;
             
-            // Track state transitions based on profile phase
-            if (!reached_cruise && state.phase == 4) {
-                sm.processEvent(MotorStateMachine::Event::MOTION_COMPLETE);  // ACCELERATING -> RUNNING
-                reached_cruise = true;
+        case Opcode::MOVE:
+            // steps (relative), max_velocity, max_acceleration[, max_jerk]
+            if (!valid_args(command, 3, 4, 1, false) || command.args[0] == 0.0f) {
+                ack.status = Status::BAD_ARGS;
+                break;
             }
+            g_planned_move.steps = command.args[0];
+            g_planned_move.max_velocity = command.args[1];
+            g_planned_move.max_acceleration = command.args[2];
+            g_planned_move.max_jerk = (command.arg_count == 4) ? command.args[3]
+                                                               : command.args[2] * DEFAULT_JERK_PER_ACCEL;
+            g_planned_move.valid = true;
+            break;
             
-            // Print status every 200ms
-            static uint32_t last_print = 0;
-            if (HAL_GetTick() - last_print > 200) {
-                printf("  t=%.2fs, pos=%.1f, vel=%.1f, acc=%.1f, phase=%lu, state=%s\r\n",
-                       elapsed, state.position, state.velocity, 
-                       state.acceleration, state.phase,
-                       MotorStateMachine::getStateName(sm.getState()));
-                last_print = HAL_GetTick();
+        case Opcode::START: {
+            if (!g_planned_move.valid) {
+                ack.status = Status::REJECTED;
+                break;
             }
-            
-            HAL_Delay(20);  // Update every 20ms (smoother than 50ms)
+            if (sm.isState(MotorStateMachine::State::IDLE)) {
+                motor_enable(true);
+                sm.processEvent(MotorStateMachine::Event::ENABLE);
+            }
+            if (!sm.canMove()) {
+                ack.status = Status::REJECTED;
+                break;
+            }
+            // Armed before the move exists, so the first tick that runs it is the one measured,
+            // and ACCELERATING before the ISR can post the move's first MOTION_COMPLETE
+            g_start_cycles = rx_cycles;
+            g_start_pending = true;
+            sm.processEvent(MotorStateMachine::Event::START_MOTION);
+            g_motion_started = true;
+            if (!motor_move_to(motor_get_position() + g_planned_move.steps, g_planned_move.max_velocity,
+                               g_planned_move.max_acceleration, g_planned_move.max_jerk)) {
+                g_start_pending = false;
+                ack.status = Status::REJECTED;
+                // Nothing moved: the ISR posts the MOTION_COMPLETEs that take it back to READY
+            }
+            break;
         }
         
-        // Motion complete - transition to DECELERATING then READY
-        sm.processEvent(MotorStateMachine::Event::MOTION_COMPLETE);
-        motor.stop();
-        sm.processEvent(MotorStateMachine::Event::MOTION_COMPLETE);
-        
-        printf("  Motion complete!\r\n");
-    } else {
-        printf("  ERROR: Test 1 profile calculation FAILED!\r\n");
-    }
-    
-    HAL_Delay(2000);
-    
-    // Test 2: Move 2000 steps with higher speed
-    printf("\nTest 2: Move 2000 steps (faster profile)\r\n");
-    config.max_velocity = 1000.0f;
-    config.max_acceleration = 2000.0f;
-    config.max_jerk = 10000.0f;
-    
-    if (profile.calculate(2000.0f, config)) {
-        printf("  Total time: %.2f sec\r\n", profile.getTotalTime());
-        printf("  Max velocity: %.1f steps/sec\r\n", config.max_velocity);
-        
-        // Re-enable motor for Test 2
-        motor.setEnabled(true);  // ← FIX: Enable motor again!
-        motor.setDirection(false);  // Reverse
-        sm.processEvent(MotorStateMachine::Event::START_MOTION);
-        
-        uint32_t start = HAL_GetTick();
-        float elapsed = 0.0f;
-        bool reached_cruise = false;
-        
-        while (elapsed < profile.getTotalTime()) {
-            elapsed = (HAL_GetTick() - start) / 1000.0f;
+        case Opcode::STOP:
+            // Ramp down; the control loop posts STOP when it switches over.
+            // Without a planner move to ramp (coordinated move, DMA step
+            // engine) the stop is immediate.
+            if (!motor_decelerate_to_stop()) {
+                motor_stop();
+                sm.processEvent(MotorStateMachine::Event::STOP);
+            }
+            break;
+            
+        case Opcode::ESTOP:
+            motor_stop();
+            motor_axes_enable(false);
+            if (sm.processEvent(MotorStateMachine::Event::EMERGENCY_STOP)) {
+                sm.processEvent(MotorStateMachine::Event::MOTION_COMPLETE);  // Stopped at once
+            }
+            sm.processEvent(MotorStateMachine::Event::DISABLE);
+            break;
             
-            SCurveProfile::State state = profile.getStateAtTime(elapsed);
-            motor.setStepRate(state.velocity);
+        case Opcode::HOME:
+            // No home switch on this board
+            ack.status = Status::REJECTED;
+            break;
             
-            // Track state transitions
-            if (!reached_cruise && state.phase == 4) {
-                sm.processEvent(MotorStateMachine::Event::MOTION_COMPLETE);
-                reached_cruise = true;
+        case Opcode::SET_GAINS:
+            if (!valid_args(command, 4, 4, 0, true)) {
+                ack.status = Status::BAD_ARGS;
+                break;
             }
+            {
+                // kp, ki, kd, kf; the control loop reads them every tick
+                const uint32_t primask = __get_PRIMASK();
+                __disable_irq();
+                g_position_loop.setGains({ command.args[0], command.args[1], command.args[2], command.args[3] });
+                __set_PRIMASK(primask);
+            }
+            break;
             
-            static uint32_t last_print = 0;
-            if (HAL_GetTick() - last_print > 200) {
-                printf("  t=%.2fs, pos=%.1f, vel=%.1f, acc=%.1f, phase=%lu, state=%s\r\n",
-                       elapsed, state.position, state.velocity, 
-                       state.acceleration, state.phase,
-                       MotorStateMachine::getStateName(sm.getState()));
-                last_print = HAL_GetTick();
+        case Opcode::GET_PROFILE:
+            // [reset]: non-zero clears the probes after the report
+            if (!valid_args(command, 0, 1, 0, true)) {
+                ack.status = Status::BAD_ARGS;
+                break;
+            }
+            CycleProfiler::report(PROFILE_BUDGET_HZ);
+            ack.value = CycleProfiler::getStats(CycleProfiler::Probe::CONTROL_LOOP).max;
+            if (command.arg_count == 1 && command.args[0] != 0.0f) {
+                CycleProfiler::reset();
             }
+            break;
             
-            HAL_Delay(50);
-        }
-        
-        sm.processEvent(MotorStateMachine::Event::MOTION_COMPLETE);
-        motor.stop();
-        sm.processEvent(MotorStateMachine::Event::MOTION_COMPLETE);
-        printf("  Motion complete!\r\n");
+        default:
+            ack.status = Status::UNKNOWN;
+            break;
+    }
+    return ack;
+}
+
+/**
+ * @brief HAL_Delay() that keeps the telemetry stream flowing
+ */
+void wait_ms(uint32_t ms) {
+    const uint32_t start = HAL_GetTick();
+    while (HAL_GetTick() - start < ms) {
+        motor_telemetry_service();
+    }
+}
+
+/**
+ * @brief Run one planner move, reporting progress from the main loop
+ */
+void run_planned_move(MotionPlanner& planner, float target, float max_velocity,
+                      float max_acceleration, float max_jerk) {
+    if (!planner.moveTo(target, max_velocity, max_acceleration, max_jerk)) {
+        printf("Move rejected!\r\n");
+        return;
     }
     
-    HAL_Delay(2000);
+    // Motion runs in the TIM4 ISR; the main loop only reports
+    uint32_t last_print = HAL_GetTick();
+    while (!planner.isComplete()) {
+        motor_telemetry_service();
+        if (HAL_GetTick() - last_print >= 200) {
+            MotionPlanner::Status status = planner.getStatus();
+            printf("  pos=%ld vel=%ld progress=%ld%%\r\n",
+                   std::lround(status.current_position), std::lround(status.current_velocity),
+                   std::lround(status.progress * 100.0f));
+            last_print = HAL_GetTick();
+        }
+    }
+    printf("Complete! pos=%ld\r\n", std::lround(planner.getStatus().current_position));
 }
 
-// Basic speed test (C++ style)
-void test_basic_speed(StepperMotor& motor) {
-    printf("\r\n=== Basic Speed Control Test ===\r\n");
+#if RUN_PROFILE_BENCHMARK
+/**
+ * @brief Cycles per profile evaluation at the 10 kHz control rate (DWT CYCCNT)
+ *
+ * Compares the closed-form getStateAtTime() against SCurveStepper::step()
+ * across a whole move. Interrupts are masked so max is the true worst case.
+ */
+void benchmark_profile_evaluation() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
     
-    // Enable motor driver (RAII pattern)
-    motor.setEnabled(true);
-    HAL_Delay(100);
+    SCurveProfile profile;
+    SCurveProfile::Config config = { 1000.0f, 2000.0f, 10000.0f, 0.0f };
+    profile.calculate(2000.0f, config);
     
-    while (1) {
-        // Forward 100 steps/s
-        printf("Forward 100 steps/s (10s)\r\n");
-        motor.setDirection(true);
-        motor.setStepRate(100.0f);
-        HAL_Delay(10000);
-        
-        // Stop
-        printf("Stop (2s)\r\n");
-        motor.stop();
-        HAL_Delay(2000);
-        
-        // Reverse 200 steps/s
-        printf("Reverse 200 steps/s (10s)\r\n");
-        motor.setDirection(false);
-        motor.setStepRate(200.0f);
-        HAL_Delay(10000);
-        
-        // Stop
-        printf("Stop (2s)\r\n");
-        motor.stop();
-        HAL_Delay(2000);
-        
-        // Fast forward 500 steps/s
-        printf("Fast forward 500 steps/s (10s)\r\n");
-        motor.setDirection(true);
-        motor.setStepRate(500.0f);
-        HAL_Delay(10000);
-        
-        // Stop
-        printf("Stop (3s)\r\n\r\n");
-        motor.stop();
-        HAL_Delay(3000);
+    const float dt = 1.0f / 10000.0f;
+    volatile float sink = 0.0f;
+    
+    // Cost of the CYCCNT read pair itself
+    uint32_t start = DWT->CYCCNT;
+    const uint32_t overhead = DWT->CYCCNT - start;
+    
+    uint32_t total = 0, worst = 0, calls = 0;
+    __disable_irq();
+    for (float t = dt; t < profile.getTotalTime(); t += dt) {
+        start = DWT->CYCCNT;
+        sink = sink + profile.getStateAtTime(t).position;
+        const uint32_t cycles = DWT->CYCCNT - start - overhead;
+        total += cycles;
+        worst = std::max(worst, cycles);
+        calls++;
     }
+    __enable_irq();
+    printf("getStateAtTime:      %lu cycles avg, %lu max (%lu calls)\r\n",
+           total / calls, worst, calls);
+    
+    SCurveStepper stepper;
+    stepper.start(profile, dt);
+    total = 0, worst = 0, calls = 0;
+    __disable_irq();
+    while (!stepper.getState().is_complete) {
+        start = DWT->CYCCNT;
+        sink = sink + stepper.step().position;
+        const uint32_t cycles = DWT->CYCCNT - start - overhead;
+        total += cycles;
+        worst = std::max(worst, cycles);
+        calls++;
+    }
+    __enable_irq();
+    printf("SCurveStepper::step: %lu cycles avg, %lu max (%lu calls)\r\n",
+           total / calls, worst, calls);
 }
+#endif
 
 // C linkage for main (C++ implementation inside)
 extern "C" {
 
+void motor_control_init(void) {
+    initializeMotor();
+    initializeStateMachine();
+    initializePlanner();
+    initializeCoordinator();
+    initializeEncoder();
+    initializeTelemetry();
+    
+    // DWT cycle counter stamps command reception for the latency figures
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    CycleProfiler::init();
+    initializeLoopTiming();
+    if (!CommandReceiver::console().start()) {
+        printf("WARNING: USART2 command reception failed to start\r\n");
+    }
+    
+    g_state_machine->processEvent(MotorStateMachine::Event::INITIALIZE);
+}
+
+void motor_command_service(void) {
+    CommandReceiver& receiver = CommandReceiver::console();
+    TelemetryProtocol::Command command;
+    while (receiver.poll(command)) {
+        const TelemetryProtocol::Ack ack = execute_command(command, receiver.getCommandCycles());
+        uint8_t frame[TelemetryProtocol::MAX_FRAME];
+        const size_t length = TelemetryProtocol::encodeAck(ack, g_ack_sequence++, frame, sizeof(frame));
+        UartLogSink::console().write(reinterpret_cast<const char*>(frame), length);
+    }
+    // A following error fault stopped the steps; stop the move behind them
+    if (g_position_loop.isFaulted() && !g_planner->isComplete()) {
+        motor_stop();
+    }
+    // MOTION_COMPLETEs posted by the control loop
+    g_state_machine->dispatch();
+}
+
+uint32_t motor_command_latency_us(void) {
+    return g_command_latency_us;
+}
+
+uint32_t motor_command_latency_max_us(void) {
+    return g_command_latency_max_us;
+}
+
+void motor_telemetry_service(void) {
+    // Frames go out as single writes, so console text never splits them
+    while (const TelemetryProtocol::Sample* sample = g_telemetry_queue.peek()) {
+        const bool frame_ready = g_telemetry_encoder.add(*sample, static_cast<uint16_t>(g_telemetry_period_us));
+        g_telemetry_queue.pop();
+        if (frame_ready) {
+            UartLogSink::console().write(reinterpret_cast<const char*>(g_telemetry_encoder.getFrame()),
+                                         g_telemetry_encoder.getFrameLength());
+        }
+    }
+    
+    if (LOOP_TIMING_REPORT_MS > 0 && HAL_GetTick() - g_timing_sent_ms >= LOOP_TIMING_REPORT_MS) {
+        g_timing_sent_ms = HAL_GetTick();
+        send_loop_timing();
+    }
+}
+
+uint32_t motor_telemetry_dropped(void) {
+    return g_telemetry_dropped;
+}
+
 void motor_control_main(void) {
     printf("\r\n=== STM32 Robotics Control System ===\r\n");
     printf("System Clock: %lu Hz\r\n", SystemCoreClock);
-    printf("APB1 Timer Clock: %lu Hz\r\n", HAL_RCC_GetPCLK1Freq() * 2);
+    printf("APB1 Timer Clock: %lu Hz\r\n", TimerClock::getClock(TIM2));
+    printf("APB2 Timer Clock: %lu Hz\r\n", TimerClock::getClock(TIM1));
     printf("C++ Version: Modern C++17\r\n");
     printf("Features: State Machine, S-Curve Profiles, OOP Design\r\n\r\n");
     
-    // Initialize motor and state machine with C++ RAII pattern
-    StepperMotor& motor = initializeMotor();
-    MotorStateMachine& sm = initializeStateMachine();
+#if RUN_PROFILE_BENCHMARK
+    benchmark_profile_evaluation();
+#endif
     
-    // Initialize state machine
-    sm.processEvent(MotorStateMachine::Event::INITIALIZE);
+    motor_control_init();
+    
+    printf("Control loop: %ld Hz (TIM4)\r\n", std::lround(g_planner->getUpdateFrequency()));
+    
+#if COMMAND_MODE
+    // Motion, stops and gains come from the GUI; nothing here blocks
+    printf("Waiting for commands on USART2\r\n");
+    while (1) {
+        motor_command_service();
+        motor_telemetry_service();
+    }
+#else
+    StepperMotor& motor = *g_motor;
+    MotionPlanner& planner = *g_planner;
     
     // === S-CURVE MOTION TEST ===
     printf("\r\n=== S-Curve Motion Test ===\r\n");
@@ -278,114 +796,239 @@ void motor_control_main(void) {
         // Test 1: 1000 steps forward
         printf("\n--- Test 1: 1000 steps (smooth) ---\r\n");
         motor.setEnabled(true);
-        motor.setDirection(true);
-        HAL_Delay(100);
-        
-        SCurveProfile profile;
-        SCurveProfile::Config config;
-        config.max_velocity = 500.0f;
-        config.max_acceleration = 1000.0f;
-        config.start_velocity = 0.0f;
-        
-        if (profile.calculate(1000.0f, config)) {
-            printf("Profile calculated: %.2f sec\r\n", profile.getTotalTime());
-            
-            uint32_t start = HAL_GetTick();
-            float elapsed = 0.0f;
-            const float MIN_VELOCITY = 50.0f;
-            bool motor_started = false;
-            float last_velocity = 0.0f;
-            int loop_count = 0;
-            
-            while (elapsed < profile.getTotalTime()) {
-                elapsed = (HAL_GetTick() - start) / 1000.0f;
-                SCurveProfile::State state = profile.getStateAtTime(elapsed);
-                
-                // Printf provides necessary timing delays for PWM stability
-                printf("  [%d] t=%.2f v=%.1f", loop_count++, elapsed, state.velocity);
-                
-                if (state.velocity >= MIN_VELOCITY) {
-                    // Only update if velocity changed by more than 50 steps/sec
-                    if (std::abs(state.velocity - last_velocity) > 50.0f) {
-                        motor.setStepRate(state.velocity);
-                        last_velocity = state.velocity;
-                        printf(" -> SET\r\n");
-                    } else {
-                        printf(" -> RUN\r\n");
-                    }
-                    motor_started = true;
-                } else if (motor_started) {
-                    printf(" -> STOP\r\n");
-                    break;
-                } else {
-                    printf(" -> WAIT\r\n");
-                }
-                
-                HAL_Delay(50);
-            }
-            
-            // Ensure motor is stopped (in case loop completed naturally)
-            motor.stop();
-            printf("Complete!\r\n");
-        }
+        wait_ms(100);
+        run_planned_move(planner, 1000.0f, 500.0f, 1000.0f, 5000.0f);
         
-        HAL_Delay(2000);
+        wait_ms(2000);
         
         // Test 2: 2000 steps reverse
         printf("\n--- Test 2: 2000 steps (faster, reverse) ---\r\n");
-        motor.setDirection(false);
-        HAL_Delay(100);
-        
-        config.max_velocity = 1000.0f;
-        config.max_acceleration = 2000.0f;
-        
-        if (profile.calculate(2000.0f, config)) {
-            printf("Profile calculated: %.2f sec\r\n", profile.getTotalTime());
-            
-            uint32_t start = HAL_GetTick();
-            float elapsed = 0.0f;
-            const float MIN_VELOCITY = 50.0f;
-            bool motor_started = false;
-            float last_velocity = 0.0f;
-            int loop_count = 0;
-            
-            while (elapsed < profile.getTotalTime()) {
-                elapsed = (HAL_GetTick() - start) / 1000.0f;
-                SCurveProfile::State state = profile.getStateAtTime(elapsed);
-                
-                // Printf provides necessary timing delays for PWM stability
-                printf("  [%d] t=%.2f v=%.1f", loop_count++, elapsed, state.velocity);
-                
-                if (state.velocity >= MIN_VELOCITY) {
-                    if (std::abs(state.velocity - last_velocity) > 50.0f) {
-                        motor.setStepRate(state.velocity);
-                        last_velocity = state.velocity;
-                        printf(" -> SET\r\n");
-                    } else {
-                        printf(" -> RUN\r\n");
-                    }
-                    motor_started = true;
-                } else if (motor_started) {
-                    printf(" -> STOP\r\n");
-                    break;
-                } else {
-                    printf(" -> WAIT\r\n");
-                }
-                
-                HAL_Delay(50);
-            }
-
-            
-            // Ensure motor is stopped
-            motor.stop();
-            printf("Complete!\r\n");
-        }
+        run_planned_move(planner, -1000.0f, 1000.0f, 2000.0f, 10000.0f);
         
         motor.setEnabled(false);
-        HAL_Delay(3000);
+        wait_ms(3000);
         
         printf("\n=== Cycle complete, repeating ===\r\n");
     }
+#endif
+}
+
+/**
+ * @brief Hand axis 0 back to the planner after a coordinated move
+ * @return false while a coordinated move is in progress
+ */
+static bool claim_planner_axis() {
+    if (!g_planner || (g_coordinator && !g_coordinator->isComplete())) {
+        return false;
+    }
+    if (g_coordinator_moved_last && g_planner->isComplete()) {
+        g_planner->setPosition(g_coordinator->getPosition(0));
+    }
+    return true;
+}
+
+bool motor_move_to(float target_steps, float max_velocity, float max_acceleration, float max_jerk) {
+    if (!claim_planner_axis() ||
+        !g_planner->moveTo(target_steps, max_velocity, max_acceleration, max_jerk)) {
+        return false;
+    }
+    g_coordinator_moved_last = false;
+    return true;
+}
+
+bool motor_jog(float velocity, float max_acceleration, float max_jerk) {
+    if (!claim_planner_axis() || !g_planner->jog(velocity, max_acceleration, max_jerk)) {
+        return false;
+    }
+    g_coordinator_moved_last = false;
+    return true;
+}
+
+bool motor_queue_move(float target_steps, float max_velocity, float max_acceleration, float max_jerk) {
+    if (!claim_planner_axis() ||
+        !g_planner->queueMove(target_steps, max_velocity, max_acceleration, max_jerk)) {
+        return false;
+    }
+    g_coordinator_moved_last = false;
+    return true;
+}
+
+uint32_t motor_queue_depth(void) {
+    return g_planner ? g_planner->getQueueDepth() : 0;
+}
+
+uint32_t motor_axis_count(void) {
+    return g_coordinator ? g_coordinator->getAxisCount() : 0;
+}
+
+bool motor_axes_move_to(const float* targets, float max_velocity, float max_acceleration, float max_jerk) {
+    if (!g_coordinator || !g_planner || !g_planner->isComplete()) {
+        return false;
+    }
+    if (!g_coordinator_moved_last || g_motor->hasStepCounter()) {
+        g_coordinator->setPosition(0, motor_get_position());
+    }
+    
+    MultiAxisCoordinator::Limits limits[MultiAxisCoordinator::MAX_AXES];
+    for (auto& axis_limits : limits) {
+        axis_limits = { max_velocity, max_acceleration, max_jerk };
+    }
+    if (!g_coordinator->moveTo(targets, limits)) {
+        return false;
+    }
+    g_coordinator_moved_last = true;
+    return true;
+}
+
+bool motor_axes_are_moving(void) {
+    return g_coordinator && !g_coordinator->isComplete();
+}
+
+float motor_axis_get_position(uint32_t axis) {
+    if (axis == 0) {
+        return motor_get_position();
+    }
+    return g_coordinator ? g_coordinator->getPosition(axis) : 0.0f;
+}
+
+void motor_axes_enable(bool enable) {
+    motor_enable(enable);
+    for (auto& motor : g_axis_motors) {
+        if (motor) {
+            motor->setEnabled(enable);
+        }
+    }
+}
+
+bool motor_use_step_engine(bool enable) {
+    if (!g_planner || !g_planner->isComplete() || (enable && g_closed_loop)) {
+        return false;
+    }
+    g_planner->setStepEngine(enable ? g_step_engine.get() : nullptr);
+    return true;
+}
+
+bool motor_use_closed_loop(bool enable) {
+    if (!g_planner || !g_planner->isComplete() || motor_axes_are_moving() ||
+        (enable && (!g_encoder->isRunning() || g_planner->getStepEngine() != nullptr))) {
+        return false;
+    }
+    if (enable) {
+        // The planner continues from where the shaft is, not from the steps emitted
+        g_planner->setPosition(encoder_position());
+        g_coordinator_moved_last = false;
+        g_position_loop.reset();
+    }
+    g_closed_loop = enable;
+    return true;
+}
+
+bool motor_is_closed_loop(void) {
+    return g_closed_loop;
+}
+
+float motor_get_following_error(void) {
+    return g_position_loop_active ? g_position_loop.getError() : 0.0f;
+}
+
+bool motor_has_position_fault(void) {
+    return g_closed_loop && g_position_loop.isFaulted();
+}
+
+bool motor_is_moving(void) {
+    return g_planner && !g_planner->isComplete();
+}
+
+void motor_stop(void) {
+    if (g_planner) {
+        g_planner->stop();
+    }
+    if (g_closed_loop && g_motor) {
+        // The planner's stop does not reach the motor in closed loop
+        g_motor->stop();
+    }
+    if (g_coordinator) {
+        g_coordinator->stop();
+    }
+}
+
+bool motor_decelerate_to_stop(void) {
+    return g_planner && g_planner->decelerateToStop();
+}
+
+float motor_get_position(void) {
+    if (g_closed_loop) {
+        return encoder_position();
+    }
+    if (g_motor && g_motor->hasStepCounter()) {
+        return static_cast<float>(g_motor->getStepCount());
+    }
+    if (g_coordinator_moved_last && g_coordinator) {
+        return g_coordinator->getPosition(0);
+    }
+    return g_planner ? g_planner->getStatus().current_position : 0.0f;
+}
+
+float motor_get_velocity(void) {
+    return g_planner ? g_planner->getStatus().current_velocity : 0.0f;
+}
+
+void motor_enable(bool enable) {
+    if (g_motor) {
+        g_motor->setEnabled(enable);
+    }
+}
+
+void motor_set_direction(bool forward) {
+    if (g_motor) {
+        g_motor->setDirection(forward);
+    }
+}
+
+void motor_set_speed(float steps_per_second) {
+    if (g_motor) {
+        g_motor->setStepRate(steps_per_second);
+    }
+}
+
+/**
+ * @brief Timer update interrupt dispatch (overrides the weak HAL callback)
+ */
+RAM_CODE void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {
+    if (g_planner && htim == g_planner->getTimer()) {
+        g_loop_timing.onEntry(DWT->CYCCNT);
+        {
+            PROFILE_SCOPE(CONTROL_LOOP);
+            // The loop compares the shaft with where the planner is now,
+            // then feeds forward the velocity it plans for the next tick
+            const float commanded = g_closed_loop ? g_planner->getStatus().commanded_position : 0.0f;
+            const float measured = g_closed_loop ? encoder_position() : 0.0f;
+            g_planner->update();
+            update_position_loop(commanded, measured);
+            if (g_coordinator) {
+                g_coordinator->update();
+            }
+            sample_telemetry();
+            measure_command_latency();
+            post_motion_events();
+        }
+        // Reading the position also folds TIM9 into the step count every
+        // tick, long before its 16 bits wrap
+        const MotionPlanner::Status status = g_planner->getStatus();
+        g_loop_timing.onExit(DWT->CYCCNT, status.phase | (status.queue_depth << 8));
+    } else if (g_step_engine && htim == g_step_engine->getTimer()) {
+        // TIM2 update DMA transfer complete (circular burst table)
+        g_step_engine->onTransferComplete();
+    }
+}
+
+/**
+ * @brief Update DMA half-transfer dispatch (overrides the weak HAL callback)
+ */
+void HAL_TIM_PeriodElapsedHalfCpltCallback(TIM_HandleTypeDef* htim) {
+    if (g_step_engine && htim == g_step_engine->getTimer()) {
+        g_step_engine->onHalfTransfer();
+    }
 }
 
 } // extern "C"
\ No newline at end of file
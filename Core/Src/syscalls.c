@@ -81,6 +81,7 @@ __attribute__((weak)) int _read(int file, char *ptr, int len)
 // Add UART handle extern declaration for printf redirect
 extern UART_HandleTypeDef huart2;
 
+// Blocking fallback, overridden by the DMA log sink (UartLogSink.cpp)
 __attribute__((weak)) int _write(int file, char *ptr, int len)
 {
   (void)file;
@@ -0,0 +1,45 @@
+# Lists the functions linked into .ram_text (RAM_CODE, copied to SRAM at
+# startup) with their sizes, and writes the list next to the map file.
+#
+# cmake -DOBJDUMP=<objdump> -DELF=<firmware.elf> -DREPORT=<report.txt> -P ram_text_report.cmake
+
+execute_process(
+    COMMAND ${OBJDUMP} -t -C ${ELF}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${OBJDUMP} -t failed on ${ELF}")
+endif()
+
+# "20000040 g     F .ram_text	000000a4 MotionPlanner::update()"
+string(REGEX MATCHALL "[0-9a-f]+ [^\n]* F \\.ram_text\t[0-9a-f]+ [^\n]*" functions "${symbols}")
+
+set(rows "")
+set(total 0)
+set(count 0)
+foreach(entry IN LISTS functions)
+    string(REGEX REPLACE "^([0-9a-f]+) .*\t([0-9a-f]+) (.*)$" "\\1;\\2;\\3" fields "${entry}")
+    list(GET fields 0 address)
+    list(GET fields 1 size)
+    list(GET fields 2 name)
+    string(STRIP "${name}" name)
+    math(EXPR bytes "0x${size}")
+    math(EXPR total "${total} + ${bytes}")
+    math(EXPR count "${count} + 1")
+    string(LENGTH "${bytes}" width)
+    string(REPEAT " " 6 pad)
+    math(EXPR width "6 - ${width}")
+    if(width GREATER 0)
+        string(SUBSTRING "${pad}" 0 ${width} pad)
+    else()
+        set(pad "")
+    endif()
+    list(APPEND rows "  0x${address} ${pad}${bytes}  ${name}")
+endforeach()
+
+list(SORT rows)
+list(JOIN rows "\n" lines)
+set(report "RAM code (.ram_text): ${total} bytes in ${count} functions\n${lines}\n")
+file(WRITE ${REPORT} "${report}")
+message("${report}")
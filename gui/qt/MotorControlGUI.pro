@@ -19,18 +19,23 @@ QMAKE_CXXFLAGS += -Wno-deprecated-declarations
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Wire protocol shared with the firmware
+INCLUDEPATH += ../../Core/Inc/modules
+
 SOURCES += \
     main.cpp \
     mainwindow.cpp \
     # qcustomplot.cpp (pre-compiled as library)
     serialcomm.cpp \
-    mockdatagenerator.cpp
+    mockdatagenerator.cpp \
+    ../../Core/Src/modules/comm/TelemetryProtocol.cpp
 
 HEADERS += \
     mainwindow.h \
     qcustomplot.h \
     serialcomm.h \
-    mockdatagenerator.h
+    mockdatagenerator.h \
+    ../../Core/Inc/modules/comm/TelemetryProtocol.hpp
 
 # Pre-compiled QCustomPlot library (safe mode)
 LIBS += -L$$PWD/qcustomplot_obj -lqcustomplot
@@ -32,6 +32,9 @@ MainWindow::MainWindow(QWidget *parent)
     // Setup serial communication
     serial = new SerialComm(this);
     connect(serial, &SerialComm::dataReceived, this, &MainWindow::onSerialDataReceived);
+    connect(serial, &SerialComm::telemetryReceived, this, &MainWindow::onTelemetryReceived);
+    connect(serial, &SerialComm::ackReceived, this, &MainWindow::onAckReceived);
+    connect(serial, &SerialComm::loopTimingReceived, this, &MainWindow::onLoopTimingReceived);
     
     // Setup mock data generator
     mockGen = new MockDataGenerator(this);
@@ -201,8 +204,8 @@ void MainWindow::generateMockData()
     // Add to live data
     liveData.append(point);
     
-    // Limit data size (keep last 20 seconds at 20 Hz = 400 points)
-    if (liveData.size() > 400) {
+    // Limit data size
+    if (liveData.size() > MAX_LIVE_POINTS) {
         liveData.removeFirst();
     }
     
@@ -227,7 +230,7 @@ void MainWindow::on_connectButton_clicked()
         ui->statusBar->showMessage("Connected", 3000);
         
         // Send version check
-        sendCommand("GET_VERSION");
+        sendCommand(TelemetryProtocol::CommandOpcode::GET_VERSION, {}, "GET_VERSION");
     } else {
         QMessageBox::warning(this, "Connection Error", 
                            "Failed to connect to " + port + 
@@ -276,7 +279,8 @@ void MainWindow::on_planMotionButton_clicked()
                     .arg(motionParams.max_velocity)
                     .arg(motionParams.acceleration);
     
-    sendCommand(cmd);
+    sendCommand(TelemetryProtocol::CommandOpcode::MOVE,
+                {motionParams.steps, motionParams.max_velocity, motionParams.acceleration}, cmd);
     
     // If using mock data, update mock generator
     if (useMockData) {
@@ -292,7 +296,7 @@ void MainWindow::on_planMotionButton_clicked()
  */
 void MainWindow::on_startButton_clicked()
 {
-    sendCommand("START");
+    sendCommand(TelemetryProtocol::CommandOpcode::START, {}, "START");
     
     if (useMockData) {
         mockGen->start();
@@ -306,7 +310,7 @@ void MainWindow::on_startButton_clicked()
  */
 void MainWindow::on_stopButton_clicked()
 {
-    sendCommand("STOP");
+    sendCommand(TelemetryProtocol::CommandOpcode::STOP, {}, "STOP");
     
     if (useMockData) {
         mockGen->stop();
@@ -320,7 +324,7 @@ void MainWindow::on_stopButton_clicked()
  */
 void MainWindow::on_estopButton_clicked()
 {
-    sendCommand("ESTOP");
+    sendCommand(TelemetryProtocol::CommandOpcode::ESTOP, {}, "ESTOP");
     
     if (useMockData) {
         mockGen->stop();
@@ -334,7 +338,7 @@ void MainWindow::on_estopButton_clicked()
  */
 void MainWindow::on_homeButton_clicked()
 {
-    sendCommand("HOME");
+    sendCommand(TelemetryProtocol::CommandOpcode::HOME, {}, "HOME");
     logMessage("Homing sequence started");
 }
 
@@ -349,11 +353,10 @@ void MainWindow::on_applyGainsButton_clicked()
     pidGains.kd = ui->kdSpinBox->value();
     pidGains.kf = ui->kfSpinBox->value();
     
-    // Send commands
-    sendCommand(QString("SET_P %1").arg(pidGains.kp));
-    sendCommand(QString("SET_I %1").arg(pidGains.ki));
-    sendCommand(QString("SET_D %1").arg(pidGains.kd));
-    sendCommand(QString("SET_F %1").arg(pidGains.kf));
+    // Send all four gains in one command
+    sendCommand(TelemetryProtocol::CommandOpcode::SET_GAINS,
+                {pidGains.kp, pidGains.ki, pidGains.kd, pidGains.kf},
+                QString("SET_GAINS %1 %2 %3 %4").arg(pidGains.kp).arg(pidGains.ki).arg(pidGains.kd).arg(pidGains.kf));
     
     logMessage(QString("PID gains updated: Kp=%1 Ki=%2 Kd=%3 Kf=%4")
               .arg(pidGains.kp).arg(pidGains.ki).arg(pidGains.kd).arg(pidGains.kf));
@@ -404,16 +407,19 @@ void MainWindow::on_loadRunButton_clicked()
 }
 
 /**
- * @brief Send command to serial port
- * @param cmd Command string
+ * @brief Send binary command frame to serial port
+ * @param opcode Command
+ * @param args Command arguments
+ * @param text Readable form for the console
  */
-void MainWindow::sendCommand(const QString &cmd)
+void MainWindow::sendCommand(TelemetryProtocol::CommandOpcode opcode, const QVector<float> &args, const QString &text)
 {
     if (isConnected) {
-        serial->sendCommand(cmd);
+        const quint8 sequence = serial->sendCommand(opcode, args);
+        logMessage(QString("> %1 (#%2)").arg(text).arg(sequence));
+    } else {
+        logMessage("> " + text);
     }
-    
-    logMessage("> " + cmd);
 }
 
 /**
@@ -431,6 +437,81 @@ void MainWindow::onSerialDataReceived(const QByteArray &data)
     }
 }
 
+/**
+ * @brief Handle a binary telemetry batch
+ * @param samples Samples of one TELEMETRY frame
+ */
+void MainWindow::onTelemetryReceived(const QVector<TelemetryProtocol::Sample> &samples)
+{
+    for (const auto& sample : samples) {
+        TelemetryPoint point;
+        point.time_ms = sample.time_us / 1000.0f;
+        point.target_position = sample.target_position;
+        point.actual_position = sample.actual_position;
+        point.target_velocity = sample.target_velocity;
+        point.actual_velocity = sample.actual_velocity;
+        point.acceleration = 0.0f;
+        point.pid_output = sample.pid_output;
+        
+        // S-curve phases 1-3 accelerate, 4 cruises, 5-7 decelerate
+        if (sample.phase == 0) {
+            point.phase = 0;
+        } else if (sample.phase <= 3) {
+            point.phase = 1;
+        } else if (sample.phase == 4) {
+            point.phase = 2;
+        } else {
+            point.phase = 3;
+        }
+        
+        liveData.append(point);
+    }
+    
+    // Limit data size
+    if (liveData.size() > MAX_LIVE_POINTS) {
+        liveData.remove(0, liveData.size() - MAX_LIVE_POINTS);
+    }
+    
+    // One replot per batch
+    updatePlots();
+}
+
+/**
+ * @brief Log command acknowledgement
+ * @param ack Decoded ACK frame
+ */
+void MainWindow::onAckReceived(const TelemetryProtocol::Ack &ack)
+{
+    QString status = "OK";
+    switch (ack.status) {
+        case TelemetryProtocol::AckStatus::OK: break;
+        case TelemetryProtocol::AckStatus::REJECTED: status = "REJECTED"; break;
+        case TelemetryProtocol::AckStatus::UNKNOWN: status = "UNKNOWN"; break;
+        case TelemetryProtocol::AckStatus::BAD_ARGS: status = "BAD_ARGS"; break;
+    }
+    logMessage(QString("< ACK #%1 opcode %2: %3 (%4)")
+              .arg(ack.sequence).arg(static_cast<int>(ack.opcode)).arg(status).arg(ack.value));
+}
+
+/**
+ * @brief Track control loop jitter and log new deadline misses
+ * @param timing Decoded LOOP_TIMING frame
+ */
+void MainWindow::onLoopTimingReceived(const TelemetryProtocol::LoopTiming &timing)
+{
+    const double usPerCycle = (timing.clock_hz > 0) ? 1e6 / timing.clock_hz : 0.0;
+    if (timing.misses > loopTiming.misses || timing.lost_ticks > loopTiming.lost_ticks) {
+        logMessage(QString("Control loop: %1 deadline misses, %2 lost ticks; worst %3 us late at iteration %4 "
+                           "(ran %5 us, phase %6, %7 queued)")
+                  .arg(timing.misses).arg(timing.lost_ticks)
+                  .arg(timing.worst_lateness * usPerCycle, 0, 'f', 1).arg(timing.worst_iteration)
+                  .arg(timing.worst_duration * usPerCycle, 0, 'f', 1)
+                  .arg(timing.worst_context & 0xFF).arg((timing.worst_context >> 8) & 0xFF));
+    }
+    loopTiming = timing;
+    updateStatusBar();
+}
+
 /**
  * @brief Parse telemetry data
  * @param line Telemetry line from STM32
@@ -455,7 +536,7 @@ void MainWindow::parseTelemetry(const QString &line)
     liveData.append(point);
     
     // Limit data size
-    if (liveData.size() > 400) {
+    if (liveData.size() > MAX_LIVE_POINTS) {
         liveData.removeFirst();
     }
     
@@ -481,7 +562,15 @@ void MainWindow::updateStatusBar()
     QString status = isConnected ? "Connected" : "Disconnected (Mock Data)";
     QString mode = useMockData ? " | Mock Mode" : " | Live Mode";
     QString dataPoints = " | Data: " + QString::number(liveData.size()) + " points";
+    QString loop;
+    if (loopTiming.iterations > 0 && loopTiming.clock_hz > 0) {
+        const double usPerCycle = 1e6 / loopTiming.clock_hz;
+        loop = QString(" | Loop jitter %1/+%2 us, %3 misses")
+                   .arg(loopTiming.jitter_min * usPerCycle, 0, 'f', 1)
+                   .arg(loopTiming.jitter_max * usPerCycle, 0, 'f', 1)
+                   .arg(loopTiming.misses);
+    }
     
-    ui->statusBar->showMessage(status + mode + dataPoints);
+    ui->statusBar->showMessage(status + mode + dataPoints + loop);
 }
 
@@ -94,6 +94,9 @@ private slots:
     // Internal slots
     void updatePlots();
     void onSerialDataReceived(const QByteArray &data);
+    void onTelemetryReceived(const QVector<TelemetryProtocol::Sample> &samples);
+    void onAckReceived(const TelemetryProtocol::Ack &ack);
+    void onLoopTimingReceived(const TelemetryProtocol::LoopTiming &timing);
     void generateMockData();
 
 private:
@@ -115,15 +118,19 @@ private:
     bool isRecording;
     bool useMockData;
     
-    // Data storage
+    // Data storage (10 s of binary telemetry at 1000 Hz)
+    static constexpr int MAX_LIVE_POINTS = 10000;
     QVector<TelemetryPoint> liveData;
     
+    // Latest control loop jitter/deadline report
+    TelemetryProtocol::LoopTiming loopTiming = {};
+    
     // Parameters
     PIDGains pidGains;
     MotionParams motionParams;
     
     // Helper functions
-    void sendCommand(const QString &cmd);
+    void sendCommand(TelemetryProtocol::CommandOpcode opcode, const QVector<float> &args, const QString &text);
     void parseTelemetry(const QString &line);
     void logMessage(const QString &msg);
     void updateStatusBar();
@@ -16,6 +16,8 @@ SerialComm::SerialComm(QObject *parent)
     , serial(nullptr)
 #endif
     , m_isConnected(false)
+    , m_inFrame(false)
+    , m_sequence(0)
 {
 #ifdef QT_SERIALPORT_LIB
     connect(serial, &QSerialPort::readyRead, this, &SerialComm::onReadyRead);
@@ -79,6 +81,7 @@ void SerialComm::disconnect()
 #endif
     m_isConnected = false;
     buffer.clear();
+    m_inFrame = false;
     emit disconnected();
 }
 
@@ -110,6 +113,32 @@ void SerialComm::sendCommand(const QString &cmd)
 #endif
 }
 
+/**
+ * @brief Send binary command frame
+ * @param opcode Command
+ * @param args Arguments (up to TelemetryProtocol::MAX_COMMAND_ARGS)
+ * @return Sequence number the ACK will echo
+ */
+quint8 SerialComm::sendCommand(TelemetryProtocol::CommandOpcode opcode, const QVector<float> &args)
+{
+    TelemetryProtocol::Command command{};
+    command.sequence = m_sequence++;
+    command.opcode = opcode;
+    command.arg_count = static_cast<uint8_t>(qMin<int>(args.size(), TelemetryProtocol::MAX_COMMAND_ARGS));
+    for (int i = 0; i < command.arg_count; ++i) {
+        command.args[i] = args[i];
+    }
+    
+#ifdef QT_SERIALPORT_LIB
+    if (isConnected()) {
+        uint8_t frame[TelemetryProtocol::MAX_FRAME];
+        const size_t length = TelemetryProtocol::encodeCommand(command, frame, sizeof(frame));
+        serial->write(reinterpret_cast<const char *>(frame), static_cast<qint64>(length));
+    }
+#endif
+    return command.sequence;
+}
+
 /**
  * @brief Handle incoming data
  */
@@ -117,12 +146,60 @@ void SerialComm::onReadyRead()
 {
 #ifdef QT_SERIALPORT_LIB
     buffer.append(serial->readAll());
+    processBuffer();
+#endif
+}
+
+/**
+ * @brief Split buffered bytes into frames and text lines
+ *
+ * Every 0x00 opens a frame candidate. If the bytes up to the next 0x00
+ * decode, they were a frame and the delimiter closed it; otherwise they are
+ * text and that delimiter opens the next candidate.
+ */
+void SerialComm::processBuffer()
+{
+    int delimiter;
+    while ((delimiter = buffer.indexOf('\0')) != -1) {
+        QByteArray chunk = buffer.left(delimiter);
+        buffer.remove(0, delimiter + 1);
+        
+        if (!m_inFrame) {
+            emitLines(chunk, true);
+            m_inFrame = true;
+        } else if (!chunk.isEmpty()) {
+            if (handleFrame(chunk)) {
+                m_inFrame = false;
+            } else {
+                emitLines(chunk, true);
+            }
+        }
+    }
     
+    if (!m_inFrame) {
+        emitLines(buffer, false);
+    } else if (buffer.size() > static_cast<int>(TelemetryProtocol::MAX_FRAME)) {
+        // Too long for a frame - resynchronise on the next delimiter
+        m_inFrame = false;
+        emitLines(buffer, false);
+    }
+}
+
+/**
+ * @brief Emit complete lines and remove them from text
+ * @param text Text bytes
+ * @param flush Also emit a trailing partial line
+ */
+void SerialComm::emitLines(QByteArray &text, bool flush)
+{
     // Process complete lines (terminated with \n)
     int newlineIndex;
-    while ((newlineIndex = buffer.indexOf('\n')) != -1) {
-        QByteArray line = buffer.left(newlineIndex);
-        buffer.remove(0, newlineIndex + 1);
+    while ((newlineIndex = text.indexOf('\n')) != -1 || (flush && !text.isEmpty())) {
+        if (newlineIndex == -1) {
+            newlineIndex = text.size();
+        }
+        QByteArray line = text.left(newlineIndex);
+        text.remove(0, newlineIndex + 1);
         
         // Remove carriage return if present
         if (line.endsWith('\r')) {
@@ -133,7 +210,50 @@ void SerialComm::onReadyRead()
             emit dataReceived(line);
         }
     }
-#endif
+}
+
+/**
+ * @brief Decode one frame candidate
+ * @param encoded Bytes between delimiters
+ * @return True if it was a valid frame
+ */
+bool SerialComm::handleFrame(const QByteArray &encoded)
+{
+    uint8_t payload[TelemetryProtocol::MAX_PAYLOAD + 2];
+    const size_t length = TelemetryProtocol::decodeFrame(reinterpret_cast<const uint8_t *>(encoded.constData()),
+                                                         static_cast<size_t>(encoded.size()),
+                                                         payload, sizeof(payload));
+    if (length == 0) return false;
+    
+    switch (TelemetryProtocol::getType(payload)) {
+        case TelemetryProtocol::MessageType::TELEMETRY: {
+            QVector<TelemetryProtocol::Sample> samples(TelemetryProtocol::MAX_BATCH_SAMPLES);
+            const uint32_t count = TelemetryProtocol::decodeTelemetry(payload, length, samples.data(),
+                                                                      TelemetryProtocol::MAX_BATCH_SAMPLES);
+            samples.resize(static_cast<int>(count));
+            if (count > 0) {
+                emit telemetryReceived(samples);
+            }
+            break;
+        }
+        case TelemetryProtocol::MessageType::ACK: {
+            TelemetryProtocol::Ack ack;
+            if (TelemetryProtocol::decodeAck(payload, length, ack)) {
+                emit ackReceived(ack);
+            }
+            break;
+        }
+        case TelemetryProtocol::MessageType::LOOP_TIMING: {
+            TelemetryProtocol::LoopTiming timing;
+            if (TelemetryProtocol::decodeLoopTiming(payload, length, timing)) {
+                emit loopTimingReceived(timing);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return true;
 }
 
 #ifdef QT_SERIALPORT_LIB
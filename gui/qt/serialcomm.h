@@ -3,6 +3,8 @@
  * @brief Serial Communication Class
  * 
  * Handles serial port communication with STM32.
+ * Binary frames (comm/TelemetryProtocol.hpp) and console text share the
+ * port; frames are delimited by 0x00, which text never contains.
  */
 
 #ifndef SERIALCOMM_H
@@ -10,6 +12,8 @@
 
 #include <QObject>
 #include <QByteArray>
+#include <QVector>
+#include "comm/TelemetryProtocol.hpp"
 
 // Temporarily disable serial port if module not installed
 #ifdef QT_SERIALPORT_LIB
@@ -34,9 +38,13 @@ public:
     bool isConnected() const;
     
     void sendCommand(const QString &cmd);
+    quint8 sendCommand(TelemetryProtocol::CommandOpcode opcode, const QVector<float> &args = {});
 
 signals:
     void dataReceived(const QByteArray &data);
+    void telemetryReceived(const QVector<TelemetryProtocol::Sample> &samples);
+    void ackReceived(const TelemetryProtocol::Ack &ack);
+    void loopTimingReceived(const TelemetryProtocol::LoopTiming &timing);
     void connected();
     void disconnected();
     void error(const QString &errorMsg);
@@ -55,6 +63,12 @@ private:
 #endif
     QByteArray buffer;
     bool m_isConnected;
+    bool m_inFrame;         ///< Bytes since the last 0x00 may be a frame
+    quint8 m_sequence;      ///< Sequence of the next command frame
+    
+    void processBuffer();
+    void emitLines(QByteArray &text, bool flush);
+    bool handleFrame(const QByteArray &encoded);
 };
 
 #endif // SERIALCOMM_H
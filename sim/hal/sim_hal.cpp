@@ -0,0 +1,1374 @@
+/**
+ * @file sim_hal.cpp
+ * @brief Host implementation of the HAL subset used by the motor stack
+ *
+ * The timer model is event driven: the virtual clock jumps straight to the
+ * next counter overflow or SysTick instead of ticking cycle by cycle, so a
+ * 20 kHz step output costs a few hundred nanoseconds of host time per pulse.
+ *
+ * Modelled behaviour:
+ *  - PSC is always buffered; ARR is buffered when CR1.ARPE is set and CCRx
+ *    when CCMRx.OCxPE is set. Buffered values load on overflow or EGR.UG,
+ *    unless CR1.UDIS is set.
+ *  - PWM mode 1 outputs: a rising edge is counted whenever a channel goes
+ *    high, and a truncated pulse when a channel is stopped while high.
+ *    Edge times of one channel can be recorded (SimHal_TimerEdgeCaptureStart).
+ *  - UIF/UIE raise the timer's IRQ line, dispatched through the handlers
+ *    registered with SimHal_SetIrqHandler().
+ *  - Trigger slave mode: a slave whose ITRx master has MMS = enable starts
+ *    counting when the master's CEN goes high (F411 ITR routing). With
+ *    MMS = OC1REF it starts on a rising OC1REF edge instead.
+ *  - External clock mode 1 slaves count rising OC1REF edges of their ITRx
+ *    master and do not run on the timer clock. OC1REF edges are seen at
+ *    update events (overflow or UG), where PWM mode 1 pulses begin.
+ *  - Encoder mode: the counter does not run on the timer clock; it counts
+ *    the edges of a simulated shaft turned by the pulses of one step output
+ *    (SimHal_EncoderAttach), up or down with the DIR pin level, and wraps at
+ *    ARR with an update event. Steps can be lost (SimHal_EncoderSlip).
+ *  - Update DMA bursts (DCR/DMAR, HAL_TIM_DMABurst_MultiWriteStart) write
+ *    the preload registers at each update event; the stream's half and
+ *    complete interrupts go through HAL_DMA_IRQHandler().
+ *  - UART TX DMA (USART2 only): HAL_UART_Transmit_DMA() completes one frame
+ *    time per byte later (8N1 at Init.BaudRate) and raises USART2_IRQn;
+ *    HAL_UART_IRQHandler() then calls HAL_UART_TxCpltCallback(). Sent bytes
+ *    go to stdout or to the UART capture buffer.
+ *  - UART RX to-idle DMA (USART2 only): bytes queued with SimHal_UartInject()
+ *    arrive one frame time apart and are written at the DMA position
+ *    (circular or normal mode). Half buffer, full buffer and idle line (one
+ *    frame time without data) report the position through USART2_IRQn and
+ *    HAL_UARTEx_RxEventCallback(); on the target the half/full events come
+ *    through the RX DMA stream interrupt instead.
+ *  - DWT CYCCNT counts core cycles while DWT_CTRL.CYCCNTENA is set.
+ *  - PRIMASK (__disable_irq() etc.) is a flag: interrupts only fire inside
+ *    clock advances, and advancing with interrupts masked aborts.
+ *  - Direct BSRR, EGR and CCER.CCxE writes are picked up lazily at the next
+ *    HAL call, clock advance or __DSB() (the model cannot trap plain stores). A
+ *    software UG therefore never raises UIF; a channel enabled by a store
+ *    counts its first rising edge at that point, and of several BSRR
+ *    stores to one port in between only the last takes effect.
+ */
+
+#include <stm32f4xx_hal.h>  /* Via the include path, so #include_next reaches the real HAL */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+/* Register models ----------------------------------------------------------*/
+GPIO_TypeDef SimHal_GPIOA;
+GPIO_TypeDef SimHal_GPIOB;
+GPIO_TypeDef SimHal_GPIOC;
+GPIO_TypeDef SimHal_GPIOH;
+
+TIM_TypeDef SimHal_TIM1;
+TIM_TypeDef SimHal_TIM2;
+TIM_TypeDef SimHal_TIM3;
+TIM_TypeDef SimHal_TIM4;
+TIM_TypeDef SimHal_TIM5;
+TIM_TypeDef SimHal_TIM9;
+TIM_TypeDef SimHal_TIM10;
+TIM_TypeDef SimHal_TIM11;
+
+RCC_TypeDef SimHal_RCC;
+
+// Plain words: the CMSIS structs have read-only (const) members
+uint32_t SimHal_DWT[sizeof(DWT_Type) / sizeof(uint32_t)];
+uint32_t SimHal_CoreDebug[sizeof(CoreDebug_Type) / sizeof(uint32_t)];
+
+/* HAL globals normally provided by stm32f4xx_hal.c / system_stm32f4xx.c */
+__IO uint32_t uwTick;
+uint32_t uwTickPrio = (1UL << __NVIC_PRIO_BITS);
+HAL_TickFreqTypeDef uwTickFreq = HAL_TICK_FREQ_DEFAULT;
+uint32_t SystemCoreClock = SIM_SYSCLK_HZ;
+
+namespace {
+
+constexpr uint64_t kCyclesPerMs = SIM_SYSCLK_HZ / 1000U;
+constexpr uint32_t kChannels = 4;
+constexpr size_t kMaxGpioEvents = 1U << 20;
+constexpr int kMaxIrq = 128;
+
+struct TimerModel {
+    TIM_TypeDef* regs;
+    IRQn_Type irqn;
+    uint32_t counter_max;       // 0xFFFF or 0xFFFFFFFF (TIM2/TIM5)
+    uint32_t psc_active = 0;
+    uint32_t arr_shadow = 0;
+    uint32_t ccr_shadow[kChannels]{};
+    uint32_t prescale_count = 0;  // Timer clocks since the last counter tick
+    uint64_t pulses[kChannels]{};
+    uint64_t truncated[kChannels]{};
+    uint64_t updates = 0;
+    bool ref_high = false;      // OC1REF as last evaluated (TRGO = OC1REF edges)
+    bool was_enabled = false;   // CEN as last seen, to detect counter starts
+    uint64_t start_cycle = 0;   // Virtual time CEN last went high
+    uint32_t ccer_seen = 0;     // CCxE bits as last seen, to detect channel starts/stops
+    // Update DMA burst (TIMx_DCR/DMAR)
+    DMA_HandleTypeDef* burst_dma = nullptr;
+    const uint32_t* burst_buffer = nullptr;
+    uint32_t burst_length = 0;  // Words in the buffer
+    uint32_t burst_pos = 0;
+    bool burst_active = false;
+    bool burst_half_pending = false;
+    bool burst_complete_pending = false;
+};
+
+TimerModel g_timers[] = {
+    { &SimHal_TIM1,  TIM1_UP_TIM10_IRQn,      0xFFFFU },
+    { &SimHal_TIM2,  TIM2_IRQn,               0xFFFFFFFFU },
+    { &SimHal_TIM3,  TIM3_IRQn,               0xFFFFU },
+    { &SimHal_TIM4,  TIM4_IRQn,               0xFFFFU },
+    { &SimHal_TIM5,  TIM5_IRQn,               0xFFFFFFFFU },
+    { &SimHal_TIM9,  TIM1_BRK_TIM9_IRQn,      0xFFFFU },
+    { &SimHal_TIM10, TIM1_UP_TIM10_IRQn,      0xFFFFU },
+    { &SimHal_TIM11, TIM1_TRG_COM_TIM11_IRQn, 0xFFFFU },
+};
+constexpr size_t kTimerCount = sizeof(g_timers) / sizeof(g_timers[0]);
+
+GPIO_TypeDef* const g_ports[] = { &SimHal_GPIOA, &SimHal_GPIOB, &SimHal_GPIOC, &SimHal_GPIOH };
+
+uint64_t g_cycles = 0;
+uint64_t g_next_tick = kCyclesPerMs;
+bool g_in_irq = false;
+
+bool g_irq_enabled[kMaxIrq];
+void (*g_irq_handler[kMaxIrq])(void);
+
+bool g_capture_enabled = false;
+std::vector<SimHal_GpioEvent> g_capture;
+
+// Rising edge times of one PWM channel (SimHal_TimerEdgeCaptureStart)
+const TIM_TypeDef* g_edge_timer = nullptr;
+uint32_t g_edge_channel = 0;
+std::vector<uint64_t> g_edges;
+
+uint32_t g_primask = 0;
+
+struct UartModel {
+    UART_HandleTypeDef* tx_huart;   // Transfer in flight (nullptr = idle)
+    const uint8_t* tx_data;
+    uint16_t tx_size;
+    uint64_t tx_done_cycle;
+    bool tx_complete_pending;
+    uint64_t tx_bytes;
+    bool capture_enabled;
+    std::vector<uint8_t> capture;
+    UART_HandleTypeDef* rx_huart;   // Reception running (nullptr = off)
+    uint32_t rx_baud = 115200;      // Line rate, from the last reception started
+    uint8_t* rx_buffer;
+    uint16_t rx_size;
+    uint16_t rx_pos;                // DMA write position
+    std::deque<uint8_t> rx_line;    // Injected bytes still on the wire
+    uint64_t rx_next_cycle = UINT64_MAX;  // Next byte or idle detection (UINT64_MAX = none)
+    bool rx_idle_armed;             // Idle line detection follows the last byte
+    std::vector<uint16_t> rx_events;  // Positions waiting for HAL_UART_IRQHandler()
+};
+
+UartModel g_uart;
+
+// Motor shaft turned by a step output, read by a timer in encoder mode
+// (SimHal_EncoderAttach)
+struct EncoderModel {
+    TimerModel* timer;          // nullptr = no encoder attached
+    const TIM_TypeDef* step_timer;
+    uint32_t step_channel;
+    GPIO_TypeDef* dir_port;
+    uint16_t dir_pin;           // High = forward = counting up
+    double counts_per_step;
+    double position;            // Shaft angle in encoder counts
+    uint32_t slip;              // Steps still to be lost
+};
+
+EncoderModel g_encoder;
+
+TimerModel* findTimer(const TIM_TypeDef* regs) {
+    for (auto& t : g_timers) {
+        if (t.regs == regs) {
+            return &t;
+        }
+    }
+    return nullptr;
+}
+
+uint32_t channelIndex(uint32_t channel) {
+    // TIM_CHANNEL_1..4 are 0x0, 0x4, 0x8, 0xC
+    return (channel >> 2) & 0x3U;
+}
+
+volatile uint32_t* ccrRegister(TimerModel& t, uint32_t ch) {
+    return &t.regs->CCR1 + ch;
+}
+
+bool ccrPreloaded(const TimerModel& t, uint32_t ch) {
+    const uint32_t ccmr = (ch < 2) ? t.regs->CCMR1 : t.regs->CCMR2;
+    return (ccmr & ((ch & 1U) ? TIM_CCMR1_OC2PE : TIM_CCMR1_OC1PE)) != 0;
+}
+
+bool channelIsPwm1(const TimerModel& t, uint32_t ch) {
+    const uint32_t ccmr = (ch < 2) ? t.regs->CCMR1 : t.regs->CCMR2;
+    // Input channels (CCxS != 0) use these bits for the capture filter
+    if (((ch & 1U) ? (ccmr & TIM_CCMR1_CC2S) : (ccmr & TIM_CCMR1_CC1S)) != 0) {
+        return false;
+    }
+    const uint32_t mode = (ch & 1U) ? ((ccmr & TIM_CCMR1_OC2M) >> TIM_CCMR1_OC2M_Pos)
+                                    : ((ccmr & TIM_CCMR1_OC1M) >> TIM_CCMR1_OC1M_Pos);
+    return mode == 6U;
+}
+
+bool channelEnabled(const TimerModel& t, uint32_t ch) {
+    return (t.regs->CCER & (TIM_CCER_CC1E << (4U * ch))) != 0;
+}
+
+bool isRunning(const TimerModel& t) {
+    return (t.regs->CR1 & TIM_CR1_CEN) != 0;
+}
+
+/**
+ * @brief Master timer on a slave's internal trigger input (RM0383 ITR table)
+ */
+const TIM_TypeDef* triggerMaster(const TimerModel& t) {
+    static const struct {
+        const TIM_TypeDef* slave;
+        const TIM_TypeDef* itr[4];
+    } kItr[] = {
+        { &SimHal_TIM1, { &SimHal_TIM5, &SimHal_TIM2, &SimHal_TIM3, &SimHal_TIM4 } },
+        { &SimHal_TIM2, { &SimHal_TIM1, nullptr,      &SimHal_TIM3, &SimHal_TIM4 } },
+        { &SimHal_TIM3, { &SimHal_TIM1, &SimHal_TIM2, &SimHal_TIM5, &SimHal_TIM4 } },
+        { &SimHal_TIM4, { &SimHal_TIM1, &SimHal_TIM2, &SimHal_TIM3, nullptr } },
+        { &SimHal_TIM5, { &SimHal_TIM2, &SimHal_TIM3, &SimHal_TIM4, nullptr } },
+        { &SimHal_TIM9, { &SimHal_TIM2, &SimHal_TIM3, &SimHal_TIM10, &SimHal_TIM11 } },
+    };
+    const uint32_t ts = (t.regs->SMCR & TIM_SMCR_TS) >> TIM_SMCR_TS_Pos;
+    if (ts > 3U) {
+        return nullptr;  // TI1F_ED / TI1FP1 / TI2FP2 / ETRF are not modelled
+    }
+    for (const auto& entry : kItr) {
+        if (entry.slave == t.regs) {
+            return entry.itr[ts];
+        }
+    }
+    return nullptr;
+}
+
+uint32_t activeArr(const TimerModel& t) {
+    return (t.regs->CR1 & TIM_CR1_ARPE) ? t.arr_shadow : t.regs->ARR;
+}
+
+uint32_t activeCcr(TimerModel& t, uint32_t ch) {
+    return ccrPreloaded(t, ch) ? t.ccr_shadow[ch] : *ccrRegister(t, ch);
+}
+
+bool outputReference(TimerModel& t, uint32_t ch) {
+    return channelIsPwm1(t, ch) && t.regs->CNT < activeCcr(t, ch);
+}
+
+bool outputHigh(TimerModel& t, uint32_t ch) {
+    return channelEnabled(t, ch) && outputReference(t, ch);
+}
+
+bool encoderMode(const TimerModel& t) {
+    const uint32_t sms = t.regs->SMCR & TIM_SMCR_SMS;
+    return sms == TIM_ENCODERMODE_TI1 || sms == TIM_ENCODERMODE_TI2 || sms == TIM_ENCODERMODE_TI12;
+}
+
+bool externallyClocked(const TimerModel& t) {
+    return (t.regs->SMCR & TIM_SMCR_SMS) == TIM_SLAVEMODE_EXTERNAL1 || encoderMode(t);
+}
+
+void reloadShadows(TimerModel& t) {
+    t.psc_active = t.regs->PSC;
+    t.arr_shadow = t.regs->ARR;
+    for (uint32_t ch = 0; ch < kChannels; ch++) {
+        t.ccr_shadow[ch] = *ccrRegister(t, ch);
+    }
+}
+
+void raiseIrq(IRQn_Type irqn) {
+    if (irqn < 0 || irqn >= kMaxIrq || !g_irq_enabled[irqn] || !g_irq_handler[irqn]) {
+        return;
+    }
+    const bool nested = g_in_irq;
+    g_in_irq = true;
+    g_irq_handler[irqn]();
+    g_in_irq = nested;
+}
+
+IRQn_Type dmaStreamIrq(const DMA_Stream_TypeDef* stream) {
+    static const struct {
+        const DMA_Stream_TypeDef* stream;
+        IRQn_Type irqn;
+    } kStreams[] = {
+        { DMA1_Stream0, DMA1_Stream0_IRQn }, { DMA1_Stream1, DMA1_Stream1_IRQn },
+        { DMA1_Stream2, DMA1_Stream2_IRQn }, { DMA1_Stream3, DMA1_Stream3_IRQn },
+        { DMA1_Stream4, DMA1_Stream4_IRQn }, { DMA1_Stream5, DMA1_Stream5_IRQn },
+        { DMA1_Stream6, DMA1_Stream6_IRQn }, { DMA1_Stream7, DMA1_Stream7_IRQn },
+        { DMA2_Stream0, DMA2_Stream0_IRQn }, { DMA2_Stream1, DMA2_Stream1_IRQn },
+        { DMA2_Stream2, DMA2_Stream2_IRQn }, { DMA2_Stream3, DMA2_Stream3_IRQn },
+        { DMA2_Stream4, DMA2_Stream4_IRQn }, { DMA2_Stream5, DMA2_Stream5_IRQn },
+        { DMA2_Stream6, DMA2_Stream6_IRQn }, { DMA2_Stream7, DMA2_Stream7_IRQn },
+    };
+    for (const auto& entry : kStreams) {
+        if (entry.stream == stream) {
+            return entry.irqn;
+        }
+    }
+    return static_cast<IRQn_Type>(-1);
+}
+
+/**
+ * @brief Update DMA request: one burst of DBL+1 words written from DBA on
+ *
+ * The stream's half/complete interrupts are raised as the buffer position
+ * crosses them; circular streams wrap, normal streams stop.
+ */
+void dmaBurst(TimerModel& t) {
+    const uint32_t base = (t.regs->DCR & TIM_DCR_DBA) >> TIM_DCR_DBA_Pos;
+    const uint32_t count = ((t.regs->DCR & TIM_DCR_DBL) >> TIM_DCR_DBL_Pos) + 1U;
+    volatile uint32_t* words = reinterpret_cast<volatile uint32_t*>(t.regs);
+    bool raise = false;
+
+    for (uint32_t i = 0; i < count && t.burst_active; i++) {
+        words[base + i] = t.burst_buffer[t.burst_pos++];
+        if (t.burst_pos == t.burst_length / 2U) {
+            t.burst_half_pending = true;
+            raise = true;
+        }
+        if (t.burst_pos == t.burst_length) {
+            t.burst_complete_pending = true;
+            raise = true;
+            t.burst_pos = 0;
+            if (t.burst_dma->Init.Mode != DMA_CIRCULAR) {
+                t.burst_active = false;
+            }
+        }
+    }
+
+    if (raise) {
+        raiseIrq(dmaStreamIrq(t.burst_dma->Instance));
+    }
+}
+
+void updateEvent(TimerModel& t, bool from_overflow);
+
+/**
+ * @brief Rising TRGO edge of a master with MMS = OC1REF
+ *
+ * Trigger-mode slaves on it start; external clock mode 1 slaves count one
+ * edge through their prescaler and wrap at ARR with an update event.
+ */
+void triggerOutputEdge(const TimerModel& master) {
+    for (auto& slave : g_timers) {
+        if (triggerMaster(slave) != master.regs) {
+            continue;
+        }
+        const uint32_t sms = slave.regs->SMCR & TIM_SMCR_SMS;
+        if (sms == TIM_SLAVEMODE_TRIGGER && !isRunning(slave)) {
+            slave.regs->CR1 |= TIM_CR1_CEN;
+        } else if (sms == TIM_SLAVEMODE_EXTERNAL1 && isRunning(slave)) {
+            if (slave.prescale_count++ < slave.psc_active) {
+                continue;
+            }
+            slave.prescale_count = 0;
+            if (slave.regs->CNT >= activeArr(slave)) {
+                updateEvent(slave, true);
+            } else {
+                slave.regs->CNT = slave.regs->CNT + 1U;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Update event: counter overflow or software UG
+ *
+ * With CR1.UDIS set the counter still restarts, but the shadow registers
+ * keep their values and no update flag is raised.
+ */
+/**
+ * @brief Encoder edges: count CNT up or down, wrapping at ARR with an update event
+ */
+void encoderCount(int64_t edges) {
+    TimerModel& t = *g_encoder.timer;
+    if (edges == 0 || !isRunning(t) || !encoderMode(t)) {
+        return;  // Counter stopped: the edges are lost
+    }
+    const int64_t period = static_cast<int64_t>(activeArr(t)) + 1;
+    int64_t count = static_cast<int64_t>(t.regs->CNT) + edges;
+    int64_t wraps = count / period;
+    count %= period;
+    if (count < 0) {
+        count += period;
+        wraps--;
+    }
+    t.regs->CNT = static_cast<uint32_t>(count);
+    t.regs->CR1 = (edges < 0) ? (t.regs->CR1 | TIM_CR1_DIR) : (t.regs->CR1 & ~TIM_CR1_DIR);
+    for (int64_t i = 0; i < std::abs(wraps); i++) {
+        t.updates++;
+        t.regs->SR |= TIM_SR_UIF;
+        if (t.regs->DIER & TIM_DIER_UIE) {
+            raiseIrq(t.irqn);
+        }
+    }
+}
+
+/**
+ * @brief Turn the simulated shaft by a number of encoder counts
+ */
+void turnShaft(double counts) {
+    const double before = std::floor(g_encoder.position);
+    g_encoder.position += counts;
+    encoderCount(static_cast<int64_t>(std::floor(g_encoder.position) - before));
+}
+
+/**
+ * @brief Count a rising edge on a channel output (and record its time)
+ *
+ * A step on the output the encoder shaft is attached to turns it one step
+ * in the direction of the DIR pin, unless the motor is slipping.
+ */
+void countPulse(TimerModel& t, uint32_t ch) {
+    t.pulses[ch]++;
+    if (t.regs == g_edge_timer && ch == g_edge_channel && g_edges.size() < kMaxGpioEvents) {
+        g_edges.push_back(g_cycles);
+    }
+    if (g_encoder.timer != nullptr && t.regs == g_encoder.step_timer && ch == g_encoder.step_channel) {
+        if (g_encoder.slip > 0) {
+            g_encoder.slip--;
+        } else {
+            const bool forward = (g_encoder.dir_port->ODR & g_encoder.dir_pin) != 0;
+            turnShaft(forward ? g_encoder.counts_per_step : -g_encoder.counts_per_step);
+        }
+    }
+}
+
+void updateEvent(TimerModel& t, bool from_overflow) {
+    if (from_overflow) {
+        // The counter was not stepped through its last period; it wraps from
+        // ARR (or from its maximum if it was already past ARR)
+        const uint32_t top = activeArr(t);
+        t.regs->CNT = (t.regs->CNT <= top) ? top : t.counter_max;
+    }
+
+    bool was_high[kChannels];
+    for (uint32_t ch = 0; ch < kChannels; ch++) {
+        was_high[ch] = outputHigh(t, ch);
+    }
+    // Compare writes between events are not trapped: OC1REF only stayed
+    // high if it was high at the last event and still is
+    const bool ref_was_high = t.ref_high && outputReference(t, 0);
+
+    const bool disabled = (t.regs->CR1 & TIM_CR1_UDIS) != 0;
+    t.regs->CNT = 0;
+    t.prescale_count = 0;
+    if (disabled) {
+        t.regs->EGR = 0;
+    } else {
+        reloadShadows(t);
+    }
+
+    for (uint32_t ch = 0; ch < kChannels; ch++) {
+        if (isRunning(t) && !was_high[ch] && outputHigh(t, ch)) {
+            countPulse(t, ch);
+        }
+    }
+    t.ref_high = outputReference(t, 0);
+    if (!ref_was_high && t.ref_high && (t.regs->CR2 & TIM_CR2_MMS) == TIM_TRGO_OC1REF) {
+        triggerOutputEdge(t);
+    }
+
+    if (!disabled && t.burst_active && (t.regs->DIER & TIM_DIER_UDE)) {
+        dmaBurst(t);
+    }
+
+    if (from_overflow && !disabled) {
+        t.updates++;
+        t.regs->SR |= TIM_SR_UIF;
+        if (t.regs->DIER & TIM_DIER_UIE) {
+            raiseIrq(t.irqn);
+        }
+    }
+}
+
+/**
+ * @brief Finish the UART transfer in flight and raise its interrupt
+ */
+void uartTxDone() {
+    UART_HandleTypeDef* huart = g_uart.tx_huart;
+    if (g_uart.capture_enabled) {
+        g_uart.capture.insert(g_uart.capture.end(), g_uart.tx_data, g_uart.tx_data + g_uart.tx_size);
+    } else {
+        std::fwrite(g_uart.tx_data, 1, g_uart.tx_size, stdout);
+    }
+    g_uart.tx_bytes += g_uart.tx_size;
+    g_uart.tx_huart = nullptr;
+    g_uart.tx_complete_pending = true;
+    huart->gState = HAL_UART_STATE_READY;
+    raiseIrq(USART2_IRQn);
+}
+
+uint64_t uartRxFrameCycles() {
+    // 8N1: ten bit times per byte
+    return (10U * SIM_SYSCLK_HZ + g_uart.rx_baud - 1) / g_uart.rx_baud;
+}
+
+/**
+ * @brief Receive the next byte on the RX line, or detect the idle line
+ */
+void uartRxEvent() {
+    UART_HandleTypeDef* huart = g_uart.rx_huart;
+    if (g_uart.rx_line.empty()) {
+        // Line idle for a frame after the last byte
+        g_uart.rx_idle_armed = false;
+        g_uart.rx_next_cycle = UINT64_MAX;
+        if (huart != nullptr && g_uart.rx_pos != 0) {
+            g_uart.rx_events.push_back(g_uart.rx_pos);
+            raiseIrq(USART2_IRQn);
+        }
+        return;
+    }
+
+    const uint8_t byte = g_uart.rx_line.front();
+    g_uart.rx_line.pop_front();
+    g_uart.rx_next_cycle += uartRxFrameCycles();
+    g_uart.rx_idle_armed = g_uart.rx_line.empty();
+    if (huart == nullptr) {
+        return;  // Lost: nothing is receiving
+    }
+
+    g_uart.rx_buffer[g_uart.rx_pos++] = byte;
+    bool event = false;
+    if (g_uart.rx_pos == g_uart.rx_size / 2U) {
+        g_uart.rx_events.push_back(g_uart.rx_pos);
+        event = true;
+    }
+    if (g_uart.rx_pos == g_uart.rx_size) {
+        g_uart.rx_events.push_back(g_uart.rx_pos);
+        g_uart.rx_pos = 0;
+        event = true;
+        if (huart->hdmarx->Init.Mode != DMA_CIRCULAR) {
+            g_uart.rx_huart = nullptr;
+            huart->RxState = HAL_UART_STATE_READY;
+        }
+    }
+    if (event) {
+        raiseIrq(USART2_IRQn);
+    }
+}
+
+void recordGpio(GPIO_TypeDef* port, uint16_t pin, uint8_t state) {
+    if (g_capture_enabled && g_capture.size() < kMaxGpioEvents) {
+        g_capture.push_back(SimHal_GpioEvent{ g_cycles, port, pin, state });
+    }
+}
+
+/**
+ * @brief Counter enable edges: record start times and fire trigger-mode slaves
+ *
+ * A master with MMS = enable drives TRGO with its CEN bit, so each slave in
+ * trigger mode on it sets its own CEN on the same clock (and may cascade).
+ */
+void processCounterStarts() {
+    bool started = true;
+    while (started) {
+        started = false;
+        for (auto& master : g_timers) {
+            const bool enabled = isRunning(master);
+            if (!enabled || master.was_enabled) {
+                master.was_enabled = enabled;
+                continue;
+            }
+            master.was_enabled = true;
+            master.start_cycle = g_cycles;
+            if ((master.regs->CR2 & TIM_CR2_MMS) != TIM_TRGO_ENABLE) {
+                continue;
+            }
+            for (auto& slave : g_timers) {
+                if (!isRunning(slave) && (slave.regs->SMCR & TIM_SMCR_SMS) == TIM_SLAVEMODE_TRIGGER &&
+                    triggerMaster(slave) == master.regs) {
+                    slave.regs->CR1 |= TIM_CR1_CEN;
+                    started = true;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Channel enables stored straight to CCER since they were last seen
+ *
+ * Evaluated against the shadow registers before any pending UG, like a
+ * store that reached the timer ahead of the UG written after it.
+ */
+void processChannelEnables(TimerModel& t) {
+    for (uint32_t ch = 0; ch < kChannels; ch++) {
+        const uint32_t bit = TIM_CCER_CC1E << (4U * ch);
+        const uint32_t enabled = t.regs->CCER & bit;
+        if (enabled == (t.ccer_seen & bit)) {
+            continue;
+        }
+        t.ccer_seen ^= bit;
+        if (enabled && outputReference(t, ch)) {
+            countPulse(t, ch);
+        } else if (!enabled && isRunning(t) && outputReference(t, ch)) {
+            t.truncated[ch]++;
+        }
+    }
+}
+
+/**
+ * @brief Apply register writes the model could not trap (EGR, BSRR, CCER, CR1.CEN)
+ */
+void processSoftwareEvents() {
+    for (auto& t : g_timers) {
+        processChannelEnables(t);
+        if (t.regs->EGR & TIM_EGR_UG) {
+            t.regs->EGR = 0;
+            updateEvent(t, false);
+        }
+    }
+    processCounterStarts();
+
+    for (auto* port : g_ports) {
+        const uint32_t bsrr = port->BSRR;
+        if (bsrr == 0) {
+            continue;
+        }
+        port->BSRR = 0;
+        const uint16_t set = static_cast<uint16_t>(bsrr & 0xFFFFU);
+        const uint16_t reset = static_cast<uint16_t>((bsrr >> 16) & ~set);
+        port->ODR = (port->ODR | set) & ~static_cast<uint32_t>(reset);
+        port->IDR = port->ODR;
+        if (set) {
+            recordGpio(port, set, GPIO_PIN_SET);
+        }
+        if (reset) {
+            recordGpio(port, reset, GPIO_PIN_RESET);
+        }
+    }
+}
+
+uint64_t cyclesToOverflow(const TimerModel& t) {
+    const uint64_t div = static_cast<uint64_t>(t.psc_active) + 1U;
+    const uint32_t top = activeArr(t);
+    const uint32_t cnt = t.regs->CNT;
+    // Counter above ARR (ARR lowered with ARPE=0) runs on to its maximum
+    const uint64_t counts = (cnt <= top) ? (top - cnt) : (t.counter_max - cnt);
+    return counts * div + (div - t.prescale_count);
+}
+
+void advanceCounter(TimerModel& t, uint64_t cycles) {
+    const uint64_t div = static_cast<uint64_t>(t.psc_active) + 1U;
+    const uint64_t total = t.prescale_count + cycles;
+    t.regs->CNT = static_cast<uint32_t>(t.regs->CNT + total / div);
+    t.prescale_count = static_cast<uint32_t>(total % div);
+}
+
+void stopChannel(TimerModel& t, uint32_t ch) {
+    if (isRunning(t) && outputHigh(t, ch)) {
+        t.truncated[ch]++;
+    }
+    t.regs->CCER &= ~(TIM_CCER_CC1E << (4U * ch));
+    t.ccer_seen &= ~(TIM_CCER_CC1E << (4U * ch));
+}
+
+void startChannel(TimerModel& t, uint32_t ch) {
+    const bool was_high = outputHigh(t, ch);
+    t.regs->CCER |= (TIM_CCER_CC1E << (4U * ch));
+    t.ccer_seen |= (TIM_CCER_CC1E << (4U * ch));
+    if (!was_high && outputHigh(t, ch)) {
+        countPulse(t, ch);
+    }
+}
+
+void disableIfIdle(TimerModel& t) {
+    if ((t.regs->CCER & (TIM_CCER_CC1E | TIM_CCER_CC2E | TIM_CCER_CC3E | TIM_CCER_CC4E)) == 0) {
+        t.regs->CR1 &= ~TIM_CR1_CEN;
+    }
+}
+
+void enableUnlessTriggered(TimerModel& t) {
+    // Mirrors the HAL: a slave in trigger mode is started by its master
+    if ((t.regs->SMCR & TIM_SMCR_SMS) != TIM_SLAVEMODE_TRIGGER) {
+        t.regs->CR1 |= TIM_CR1_CEN;
+    }
+}
+
+}  // namespace
+
+/* Simulation control -------------------------------------------------------*/
+
+extern "C" void SimHal_Reset(void) {
+    for (auto& t : g_timers) {
+        std::memset(t.regs, 0, sizeof(TIM_TypeDef));
+        t.regs->ARR = t.counter_max;
+        t.psc_active = 0;
+        t.arr_shadow = t.counter_max;
+        t.prescale_count = 0;
+        t.updates = 0;
+        t.ref_high = false;
+        t.was_enabled = false;
+        t.start_cycle = 0;
+        t.ccer_seen = 0;
+        t.burst_dma = nullptr;
+        t.burst_active = false;
+        t.burst_half_pending = false;
+        t.burst_complete_pending = false;
+        for (uint32_t ch = 0; ch < kChannels; ch++) {
+            t.ccr_shadow[ch] = 0;
+            t.pulses[ch] = 0;
+            t.truncated[ch] = 0;
+        }
+    }
+    for (auto* port : g_ports) {
+        std::memset(port, 0, sizeof(GPIO_TypeDef));
+    }
+    std::fill(std::begin(g_irq_enabled), std::end(g_irq_enabled), false);
+
+    g_cycles = 0;
+    g_next_tick = kCyclesPerMs;
+    uwTick = 0;
+    g_capture.clear();
+    g_primask = 0;
+    g_encoder = EncoderModel{};
+    g_uart.tx_huart = nullptr;
+    g_uart.tx_complete_pending = false;
+    g_uart.tx_bytes = 0;
+    g_uart.capture.clear();
+    g_uart.rx_huart = nullptr;
+    g_uart.rx_baud = 115200;
+    g_uart.rx_line.clear();
+    g_uart.rx_next_cycle = UINT64_MAX;
+    g_uart.rx_idle_armed = false;
+    g_uart.rx_events.clear();
+    std::memset(&SimHal_RCC, 0, sizeof(SimHal_RCC));
+    SimHal_RCC.CFGR = RCC_CFGR_PPRE1_DIV2 | RCC_CFGR_PPRE2_DIV1;
+    std::memset(SimHal_DWT, 0, sizeof(SimHal_DWT));
+    std::memset(SimHal_CoreDebug, 0, sizeof(SimHal_CoreDebug));
+}
+
+extern "C" uint64_t SimHal_GetCycles(void) {
+    return g_cycles;
+}
+
+extern "C" void SimHal_AdvanceCycles(uint64_t cycles) {
+    if (g_in_irq) {
+        std::fprintf(stderr, "sim: blocking wait inside an interrupt handler\n");
+        std::abort();
+    }
+    if (g_primask != 0) {
+        std::fprintf(stderr, "sim: blocking wait with interrupts masked\n");
+        std::abort();
+    }
+
+    const uint64_t end = g_cycles + cycles;
+    uint64_t to_overflow[kTimerCount];
+
+    while (g_cycles < end) {
+        processSoftwareEvents();
+
+        uint64_t step = std::min(end, g_next_tick) - g_cycles;
+        if (g_uart.tx_huart != nullptr) {
+            step = std::min(step, g_uart.tx_done_cycle - g_cycles);
+        }
+        if (g_uart.rx_next_cycle != UINT64_MAX) {
+            step = std::min(step, g_uart.rx_next_cycle - g_cycles);
+        }
+        for (size_t i = 0; i < kTimerCount; i++) {
+            const bool counting = isRunning(g_timers[i]) && !externallyClocked(g_timers[i]);
+            to_overflow[i] = counting ? cyclesToOverflow(g_timers[i]) : UINT64_MAX;
+            step = std::min(step, to_overflow[i]);
+        }
+
+        for (size_t i = 0; i < kTimerCount; i++) {
+            if (to_overflow[i] != UINT64_MAX && to_overflow[i] != step) {
+                advanceCounter(g_timers[i], step);
+            }
+        }
+        g_cycles += step;
+        if (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) {
+            DWT->CYCCNT += static_cast<uint32_t>(step);
+        }
+
+        if (g_cycles == g_next_tick) {
+            g_next_tick += kCyclesPerMs;
+            HAL_IncTick();
+        }
+        if (g_uart.tx_huart != nullptr && g_cycles == g_uart.tx_done_cycle) {
+            uartTxDone();
+        }
+        if (g_cycles == g_uart.rx_next_cycle) {
+            uartRxEvent();
+        }
+        for (size_t i = 0; i < kTimerCount; i++) {
+            if (to_overflow[i] == step) {
+                updateEvent(g_timers[i], true);
+            }
+        }
+    }
+    processSoftwareEvents();
+}
+
+extern "C" void SimHal_AdvanceMicros(uint32_t us) {
+    SimHal_AdvanceCycles(static_cast<uint64_t>(us) * (SIM_SYSCLK_HZ / 1000000U));
+}
+
+extern "C" void SimHal_SetIrqHandler(IRQn_Type irqn, void (*handler)(void)) {
+    if (irqn >= 0 && irqn < kMaxIrq) {
+        g_irq_handler[irqn] = handler;
+    }
+}
+
+extern "C" void SimHal_GpioCaptureEnable(bool enable) {
+    g_capture_enabled = enable;
+}
+
+extern "C" void SimHal_GpioCaptureClear(void) {
+    g_capture.clear();
+}
+
+extern "C" uint32_t SimHal_GpioCaptureCount(void) {
+    return static_cast<uint32_t>(g_capture.size());
+}
+
+extern "C" const SimHal_GpioEvent* SimHal_GpioCaptureGet(uint32_t index) {
+    return (index < g_capture.size()) ? &g_capture[index] : nullptr;
+}
+
+extern "C" void SimHal_TimerEdgeCaptureStart(const TIM_TypeDef* tim, uint32_t channel) {
+    g_edge_timer = tim;
+    g_edge_channel = channelIndex(channel);
+    g_edges.clear();
+}
+
+extern "C" uint32_t SimHal_TimerEdgeCaptureCount(void) {
+    return static_cast<uint32_t>(g_edges.size());
+}
+
+extern "C" uint64_t SimHal_TimerEdgeCaptureGet(uint32_t index) {
+    return (index < g_edges.size()) ? g_edges[index] : 0;
+}
+
+extern "C" uint64_t SimHal_TimerPulseCount(const TIM_TypeDef* tim, uint32_t channel) {
+    const TimerModel* t = findTimer(tim);
+    return t ? t->pulses[channelIndex(channel)] : 0;
+}
+
+extern "C" uint64_t SimHal_TimerTruncatedCount(const TIM_TypeDef* tim, uint32_t channel) {
+    const TimerModel* t = findTimer(tim);
+    return t ? t->truncated[channelIndex(channel)] : 0;
+}
+
+extern "C" uint64_t SimHal_TimerUpdateCount(const TIM_TypeDef* tim) {
+    const TimerModel* t = findTimer(tim);
+    return t ? t->updates : 0;
+}
+
+extern "C" uint64_t SimHal_TimerStartCycle(const TIM_TypeDef* tim) {
+    processSoftwareEvents();
+    const TimerModel* t = findTimer(tim);
+    return t ? t->start_cycle : 0;
+}
+
+extern "C" void SimHal_EncoderAttach(const TIM_TypeDef* encoder, const TIM_TypeDef* step_tim, uint32_t channel,
+                                     GPIO_TypeDef* dir_port, uint16_t dir_pin, double counts_per_step) {
+    processSoftwareEvents();
+    g_encoder = EncoderModel{};
+    g_encoder.timer = findTimer(encoder);
+    g_encoder.step_timer = step_tim;
+    g_encoder.step_channel = channelIndex(channel);
+    g_encoder.dir_port = dir_port;
+    g_encoder.dir_pin = dir_pin;
+    g_encoder.counts_per_step = counts_per_step;
+}
+
+extern "C" void SimHal_EncoderTurn(double counts) {
+    processSoftwareEvents();
+    if (g_encoder.timer != nullptr) {
+        turnShaft(counts);
+    }
+}
+
+extern "C" void SimHal_EncoderSlip(uint32_t steps) {
+    g_encoder.slip += steps;
+}
+
+extern "C" double SimHal_EncoderShaftSteps(void) {
+    processSoftwareEvents();
+    return (g_encoder.timer != nullptr) ? g_encoder.position / g_encoder.counts_per_step : 0.0;
+}
+
+extern "C" void SimHal_UartCaptureEnable(bool enable) {
+    g_uart.capture_enabled = enable;
+}
+
+extern "C" uint32_t SimHal_UartCaptureCount(void) {
+    return static_cast<uint32_t>(g_uart.capture.size());
+}
+
+extern "C" const uint8_t* SimHal_UartCaptureData(void) {
+    return g_uart.capture.data();
+}
+
+extern "C" uint64_t SimHal_UartTxBytes(void) {
+    return g_uart.tx_bytes;
+}
+
+extern "C" void SimHal_UartInject(const uint8_t* data, uint32_t length) {
+    if (length == 0) {
+        return;
+    }
+    if (g_uart.rx_line.empty()) {
+        // A start bit ends any idle detection in progress
+        g_uart.rx_next_cycle = g_cycles + uartRxFrameCycles();
+        g_uart.rx_idle_armed = false;
+    }
+    g_uart.rx_line.insert(g_uart.rx_line.end(), data, data + length);
+}
+
+/* Interrupt masking ---------------------------------------------------------*/
+
+extern "C" uint32_t SimHal_GetPrimask(void) {
+    return g_primask;
+}
+
+extern "C" void SimHal_SetPrimask(uint32_t primask) {
+    g_primask = primask & 1U;
+}
+
+extern "C" void SimHal_Barrier(void) {
+    processSoftwareEvents();
+}
+
+/* HAL core -----------------------------------------------------------------*/
+
+extern "C" void HAL_IncTick(void) {
+    uwTick += uwTickFreq;
+}
+
+extern "C" uint32_t HAL_GetTick(void) {
+    return uwTick;
+}
+
+extern "C" void HAL_Delay(uint32_t Delay) {
+    SimHal_AdvanceCycles(static_cast<uint64_t>(Delay) * kCyclesPerMs);
+}
+
+extern "C" void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+extern "C" void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+    if (IRQn >= 0 && IRQn < kMaxIrq) {
+        g_irq_enabled[IRQn] = true;
+    }
+}
+
+extern "C" void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+    if (IRQn >= 0 && IRQn < kMaxIrq) {
+        g_irq_enabled[IRQn] = false;
+    }
+}
+
+/* RCC ----------------------------------------------------------------------*/
+
+extern "C" uint32_t HAL_RCC_GetSysClockFreq(void) {
+    return SIM_SYSCLK_HZ;
+}
+
+extern "C" uint32_t HAL_RCC_GetHCLKFreq(void) {
+    return SystemCoreClock;
+}
+
+namespace {
+
+// HCLK through an APB prescaler field (PPREx: 0xx = /1, 1xx = /2 to /16)
+uint32_t apbClock(uint32_t ppre) {
+    return (ppre & 0x4U) ? SystemCoreClock >> ((ppre & 0x3U) + 1U) : SystemCoreClock;
+}
+
+}  // namespace
+
+extern "C" uint32_t HAL_RCC_GetPCLK1Freq(void) {
+    return apbClock((SimHal_RCC.CFGR & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos);
+}
+
+extern "C" uint32_t HAL_RCC_GetPCLK2Freq(void) {
+    return apbClock((SimHal_RCC.CFGR & RCC_CFGR_PPRE2) >> RCC_CFGR_PPRE2_Pos);
+}
+
+/* GPIO ---------------------------------------------------------------------*/
+
+extern "C" void HAL_GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_Init) {
+    (void)GPIOx;
+    (void)GPIO_Init;
+}
+
+extern "C" GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+    processSoftwareEvents();
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+extern "C" void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+    processSoftwareEvents();
+    if (PinState != GPIO_PIN_RESET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~static_cast<uint32_t>(GPIO_Pin);
+    }
+    GPIOx->IDR = GPIOx->ODR;
+    recordGpio(GPIOx, GPIO_Pin, static_cast<uint8_t>(PinState));
+}
+
+extern "C" void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+    processSoftwareEvents();
+    const uint32_t odr = GPIOx->ODR;
+    HAL_GPIO_WritePin(GPIOx, GPIO_Pin & static_cast<uint16_t>(odr), GPIO_PIN_RESET);
+    HAL_GPIO_WritePin(GPIOx, GPIO_Pin & static_cast<uint16_t>(~odr), GPIO_PIN_SET);
+}
+
+/* TIM ----------------------------------------------------------------------*/
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef* htim) {
+    TimerModel* t = findTimer(htim->Instance);
+    if (t == nullptr) {
+        return HAL_ERROR;
+    }
+    TIM_TypeDef* regs = htim->Instance;
+    regs->CR1 = (regs->CR1 & ~(TIM_CR1_DIR | TIM_CR1_CMS | TIM_CR1_CKD | TIM_CR1_ARPE))
+              | htim->Init.CounterMode | htim->Init.ClockDivision | htim->Init.AutoReloadPreload;
+    regs->ARR = htim->Init.Period;
+    regs->PSC = htim->Init.Prescaler;
+    regs->EGR = TIM_EGR_UG;
+    processSoftwareEvents();
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef* htim) {
+    return HAL_TIM_Base_Init(htim);
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_ConfigClockSource(TIM_HandleTypeDef* htim,
+                                                       const TIM_ClockConfigTypeDef* sClockSourceConfig) {
+    (void)htim;
+    return (sClockSourceConfig->ClockSource == TIM_CLOCKSOURCE_INTERNAL) ? HAL_OK : HAL_ERROR;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef* htim,
+                                                                   const TIM_MasterConfigTypeDef* sMasterConfig) {
+    htim->Instance->CR2 = (htim->Instance->CR2 & ~TIM_CR2_MMS) | sMasterConfig->MasterOutputTrigger;
+    htim->Instance->SMCR = (htim->Instance->SMCR & ~TIM_SMCR_MSM) | sMasterConfig->MasterSlaveMode;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_SlaveConfigSynchro(TIM_HandleTypeDef* htim,
+                                                       const TIM_SlaveConfigTypeDef* sSlaveConfig) {
+    htim->Instance->SMCR = (htim->Instance->SMCR & ~(TIM_SMCR_SMS | TIM_SMCR_TS))
+                         | sSlaveConfig->SlaveMode | sSlaveConfig->InputTrigger;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIMEx_ConfigBreakDeadTime(TIM_HandleTypeDef* htim,
+                                                          const TIM_BreakDeadTimeConfigTypeDef* sBreakDeadTimeConfig) {
+    // Break input is not modelled; outputs behave as if MOE were always set
+    (void)htim;
+    (void)sBreakDeadTimeConfig;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef* htim, const TIM_OC_InitTypeDef* sConfig,
+                                                       uint32_t Channel) {
+    TimerModel* t = findTimer(htim->Instance);
+    if (t == nullptr) {
+        return HAL_ERROR;
+    }
+    const uint32_t ch = channelIndex(Channel);
+    volatile uint32_t* ccmr = (ch < 2) ? &htim->Instance->CCMR1 : &htim->Instance->CCMR2;
+    const uint32_t shift = (ch & 1U) ? 8U : 0U;
+
+    // Output compare mode with preload enabled, as the HAL does for PWM
+    *ccmr = (*ccmr & ~((TIM_CCMR1_OC1M | TIM_CCMR1_OC1PE | TIM_CCMR1_CC1S) << shift))
+          | ((sConfig->OCMode | TIM_CCMR1_OC1PE) << shift);
+    htim->Instance->CCER = (htim->Instance->CCER & ~(TIM_CCER_CC1P << (4U * ch)))
+                         | (sConfig->OCPolarity << (4U * ch));
+    *ccrRegister(*t, ch) = sConfig->Pulse;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef* htim, uint32_t Channel) {
+    TimerModel* t = findTimer(htim->Instance);
+    if (t == nullptr) {
+        return HAL_ERROR;
+    }
+    processSoftwareEvents();
+    startChannel(*t, channelIndex(Channel));
+    enableUnlessTriggered(*t);
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef* htim, uint32_t Channel) {
+    TimerModel* t = findTimer(htim->Instance);
+    if (t == nullptr) {
+        return HAL_ERROR;
+    }
+    processSoftwareEvents();
+    stopChannel(*t, channelIndex(Channel));
+    disableIfIdle(*t);
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef* htim, const TIM_Encoder_InitTypeDef* sConfig) {
+    if (HAL_TIM_Base_Init(htim) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    TIM_TypeDef* regs = htim->Instance;
+    regs->SMCR = (regs->SMCR & ~TIM_SMCR_SMS) | sConfig->EncoderMode;
+    regs->CCMR1 = (sConfig->IC1Selection | (sConfig->IC1Filter << TIM_CCMR1_IC1F_Pos)) |
+                  ((sConfig->IC2Selection << 8U) | (sConfig->IC2Filter << TIM_CCMR1_IC2F_Pos));
+    regs->CCER = (regs->CCER & ~(TIM_CCER_CC1P | TIM_CCER_CC2P))
+               | sConfig->IC1Polarity | (sConfig->IC2Polarity << 4U);
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef* htim, uint32_t Channel) {
+    (void)Channel;
+    processSoftwareEvents();
+    htim->Instance->CCER |= TIM_CCER_CC1E | TIM_CCER_CC2E;
+    htim->Instance->CR1 |= TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Encoder_Stop(TIM_HandleTypeDef* htim, uint32_t Channel) {
+    (void)Channel;
+    processSoftwareEvents();
+    htim->Instance->CCER &= ~(TIM_CCER_CC1E | TIM_CCER_CC2E);
+    htim->Instance->CR1 &= ~TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_GenerateEvent(TIM_HandleTypeDef* htim, uint32_t EventSource) {
+    // Applied now, unlike a plain EGR store
+    htim->Instance->EGR = EventSource;
+    processSoftwareEvents();
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef* htim) {
+    processSoftwareEvents();
+    TimerModel* t = findTimer(htim->Instance);
+    if (t == nullptr) {
+        return HAL_ERROR;
+    }
+    enableUnlessTriggered(*t);
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef* htim) {
+    TimerModel* t = findTimer(htim->Instance);
+    if (t == nullptr) {
+        return HAL_ERROR;
+    }
+    processSoftwareEvents();
+    disableIfIdle(*t);
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef* htim) {
+    processSoftwareEvents();
+    htim->Instance->DIER |= TIM_DIER_UIE;
+    TimerModel* t = findTimer(htim->Instance);
+    if (t == nullptr) {
+        return HAL_ERROR;
+    }
+    enableUnlessTriggered(*t);
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef* htim) {
+    TimerModel* t = findTimer(htim->Instance);
+    if (t == nullptr) {
+        return HAL_ERROR;
+    }
+    processSoftwareEvents();
+    htim->Instance->DIER &= ~TIM_DIER_UIE;
+    disableIfIdle(*t);
+    return HAL_OK;
+}
+
+extern "C" void HAL_TIM_IRQHandler(TIM_HandleTypeDef* htim) {
+    TIM_TypeDef* regs = htim->Instance;
+    if ((regs->SR & TIM_SR_UIF) && (regs->DIER & TIM_DIER_UIE)) {
+        regs->SR &= ~TIM_SR_UIF;
+        HAL_TIM_PeriodElapsedCallback(htim);
+    }
+}
+
+extern "C" __attribute__((weak)) void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {
+    (void)htim;
+}
+
+extern "C" __attribute__((weak)) void HAL_TIM_PeriodElapsedHalfCpltCallback(TIM_HandleTypeDef* htim) {
+    (void)htim;
+}
+
+namespace {
+
+void burstCompleteCallback(DMA_HandleTypeDef* hdma) {
+    HAL_TIM_PeriodElapsedCallback(static_cast<TIM_HandleTypeDef*>(hdma->Parent));
+}
+
+void burstHalfCompleteCallback(DMA_HandleTypeDef* hdma) {
+    HAL_TIM_PeriodElapsedHalfCpltCallback(static_cast<TIM_HandleTypeDef*>(hdma->Parent));
+}
+
+}  // namespace
+
+extern "C" HAL_StatusTypeDef HAL_TIM_DMABurst_MultiWriteStart(TIM_HandleTypeDef* htim, uint32_t BurstBaseAddress,
+                                                              uint32_t BurstRequestSrc, const uint32_t* BurstBuffer,
+                                                              uint32_t BurstLength, uint32_t DataLength) {
+    TimerModel* t = findTimer(htim->Instance);
+    DMA_HandleTypeDef* hdma = htim->hdma[TIM_DMA_ID_UPDATE];
+    // Only the update request is modelled
+    if (t == nullptr || BurstRequestSrc != TIM_DMA_UPDATE || hdma == nullptr || BurstBuffer == nullptr ||
+        DataLength == 0) {
+        return HAL_ERROR;
+    }
+    if (t->burst_active) {
+        return HAL_BUSY;
+    }
+    processSoftwareEvents();
+
+    hdma->XferCpltCallback = burstCompleteCallback;
+    hdma->XferHalfCpltCallback = burstHalfCompleteCallback;
+    t->burst_dma = hdma;
+    t->burst_buffer = BurstBuffer;
+    t->burst_length = DataLength;
+    t->burst_pos = 0;
+    t->burst_half_pending = false;
+    t->burst_complete_pending = false;
+    t->burst_active = true;
+
+    htim->Instance->DCR = BurstBaseAddress | BurstLength;
+    htim->Instance->DIER |= TIM_DIER_UDE;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_DMABurst_WriteStop(TIM_HandleTypeDef* htim, uint32_t BurstRequestSrc) {
+    TimerModel* t = findTimer(htim->Instance);
+    if (t == nullptr || BurstRequestSrc != TIM_DMA_UPDATE) {
+        return HAL_ERROR;
+    }
+    t->burst_active = false;
+    t->burst_half_pending = false;
+    t->burst_complete_pending = false;
+    htim->Instance->DIER &= ~TIM_DIER_UDE;
+    return HAL_OK;
+}
+
+/* DMA ----------------------------------------------------------------------*/
+
+extern "C" HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma) {
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef* hdma) {
+    hdma->State = HAL_DMA_STATE_RESET;
+    return HAL_OK;
+}
+
+extern "C" void HAL_DMA_IRQHandler(DMA_HandleTypeDef* hdma) {
+    for (auto& t : g_timers) {
+        if (t.burst_dma != hdma) {
+            continue;
+        }
+        if (t.burst_half_pending) {
+            t.burst_half_pending = false;
+            if (hdma->XferHalfCpltCallback) {
+                hdma->XferHalfCpltCallback(hdma);
+            }
+        }
+        if (t.burst_complete_pending) {
+            t.burst_complete_pending = false;
+            if (hdma->XferCpltCallback) {
+                hdma->XferCpltCallback(hdma);
+            }
+        }
+    }
+}
+
+/* UART ---------------------------------------------------------------------*/
+
+extern "C" HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size,
+                                               uint32_t Timeout) {
+    (void)huart;
+    (void)Timeout;
+    std::fwrite(pData, 1, Size, stdout);
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size) {
+    if (pData == nullptr || Size == 0 || huart->Init.BaudRate == 0) {
+        return HAL_ERROR;
+    }
+    if (g_uart.tx_huart != nullptr) {
+        return HAL_BUSY;
+    }
+    // 8N1: ten bit times per byte
+    const uint64_t bits = static_cast<uint64_t>(Size) * 10U;
+    g_uart.tx_huart = huart;
+    g_uart.tx_data = pData;
+    g_uart.tx_size = Size;
+    g_uart.tx_done_cycle = g_cycles + (bits * SIM_SYSCLK_HZ + huart->Init.BaudRate - 1) / huart->Init.BaudRate;
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size) {
+    if (pData == nullptr || Size == 0 || huart->hdmarx == nullptr || huart->Init.BaudRate == 0) {
+        return HAL_ERROR;
+    }
+    if (g_uart.rx_huart != nullptr) {
+        return HAL_BUSY;
+    }
+    g_uart.rx_huart = huart;
+    g_uart.rx_baud = huart->Init.BaudRate;
+    g_uart.rx_buffer = pData;
+    g_uart.rx_size = Size;
+    g_uart.rx_pos = 0;
+    huart->ReceptionType = HAL_UART_RECEPTION_TOIDLE;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    return HAL_OK;
+}
+
+extern "C" void HAL_UART_IRQHandler(UART_HandleTypeDef* huart) {
+    if (g_uart.tx_complete_pending) {
+        g_uart.tx_complete_pending = false;
+        HAL_UART_TxCpltCallback(huart);
+    }
+    // Callbacks may restart reception, so take the events first
+    std::vector<uint16_t> events;
+    events.swap(g_uart.rx_events);
+    for (const uint16_t position : events) {
+        HAL_UARTEx_RxEventCallback(huart, position);
+    }
+}
+
+extern "C" __attribute__((weak)) void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size) {
+    (void)huart;
+    (void)Size;
+}
+
+extern "C" __attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart) {
+    (void)huart;
+}
+
+extern "C" __attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart) {
+    (void)huart;
+}
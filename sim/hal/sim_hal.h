@@ -0,0 +1,270 @@
+/**
+ * @file sim_hal.h
+ * @brief Simulated STM32F411 peripherals for host builds
+ *
+ * Provides register models for the GPIO ports, timers, RCC clock configuration
+ * and DWT cycle counter used by the motor stack, a virtual clock that drives SysTick and the timers, and capture of
+ * GPIO writes. Only included through the stm32f4xx_hal.h shim.
+ *
+ * Time advances only when the simulation asks for it (SimHal_Advance*() or
+ * HAL_Delay()). Timer update events and their interrupt handlers run inside
+ * those calls, in timestamp order, exactly as they would preempt the main
+ * loop on the target.
+ */
+
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Clock tree as configured by SystemClock_Config() (HSI -> PLL, APB1 /2).
+ * SimHal_RCC reports the APB prescalers; the timer models always count at
+ * SIM_SYSCLK_HZ, which matches the reset configuration. */
+#define SIM_SYSCLK_HZ   84000000UL  /* Core and timer clock (APB1/APB2 timers) */
+#define SIM_PCLK1_HZ    42000000UL
+#define SIM_PCLK2_HZ    84000000UL
+
+/* Register models ----------------------------------------------------------*/
+extern GPIO_TypeDef SimHal_GPIOA;
+extern GPIO_TypeDef SimHal_GPIOB;
+extern GPIO_TypeDef SimHal_GPIOC;
+extern GPIO_TypeDef SimHal_GPIOH;
+
+extern TIM_TypeDef SimHal_TIM1;
+extern TIM_TypeDef SimHal_TIM2;
+extern TIM_TypeDef SimHal_TIM3;
+extern TIM_TypeDef SimHal_TIM4;
+extern TIM_TypeDef SimHal_TIM5;
+extern TIM_TypeDef SimHal_TIM9;
+extern TIM_TypeDef SimHal_TIM10;
+extern TIM_TypeDef SimHal_TIM11;
+
+extern RCC_TypeDef SimHal_RCC;
+
+extern uint32_t SimHal_DWT[];
+extern uint32_t SimHal_CoreDebug[];
+
+#undef GPIOA
+#undef GPIOB
+#undef GPIOC
+#undef GPIOH
+#define GPIOA (&SimHal_GPIOA)
+#define GPIOB (&SimHal_GPIOB)
+#define GPIOC (&SimHal_GPIOC)
+#define GPIOH (&SimHal_GPIOH)
+
+#undef TIM1
+#undef TIM2
+#undef TIM3
+#undef TIM4
+#undef TIM5
+#undef TIM9
+#undef TIM10
+#undef TIM11
+#define TIM1  (&SimHal_TIM1)
+#define TIM2  (&SimHal_TIM2)
+#define TIM3  (&SimHal_TIM3)
+#define TIM4  (&SimHal_TIM4)
+#define TIM5  (&SimHal_TIM5)
+#define TIM9  (&SimHal_TIM9)
+#define TIM10 (&SimHal_TIM10)
+#define TIM11 (&SimHal_TIM11)
+
+#undef RCC
+#define RCC (&SimHal_RCC)
+
+#undef DWT
+#undef CoreDebug
+#define DWT       ((DWT_Type*)SimHal_DWT)
+#define CoreDebug ((CoreDebug_Type*)SimHal_CoreDebug)
+
+/* Virtual clock ------------------------------------------------------------*/
+
+/**
+ * @brief Reset all peripherals, the tick counter and the capture buffer
+ */
+void SimHal_Reset(void);
+
+/**
+ * @brief Current virtual time in core clock cycles (SIM_SYSCLK_HZ)
+ */
+uint64_t SimHal_GetCycles(void);
+
+/**
+ * @brief Advance virtual time, firing timer events and interrupts on the way
+ * @param cycles Number of core clock cycles to simulate
+ */
+void SimHal_AdvanceCycles(uint64_t cycles);
+
+/**
+ * @brief Advance virtual time by a number of microseconds
+ */
+void SimHal_AdvanceMicros(uint32_t us);
+
+/**
+ * @brief Register the handler called when an interrupt line fires
+ *
+ * Stands in for the vector table. The line must also be enabled with
+ * HAL_NVIC_EnableIRQ() before the handler is called.
+ */
+void SimHal_SetIrqHandler(IRQn_Type irqn, void (*handler)(void));
+
+/* GPIO capture -------------------------------------------------------------*/
+
+typedef struct {
+    uint64_t cycle;         /* Virtual time of the write */
+    GPIO_TypeDef* port;
+    uint16_t pin;           /* Pin mask as passed to HAL_GPIO_WritePin() */
+    uint8_t state;          /* GPIO_PIN_SET / GPIO_PIN_RESET */
+} SimHal_GpioEvent;
+
+/**
+ * @brief Start or stop recording GPIO writes
+ */
+void SimHal_GpioCaptureEnable(bool enable);
+
+/**
+ * @brief Discard recorded GPIO writes
+ */
+void SimHal_GpioCaptureClear(void);
+
+/**
+ * @brief Number of recorded GPIO writes
+ */
+uint32_t SimHal_GpioCaptureCount(void);
+
+/**
+ * @brief Get a recorded GPIO write (NULL if index is out of range)
+ */
+const SimHal_GpioEvent* SimHal_GpioCaptureGet(uint32_t index);
+
+/* UART capture -------------------------------------------------------------*/
+
+/**
+ * @brief Collect bytes sent by HAL_UART_Transmit_DMA() instead of printing them
+ */
+void SimHal_UartCaptureEnable(bool enable);
+
+/**
+ * @brief Number of captured UART bytes
+ */
+uint32_t SimHal_UartCaptureCount(void);
+
+/**
+ * @brief Captured UART bytes (valid until the next transfer completes)
+ */
+const uint8_t* SimHal_UartCaptureData(void);
+
+/**
+ * @brief Bytes sent by UART DMA transfers since reset
+ */
+uint64_t SimHal_UartTxBytes(void);
+
+/**
+ * @brief Queue bytes on the USART2 RX line
+ *
+ * They arrive one frame time apart (8N1 at Init.BaudRate) after any bytes
+ * still queued; bytes arriving while no reception runs are lost.
+ */
+void SimHal_UartInject(const uint8_t* data, uint32_t length);
+
+/* Interrupt masking --------------------------------------------------------*/
+
+uint32_t SimHal_GetPrimask(void);
+void SimHal_SetPrimask(uint32_t primask);
+
+/* Barriers -----------------------------------------------------------------*/
+
+/**
+ * @brief __DSB(): apply the plain register stores made so far
+ */
+void SimHal_Barrier(void);
+
+/* Timer emulation ----------------------------------------------------------*/
+
+/**
+ * @brief Rising edges produced on a PWM channel output since reset
+ * @param tim Timer instance (e.g. TIM2)
+ * @param channel TIM_CHANNEL_1 .. TIM_CHANNEL_4
+ */
+uint64_t SimHal_TimerPulseCount(const TIM_TypeDef* tim, uint32_t channel);
+
+/**
+ * @brief Pulses cut short because the channel was stopped while high
+ */
+uint64_t SimHal_TimerTruncatedCount(const TIM_TypeDef* tim, uint32_t channel);
+
+/**
+ * @brief Update events generated by the counter since reset
+ */
+uint64_t SimHal_TimerUpdateCount(const TIM_TypeDef* tim);
+
+/**
+ * @brief Virtual time (cycles) at which the counter was last enabled
+ *
+ * Covers software starts and starts by a trigger-mode master alike.
+ */
+uint64_t SimHal_TimerStartCycle(const TIM_TypeDef* tim);
+
+/**
+ * @brief Record the virtual time of every rising edge on one PWM channel
+ * @param tim Timer instance, or NULL to stop recording
+ * @param channel TIM_CHANNEL_1 .. TIM_CHANNEL_4
+ *
+ * Starting a recording discards the previous one.
+ */
+void SimHal_TimerEdgeCaptureStart(const TIM_TypeDef* tim, uint32_t channel);
+
+/**
+ * @brief Number of recorded edges
+ */
+uint32_t SimHal_TimerEdgeCaptureCount(void);
+
+/**
+ * @brief Virtual time (cycles) of a recorded edge (0 if index is out of range)
+ */
+uint64_t SimHal_TimerEdgeCaptureGet(uint32_t index);
+
+/* Quadrature encoder -------------------------------------------------------*/
+
+/**
+ * @brief Put a motor shaft with an encoder on a step output
+ * @param encoder Timer in encoder mode reading the shaft (e.g. TIM3)
+ * @param step_tim Timer of the step output driving the motor
+ * @param channel Step channel, TIM_CHANNEL_1 .. TIM_CHANNEL_4
+ * @param dir_port Port of the direction pin
+ * @param dir_pin Direction pin (high: forward, counting up)
+ * @param counts_per_step Encoder counts per step (may be fractional)
+ *
+ * Every step pulse turns the shaft one step, and the encoder timer counts
+ * the edges while its counter is enabled: up or down with CR1.DIR, wrapping
+ * at ARR with an update event. Replaces any shaft attached before.
+ */
+void SimHal_EncoderAttach(const TIM_TypeDef* encoder, const TIM_TypeDef* step_tim, uint32_t channel,
+                          GPIO_TypeDef* dir_port, uint16_t dir_pin, double counts_per_step);
+
+/**
+ * @brief Turn the shaft by hand (or by the load), in encoder counts
+ */
+void SimHal_EncoderTurn(double counts);
+
+/**
+ * @brief Lose the next steps: the motor stalls and the shaft does not turn
+ */
+void SimHal_EncoderSlip(uint32_t steps);
+
+/**
+ * @brief Shaft position in steps since the encoder was attached
+ */
+double SimHal_EncoderShaftSteps(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_HAL_H */
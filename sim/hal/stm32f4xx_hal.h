@@ -0,0 +1,28 @@
+/**
+ * @file stm32f4xx_hal.h
+ * @brief Host simulation shim for the STM32F4 HAL umbrella header
+ *
+ * Pulls in the real HAL headers (types, register layouts, bit definitions
+ * and helper macros) and then redirects every peripheral instance macro
+ * to the register models in sim_hal.h. Must be found before
+ * Drivers/STM32F4xx_HAL_Driver/Inc on the include path.
+ */
+
+#ifndef SIM_STM32F4XX_HAL_H
+#define SIM_STM32F4XX_HAL_H
+
+#include_next "stm32f4xx_hal.h"
+#include "sim_hal.h"
+
+/* CMSIS PRIMASK intrinsics are Cortex-M instructions; route the calls to
+ * the simulated mask */
+#define __disable_irq()       SimHal_SetPrimask(1U)
+#define __enable_irq()        SimHal_SetPrimask(0U)
+#define __get_PRIMASK()       SimHal_GetPrimask()
+#define __set_PRIMASK(mask)   SimHal_SetPrimask(mask)
+
+/* A data barrier completes the register stores before it, which the model
+ * otherwise picks up lazily */
+#define __DSB()               SimHal_Barrier()
+
+#endif /* SIM_STM32F4XX_HAL_H */
@@ -0,0 +1,306 @@
+/**
+ * @file sim_board.cpp
+ * @brief Simulated Nucleo-F411RE board (host stand-in for main.c)
+ *
+ * Mirrors the peripheral handles and MX_*_Init() sequence of Core/Src/main.c
+ * against the simulated HAL, so the motor modules see the same register
+ * state they would after CubeMX initialisation on the target.
+ */
+
+#include "sim_board.h"
+
+TIM_HandleTypeDef htim1;
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim3;
+TIM_HandleTypeDef htim4;
+TIM_HandleTypeDef htim5;
+TIM_HandleTypeDef htim9;
+DMA_HandleTypeDef hdma_tim2_up;
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_rx;
+DMA_HandleTypeDef hdma_usart2_tx;
+
+/* Interrupt handlers (stm32f4xx_it.c) */
+extern "C" void DMA1_Stream1_IRQHandler(void)
+{
+    HAL_DMA_IRQHandler(&hdma_tim2_up);
+}
+
+extern "C" void TIM4_IRQHandler(void)
+{
+    HAL_TIM_IRQHandler(&htim4);
+}
+
+extern "C" void USART2_IRQHandler(void)
+{
+    HAL_UART_IRQHandler(&huart2);
+}
+
+static void MX_TIM2_Init(void)
+{
+    TIM_ClockConfigTypeDef sClockSourceConfig = {};
+    TIM_MasterConfigTypeDef sMasterConfig = {};
+    TIM_OC_InitTypeDef sConfigOC = {};
+
+    htim2 = TIM_HandleTypeDef{};
+    htim2.Instance = TIM2;
+    htim2.Init.Prescaler = 0;
+    htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim2.Init.Period = 4294967295;
+    htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    HAL_TIM_Base_Init(&htim2);
+
+    /* HAL_TIM_Base_MspInit(): TIM2_UP on DMA1 Stream1 Channel 3 */
+    hdma_tim2_up = DMA_HandleTypeDef{};
+    hdma_tim2_up.Instance = DMA1_Stream1;
+    hdma_tim2_up.Init.Channel = DMA_CHANNEL_3;
+    hdma_tim2_up.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_tim2_up.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_tim2_up.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_tim2_up.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdma_tim2_up.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma_tim2_up.Init.Mode = DMA_CIRCULAR;
+    hdma_tim2_up.Init.Priority = DMA_PRIORITY_VERY_HIGH;
+    HAL_DMA_Init(&hdma_tim2_up);
+    __HAL_LINKDMA(&htim2, hdma[TIM_DMA_ID_UPDATE], hdma_tim2_up);
+
+    sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+    HAL_TIM_ConfigClockSource(&htim2, &sClockSourceConfig);
+    HAL_TIM_PWM_Init(&htim2);
+
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_OC1REF;
+    sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    HAL_TIMEx_MasterConfigSynchronization(&htim2, &sMasterConfig);
+
+    sConfigOC.OCMode = TIM_OCMODE_PWM1;
+    sConfigOC.Pulse = 0;
+    sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+    sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+    HAL_TIM_PWM_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_1);
+}
+
+static void MX_TIM4_Init(void)
+{
+    TIM_ClockConfigTypeDef sClockSourceConfig = {};
+    TIM_MasterConfigTypeDef sMasterConfig = {};
+
+    htim4 = TIM_HandleTypeDef{};
+    htim4.Instance = TIM4;
+    htim4.Init.Prescaler = 83;
+    htim4.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim4.Init.Period = 999;
+    htim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    HAL_TIM_Base_Init(&htim4);
+
+    sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+    HAL_TIM_ConfigClockSource(&htim4, &sClockSourceConfig);
+
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+    sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    HAL_TIMEx_MasterConfigSynchronization(&htim4, &sMasterConfig);
+
+    /* HAL_TIM_Base_MspInit() */
+    HAL_NVIC_SetPriority(TIM4_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(TIM4_IRQn);
+    SimHal_SetIrqHandler(TIM4_IRQn, TIM4_IRQHandler);
+}
+
+static void MX_TIM1_Init(void)
+{
+    TIM_ClockConfigTypeDef sClockSourceConfig = {};
+    TIM_SlaveConfigTypeDef sSlaveConfig = {};
+    TIM_MasterConfigTypeDef sMasterConfig = {};
+    TIM_OC_InitTypeDef sConfigOC = {};
+    TIM_BreakDeadTimeConfigTypeDef sBreakDeadTimeConfig = {};
+
+    htim1 = TIM_HandleTypeDef{};
+    htim1.Instance = TIM1;
+    htim1.Init.Prescaler = 0;
+    htim1.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim1.Init.Period = 65535;
+    htim1.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim1.Init.RepetitionCounter = 0;
+    htim1.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    HAL_TIM_Base_Init(&htim1);
+
+    sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+    HAL_TIM_ConfigClockSource(&htim1, &sClockSourceConfig);
+    HAL_TIM_PWM_Init(&htim1);
+
+    /* Started by TIM2 TRGO (ITR1) */
+    sSlaveConfig.SlaveMode = TIM_SLAVEMODE_TRIGGER;
+    sSlaveConfig.InputTrigger = TIM_TS_ITR1;
+    HAL_TIM_SlaveConfigSynchro(&htim1, &sSlaveConfig);
+
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+    sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    HAL_TIMEx_MasterConfigSynchronization(&htim1, &sMasterConfig);
+
+    sConfigOC.OCMode = TIM_OCMODE_PWM1;
+    sConfigOC.Pulse = 0;
+    sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+    sConfigOC.OCNPolarity = TIM_OCNPOLARITY_HIGH;
+    sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+    sConfigOC.OCIdleState = TIM_OCIDLESTATE_RESET;
+    sConfigOC.OCNIdleState = TIM_OCNIDLESTATE_RESET;
+    HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_3);
+
+    sBreakDeadTimeConfig.OffStateRunMode = TIM_OSSR_DISABLE;
+    sBreakDeadTimeConfig.OffStateIDLEMode = TIM_OSSI_DISABLE;
+    sBreakDeadTimeConfig.LockLevel = TIM_LOCKLEVEL_OFF;
+    sBreakDeadTimeConfig.DeadTime = 0;
+    sBreakDeadTimeConfig.BreakState = TIM_BREAK_DISABLE;
+    sBreakDeadTimeConfig.BreakPolarity = TIM_BREAKPOLARITY_HIGH;
+    sBreakDeadTimeConfig.AutomaticOutput = TIM_AUTOMATICOUTPUT_DISABLE;
+    HAL_TIMEx_ConfigBreakDeadTime(&htim1, &sBreakDeadTimeConfig);
+}
+
+static void MX_TIM5_Init(void)
+{
+    TIM_ClockConfigTypeDef sClockSourceConfig = {};
+    TIM_SlaveConfigTypeDef sSlaveConfig = {};
+    TIM_MasterConfigTypeDef sMasterConfig = {};
+    TIM_OC_InitTypeDef sConfigOC = {};
+
+    htim5 = TIM_HandleTypeDef{};
+    htim5.Instance = TIM5;
+    htim5.Init.Prescaler = 0;
+    htim5.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim5.Init.Period = 4294967295;
+    htim5.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim5.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    HAL_TIM_Base_Init(&htim5);
+
+    sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+    HAL_TIM_ConfigClockSource(&htim5, &sClockSourceConfig);
+    HAL_TIM_PWM_Init(&htim5);
+
+    /* Started by TIM2 TRGO (ITR0) */
+    sSlaveConfig.SlaveMode = TIM_SLAVEMODE_TRIGGER;
+    sSlaveConfig.InputTrigger = TIM_TS_ITR0;
+    HAL_TIM_SlaveConfigSynchro(&htim5, &sSlaveConfig);
+
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+    sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    HAL_TIMEx_MasterConfigSynchronization(&htim5, &sMasterConfig);
+
+    sConfigOC.OCMode = TIM_OCMODE_PWM1;
+    sConfigOC.Pulse = 0;
+    sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+    sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+    HAL_TIM_PWM_ConfigChannel(&htim5, &sConfigOC, TIM_CHANNEL_2);
+}
+
+static void MX_TIM9_Init(void)
+{
+    TIM_SlaveConfigTypeDef sSlaveConfig = {};
+
+    htim9 = TIM_HandleTypeDef{};
+    htim9.Instance = TIM9;
+    htim9.Init.Prescaler = 0;
+    htim9.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim9.Init.Period = 65535;
+    htim9.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim9.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+    HAL_TIM_Base_Init(&htim9);
+
+    /* Clocked by TIM2 TRGO (ITR0): counts axis 0 step pulses */
+    sSlaveConfig.SlaveMode = TIM_SLAVEMODE_EXTERNAL1;
+    sSlaveConfig.InputTrigger = TIM_TS_ITR0;
+    HAL_TIM_SlaveConfigSynchro(&htim9, &sSlaveConfig);
+}
+
+static void MX_TIM3_Init(void)
+{
+    TIM_Encoder_InitTypeDef sConfig = {};
+    TIM_MasterConfigTypeDef sMasterConfig = {};
+
+    htim3 = TIM_HandleTypeDef{};
+    htim3.Instance = TIM3;
+    htim3.Init.Prescaler = 0;
+    htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim3.Init.Period = 65535;
+    htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+
+    /* Encoder mode x4: counts ENC_A/ENC_B (PA6/PA7) edges */
+    sConfig.EncoderMode = TIM_ENCODERMODE_TI12;
+    sConfig.IC1Polarity = TIM_ICPOLARITY_RISING;
+    sConfig.IC1Selection = TIM_ICSELECTION_DIRECTTI;
+    sConfig.IC1Prescaler = TIM_ICPSC_DIV1;
+    sConfig.IC1Filter = 6;
+    sConfig.IC2Polarity = TIM_ICPOLARITY_RISING;
+    sConfig.IC2Selection = TIM_ICSELECTION_DIRECTTI;
+    sConfig.IC2Prescaler = TIM_ICPSC_DIV1;
+    sConfig.IC2Filter = 6;
+    HAL_TIM_Encoder_Init(&htim3, &sConfig);
+
+    sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+    sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    HAL_TIMEx_MasterConfigSynchronization(&htim3, &sMasterConfig);
+}
+
+static void MX_DMA_Init(void)
+{
+    HAL_NVIC_SetPriority(DMA1_Stream1_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+    SimHal_SetIrqHandler(DMA1_Stream1_IRQn, DMA1_Stream1_IRQHandler);
+}
+
+static void MX_USART2_UART_Init(void)
+{
+    huart2 = UART_HandleTypeDef{};
+    huart2.Init.BaudRate = 115200;
+    huart2.Init.WordLength = UART_WORDLENGTH_8B;
+    huart2.Init.StopBits = UART_STOPBITS_1;
+    huart2.Init.Parity = UART_PARITY_NONE;
+    huart2.Init.Mode = UART_MODE_TX_RX;
+
+    /* HAL_UART_MspInit(): USART2_RX on DMA1 Stream5, USART2_TX on DMA1 Stream6 (Channel 4) */
+    hdma_usart2_rx = DMA_HandleTypeDef{};
+    hdma_usart2_rx.Instance = DMA1_Stream5;
+    hdma_usart2_rx.Init.Channel = DMA_CHANNEL_4;
+    hdma_usart2_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_usart2_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart2_rx.Init.Mode = DMA_CIRCULAR;
+    HAL_DMA_Init(&hdma_usart2_rx);
+    __HAL_LINKDMA(&huart2, hdmarx, hdma_usart2_rx);
+
+    hdma_usart2_tx = DMA_HandleTypeDef{};
+    hdma_usart2_tx.Instance = DMA1_Stream6;
+    hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+    hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+    HAL_DMA_Init(&hdma_usart2_tx);
+    __HAL_LINKDMA(&huart2, hdmatx, hdma_usart2_tx);
+    huart2.gState = HAL_UART_STATE_READY;
+    huart2.RxState = HAL_UART_STATE_READY;
+
+    HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(USART2_IRQn);
+    SimHal_SetIrqHandler(USART2_IRQn, USART2_IRQHandler);
+}
+
+static void MX_GPIO_Init(void)
+{
+    HAL_GPIO_WritePin(GPIOC, AXIS1_DIR_Pin | AXIS1_EN_Pin | AXIS2_DIR_Pin | AXIS2_EN_Pin, GPIO_PIN_RESET);
+    HAL_GPIO_WritePin(GPIOA, LD2_Pin | MOTOR_DIR_Pin | MOTOR_EN_Pin, GPIO_PIN_RESET);
+}
+
+void SimBoard_Init()
+{
+    SimHal_Reset();
+
+    MX_GPIO_Init();
+    MX_DMA_Init();
+    MX_USART2_UART_Init();
+    MX_TIM2_Init();
+    MX_TIM4_Init();
+    MX_TIM1_Init();
+    MX_TIM5_Init();
+    MX_TIM9_Init();
+    MX_TIM3_Init();
+}
@@ -0,0 +1,27 @@
+/**
+ * @file sim_board.h
+ * @brief Simulated Nucleo-F411RE board (host stand-in for main.c)
+ */
+
+#ifndef SIM_SIM_BOARD_H
+#define SIM_SIM_BOARD_H
+
+#include "main.h"
+
+extern TIM_HandleTypeDef htim1;
+extern TIM_HandleTypeDef htim2;
+extern TIM_HandleTypeDef htim3;
+extern TIM_HandleTypeDef htim4;
+extern TIM_HandleTypeDef htim5;
+extern TIM_HandleTypeDef htim9;
+extern DMA_HandleTypeDef hdma_tim2_up;
+extern UART_HandleTypeDef huart2;
+extern DMA_HandleTypeDef hdma_usart2_rx;
+extern DMA_HandleTypeDef hdma_usart2_tx;
+
+/**
+ * @brief Reset the simulated MCU and run the CubeMX peripheral init sequence
+ */
+void SimBoard_Init();
+
+#endif /* SIM_SIM_BOARD_H */
@@ -0,0 +1,1966 @@
+/**
+ * @file sim_main.cpp
+ * @brief Host simulation entry point for the motor stack
+ *
+ * Usage:
+ *   stm32-robotics-control-sim bench [iterations]
+ *   stm32-robotics-control-sim replay [moves.csv] [--trace trace.csv] [--dma] [--queue]
+ *   stm32-robotics-control-sim axes [target0 target1 target2]
+ *   stm32-robotics-control-sim log [lines_per_sec]
+ *   stm32-robotics-control-sim telemetry [moves.csv]
+ *   stm32-robotics-control-sim command
+ *   stm32-robotics-control-sim profile [moves.csv]
+ *   stm32-robotics-control-sim jitter [moves.csv]
+ *   stm32-robotics-control-sim stop
+ *   stm32-robotics-control-sim retarget [seconds]
+ *   stm32-robotics-control-sim jog
+ *   stm32-robotics-control-sim steps
+ *   stm32-robotics-control-sim timers
+ *   stm32-robotics-control-sim driver
+ *   stm32-robotics-control-sim encoder
+ *
+ * bench   Times SCurveProfile::getStateAtTime(), SCurveStepper::step() and
+ *         MotionPlanner::update() with and without the StepperMotor PWM
+ *         update behind it.
+ * replay  Runs a list of moves through the firmware motor_control API (planner
+ *         on the TIM4 control-loop interrupt, steps on TIM2) and checks that
+ *         each move emits exactly its distance in step pulses.
+ *         Each CSV line is "target_steps,max_velocity,max_acceleration,max_jerk"
+ *         (absolute targets, '#' starts a comment). Without a file the
+ *         production test cycle from motor_control.cpp is replayed.
+ *         --dma emits the steps with the DMA step engine instead of the
+ *         per-tick PWM rate updates.
+ *         --queue pushes all moves into the planner's move queue up front
+ *         instead of waiting for each move before starting the next,
+ *         and reports what a move start costs the ISR (MOVE_START probe).
+ * axes    Runs one coordinated move on all axes (TIM2 master, TIM1/TIM5
+ *         trigger slaves) and reports per-axis pulses (exactly each axis'
+ *         distance), counter start times and finish times.
+ * log     Writes numbered log lines into the console UartLogSink for one
+ *         second at a fixed rate and checks what reaches USART2: lines
+ *         intact and in order, drops counted, link kept busy.
+ * telemetry Runs moves with the binary telemetry stream on, decodes the
+ *         USART2 output like the GUI does and compares its size with the
+ *         same samples as "DATA,..." text lines. The stream must carry at
+ *         least 5x the ~150 samples/s of the former text telemetry.
+ * command Feeds a GUI command session (plus noise, a corrupted frame and a
+ *         burst that wraps the receive buffer) into the USART2 RX line,
+ *         runs the firmware main loop and checks every ACK, the receiver's
+ *         error counters and the command-to-motion latency.
+ * profile Runs the moves and a coordinated three-axis move with the
+ *         execution time probes on, requests the report with a GET_PROFILE
+ *         command and checks its ACK. Ticks are host nanoseconds
+ *         (std::chrono back end); the budget line uses the 10 kHz period.
+ * jitter  Feeds the loop timing recorder a scripted schedule (a delayed
+ *         entry, an overrun and a stall that loses ticks) and checks what
+ *         it records, then runs the moves and checks the LOOP_TIMING
+ *         frames the firmware sends.
+ * stop    Stops a move with motor_decelerate_to_stop() at points across
+ *         every profile phase and checks the ramp: acceleration and jerk
+ *         of the commanded velocity within the move's limits, at rest
+ *         within its target, counted position equal to the pulses emitted.
+ *         A hard motor_stop() is run for comparison.
+ * retarget Moves the target of a running move every 20-50 ms, like a
+ *         vision-guided axis following a swinging part, and checks that
+ *         the commanded velocity stays within the acceleration and jerk
+ *         limits through every retarget and reversal and that the axis
+ *         settles on the last target. Then lowers the limits mid-ramp,
+ *         accelerating and decelerating harder than the new ones, and
+ *         checks that the ramp eases off to them and settles.
+ * jog     Streams velocity setpoints to motor_jog() (up, faster, two
+ *         reversals through zero, one of them mid-ramp, then to rest) and
+ *         checks that each is reached and held, the jerk and acceleration
+ *         limits, and that the counted position follows the commanded
+ *         velocity.
+ * steps   Schedules every step of a few profiles with StepScheduler and
+ *         checks the profile position at each step time, then records the
+ *         step edges of simulated TIM2 for one move with the DMA step
+ *         engine (checked against the step times) and with PWM rate
+ *         updates (checked for one edge per step).
+ * timers  Checks the timer clocks TimerClock derives from the RCC APB
+ *         prescalers, sweeps the PSC/ARR solver over 1 Hz - 200 kHz on a
+ *         32-bit (TIM2) and a 16-bit (TIM1) step timer against its half-tick
+ *         bound and the old fixed prescaler, then runs StepperMotor on both
+ *         and measures the emitted step rate.
+ * driver  Runs the compile-time StepperDriver on the three board axes (and
+ *         an active-low enable) next to StepperMotor on the same pins and
+ *         timer: pin levels, PSC/ARR/CCR for a set of rates, the emitted
+ *         step rate, and planner moves counted from the step output.
+ * encoder Puts a shaft with a quadrature encoder (TIM3) on axis 0's step
+ *         output and loses steps: open loop the error stays, closed loop
+ *         the same move ends on target. Also runs a move that wraps the
+ *         16-bit counter, pushes the shaft at rest and stalls the motor
+ *         until the following error stops it.
+ *
+ * Every mode exits with 1 when one of its checks fails (2 for bad
+ * arguments), so CI runs each of them as a step.
+ */
+
+#include "sim_board.h"
+#include "hal/UartLogSink.hpp"
+#include "hal/CycleProfiler.hpp"
+#include "hal/LoopTimingRecorder.hpp"
+#include "hal/TimerClock.hpp"
+#include "hal/GpioPin.hpp"
+#include "comm/TelemetryProtocol.hpp"
+#include "comm/CommandReceiver.hpp"
+#include "motor/motor_control.h"
+#include "motor/MotionPlanner.hpp"
+#include "motor/SCurveProfile.hpp"
+#include "motor/SCurveStepper.hpp"
+#include "motor/StepScheduler.hpp"
+#include "motor/StepperDriver.hpp"
+#include "motor/StepperMotor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct Move {
+    float target;
+    float max_velocity;
+    float max_acceleration;
+    float max_jerk;
+};
+
+// Production test cycle from motor_control_main()
+const Move kDefaultMoves[] = {
+    { 1000.0f,  500.0f, 1000.0f,  5000.0f },
+    { -1000.0f, 1000.0f, 2000.0f, 10000.0f },
+};
+
+StepperMotor* g_motor = nullptr;
+
+StepperMotor::Config motorConfig() {
+    StepperMotor::Config config;
+    config.step_timer = &htim2;
+    config.step_channel = TIM_CHANNEL_1;
+    config.dir_port = MOTOR_DIR_GPIO_Port;
+    config.dir_pin = MOTOR_DIR_Pin;
+    config.enable_port = MOTOR_EN_GPIO_Port;
+    config.enable_pin = MOTOR_EN_Pin;
+    config.enable_active_low = false;
+    return config;
+}
+
+// Board wiring of the three axes as compile-time drivers (main.h, msp)
+using Axis0Driver = StepperDriver<2, TIM_CHANNEL_1, GpioPin<GpioPort::A, GPIO_PIN_0>,
+                                  GpioPin<GpioPort::A, MOTOR_DIR_Pin>, GpioPin<GpioPort::A, MOTOR_EN_Pin>>;
+using Axis1Driver = StepperDriver<1, TIM_CHANNEL_3, GpioPin<GpioPort::A, GPIO_PIN_10>,
+                                  GpioPin<GpioPort::C, AXIS1_DIR_Pin>, GpioPin<GpioPort::C, AXIS1_EN_Pin>>;
+using Axis2Driver = StepperDriver<5, TIM_CHANNEL_2, GpioPin<GpioPort::A, GPIO_PIN_1>,
+                                  GpioPin<GpioPort::C, AXIS2_DIR_Pin>, GpioPin<GpioPort::C, AXIS2_EN_Pin>>;
+using Axis1LowEnableDriver = StepperDriver<1, TIM_CHANNEL_3, GpioPin<GpioPort::A, GPIO_PIN_10>,
+                                           GpioPin<GpioPort::C, AXIS1_DIR_Pin>,
+                                           GpioPin<GpioPort::C, AXIS1_EN_Pin, true>>;
+
+void onSpeed(float speed) {
+    g_motor->setStepRate(speed);
+}
+
+void onDirection(bool forward) {
+    g_motor->setDirection(forward);
+}
+
+void onSpeedDiscard(float speed) {
+    (void)speed;
+}
+
+using Clock = std::chrono::steady_clock;
+
+void report(const char* name, uint64_t iterations, Clock::duration elapsed) {
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    std::printf("  %-40s %9.1f ns/call  %8.2f M calls/s\r\n",
+                name, ns / iterations, iterations * 1e3 / ns);
+}
+
+int runBench(uint64_t iterations) {
+    SimBoard_Init();
+
+    std::printf("=== Motor stack benchmark (%llu iterations) ===\r\n",
+                static_cast<unsigned long long>(iterations));
+
+    // Probes would time themselves along with the code under test
+    CycleProfiler::setEnabled(false);
+
+    SCurveProfile profile;
+    SCurveProfile::Config config = { 1000.0f, 2000.0f, 10000.0f, 0.0f };
+    profile.calculate(20000.0f, config);
+
+    volatile float sink = 0.0f;
+    const float dt = profile.getTotalTime() / static_cast<float>(iterations);
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink = sink + profile.getStateAtTime(static_cast<float>(i) * dt).velocity;
+    }
+    report("SCurveProfile::getStateAtTime", iterations, Clock::now() - start);
+
+    // Same sample points walked at a fixed tick
+    SCurveStepper stepper;
+    stepper.start(profile, dt);
+    start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink = sink + stepper.step().velocity;
+    }
+    report("SCurveStepper::step", iterations, Clock::now() - start);
+
+    // Every step of the 20000-step profile, repeated up to the iteration count
+    StepScheduler scheduler;
+    float step_time = 0.0f;
+    start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        if (!scheduler.next(step_time)) {
+            scheduler.start(profile, 20000);
+            scheduler.next(step_time);
+        }
+        sink = sink + step_time;
+    }
+    report("StepScheduler::next", iterations, Clock::now() - start);
+
+    start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        sink = sink + static_cast<float>(profile.calculate(20000.0f, config));
+    }
+    report("SCurveProfile::calculate", iterations, Clock::now() - start);
+
+    StepperMotor motor(motorConfig());
+    g_motor = &motor;
+    motor.setEnabled(true);
+
+    MotionPlanner planner;
+    planner.init(nullptr, 1000);
+    planner.setDirectionCallback(onDirection);
+
+    // Planner alone: speed output discarded
+    planner.setSpeedCallback(onSpeedDiscard);
+    planner.moveTo(1.0e9f, 1000.0f, 2000.0f, 10000.0f);
+    start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        planner.update();
+    }
+    report("MotionPlanner::update", iterations, Clock::now() - start);
+    planner.stop();
+
+    // Planner driving the TIM2 step output
+    planner.resetPosition();
+    planner.setSpeedCallback(onSpeed);
+    planner.moveTo(1.0e9f, 1000.0f, 2000.0f, 10000.0f);
+    SimHal_AdvanceCycles(SIM_SYSCLK_HZ);  // Move past the first second of ramp
+    start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        planner.update();
+    }
+    report("MotionPlanner::update + StepperMotor", iterations, Clock::now() - start);
+    planner.stop();
+
+    // Direction and rate changes: runtime class against the compile-time driver on the same pins
+    start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        motor.setDirection((i & 1U) != 0);
+    }
+    report("StepperMotor::setDirection", iterations, Clock::now() - start);
+    start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        Axis0Driver::setDirection((i & 1U) != 0);
+    }
+    report("StepperDriver::setDirection", iterations, Clock::now() - start);
+
+    motor.setStepRate(1000.0f);
+    start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        motor.setStepRate((i & 1U) ? 1000.0f : 1001.0f);
+    }
+    report("StepperMotor::setStepRate", iterations, Clock::now() - start);
+    motor.stop();
+    Axis0Driver::init();
+    Axis0Driver::setStepRate(1000.0f);
+    start = Clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        Axis0Driver::setStepRate((i & 1U) ? 1000.0f : 1001.0f);
+    }
+    report("StepperDriver::setStepRate", iterations, Clock::now() - start);
+    Axis0Driver::stop();
+
+    g_motor = nullptr;
+    return sink == 12345.0f ? 1 : 0;
+}
+
+bool loadMoves(const char* path, std::vector<Move>& moves) {
+    FILE* file = std::fopen(path, "r");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    char line[256];
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        Move move;
+        if (std::sscanf(line, "%f,%f,%f,%f", &move.target, &move.max_velocity,
+                        &move.max_acceleration, &move.max_jerk) == 4) {
+            moves.push_back(move);
+        }
+    }
+    std::fclose(file);
+    return true;
+}
+
+int runReplay(const std::vector<Move>& moves, FILE* trace, bool dma_engine) {
+    SimBoard_Init();
+
+    std::printf("=== Replaying %zu moves on simulated TIM2/TIM4 (%s) ===\r\n", moves.size(),
+                dma_engine ? "DMA step engine" : "PWM rate updates");
+
+    motor_control_init();
+    motor_use_step_engine(dma_engine);
+    motor_enable(true);
+
+    if (trace) {
+        std::fprintf(trace, "time_ms,move,position,planner_vel,pulses\n");
+    }
+
+    int64_t pulse_position = 0;
+    float commanded = 0.0f;
+    int result = 0;
+
+    for (size_t i = 0; i < moves.size(); i++) {
+        const Move& move = moves[i];
+        const uint64_t pulses_before = SimHal_TimerPulseCount(TIM2, TIM_CHANNEL_1);
+        const uint64_t truncated_before = SimHal_TimerTruncatedCount(TIM2, TIM_CHANNEL_1);
+        const uint32_t start_ms = HAL_GetTick();
+
+        if (!motor_move_to(move.target, move.max_velocity, move.max_acceleration, move.max_jerk)) {
+            std::printf("  move %zu: rejected by planner\r\n", i);
+            result = 1;
+            continue;
+        }
+
+        // The planner runs in the TIM4 interrupt; the main loop just waits
+        const uint32_t timeout_ms = start_ms + 600000U;
+        while (motor_is_moving() && HAL_GetTick() < timeout_ms) {
+            SimHal_AdvanceCycles(SIM_SYSCLK_HZ / 1000U);
+            if (trace) {
+                std::fprintf(trace, "%lu,%zu,%.3f,%.3f,%llu\n",
+                             static_cast<unsigned long>(HAL_GetTick()), i,
+                             motor_get_position(), motor_get_velocity(),
+                             static_cast<unsigned long long>(SimHal_TimerPulseCount(TIM2, TIM_CHANNEL_1)));
+            }
+        }
+
+        const uint64_t pulses = SimHal_TimerPulseCount(TIM2, TIM_CHANNEL_1) - pulses_before;
+        const uint64_t truncated = SimHal_TimerTruncatedCount(TIM2, TIM_CHANNEL_1) - truncated_before;
+        const float distance = move.target - commanded;
+        const bool forward = (SimHal_GPIOA.ODR & MOTOR_DIR_Pin) != 0;
+        pulse_position += forward ? static_cast<int64_t>(pulses) : -static_cast<int64_t>(pulses);
+        commanded = move.target;
+
+        std::printf("  move %zu: %+9.1f steps in %6lu ms | pulses %7llu (truncated %llu) | error %+lld\r\n",
+                    i, distance, static_cast<unsigned long>(HAL_GetTick() - start_ms),
+                    static_cast<unsigned long long>(pulses), static_cast<unsigned long long>(truncated),
+                    static_cast<long long>(pulse_position - static_cast<int64_t>(std::lround(commanded))));
+        // Steps fall on the half steps, so each move makes exactly its distance
+        if (pulses != static_cast<uint64_t>(std::llround(std::fabs(distance))) || truncated != 0) {
+            result = 1;
+        }
+    }
+
+    // The position is counted by TIM9, so it must match the pulses exactly
+    const float counted = motor_get_position();
+    std::printf("Final: commanded %.1f, counted %.1f, emitted %lld steps\r\n",
+                commanded, counted, static_cast<long long>(pulse_position));
+    if (std::llround(counted) != pulse_position) {
+        result = 1;
+    }
+
+    motor_enable(false);
+    return result;
+}
+
+struct AxisOutput {
+    const char* name;
+    const TIM_TypeDef* timer;
+    uint32_t channel;
+    GPIO_TypeDef* dir_port;
+    uint16_t dir_pin;
+};
+
+const AxisOutput kAxisOutputs[] = {
+    { "TIM2 CH1", TIM2, TIM_CHANNEL_1, MOTOR_DIR_GPIO_Port, MOTOR_DIR_Pin },
+    { "TIM1 CH3", TIM1, TIM_CHANNEL_3, AXIS1_DIR_GPIO_Port, AXIS1_DIR_Pin },
+    { "TIM5 CH2", TIM5, TIM_CHANNEL_2, AXIS2_DIR_GPIO_Port, AXIS2_DIR_Pin },
+};
+constexpr uint32_t kAxisOutputCount = sizeof(kAxisOutputs) / sizeof(kAxisOutputs[0]);
+
+int runAxes(const float* targets) {
+    SimBoard_Init();
+    motor_control_init();
+
+    const uint32_t axes = std::min(motor_axis_count(), kAxisOutputCount);
+    std::printf("=== Coordinated move on %lu axes ===\r\n", static_cast<unsigned long>(axes));
+
+    motor_axes_enable(true);
+    const uint64_t start_cycle = SimHal_GetCycles();
+    if (!motor_axes_move_to(targets, 1000.0f, 2000.0f, 10000.0f)) {
+        std::printf("  move rejected by coordinator\r\n");
+        return 1;
+    }
+
+    // Time each axis' output goes quiet: its last pulse ends the axis' move
+    uint64_t last_pulses[kAxisOutputCount] = {};
+    uint64_t finish_cycle[kAxisOutputCount] = {};
+    const uint32_t timeout_ms = HAL_GetTick() + 600000U;
+    while (motor_axes_are_moving() && HAL_GetTick() < timeout_ms) {
+        SimHal_AdvanceMicros(100);
+        for (uint32_t i = 0; i < axes; i++) {
+            const uint64_t pulses = SimHal_TimerPulseCount(kAxisOutputs[i].timer, kAxisOutputs[i].channel);
+            if (pulses != last_pulses[i]) {
+                last_pulses[i] = pulses;
+                finish_cycle[i] = SimHal_GetCycles();
+            }
+        }
+    }
+
+    int result = motor_axes_are_moving() ? 1 : 0;
+    // An idle master never starts; its slaves are then started together
+    uint32_t reference = 0;
+    while (reference + 1 < axes && std::lround(targets[reference]) == 0) {
+        reference++;
+    }
+    const uint64_t master_start = SimHal_TimerStartCycle(kAxisOutputs[reference].timer);
+    for (uint32_t i = 0; i < axes; i++) {
+        const AxisOutput& out = kAxisOutputs[i];
+        const bool forward = (out.dir_port->ODR & out.dir_pin) != 0;
+        const int64_t pulses = static_cast<int64_t>(SimHal_TimerPulseCount(out.timer, out.channel));
+        const int64_t emitted = forward ? pulses : -pulses;
+        const long long error = emitted - std::lround(targets[i]);
+        std::printf("  axis %lu (%s): target %+8.1f | emitted %+6lld (error %+lld) | "
+                    "counter start %+lld cycles vs master | last pulse %6.1f ms\r\n",
+                    static_cast<unsigned long>(i), out.name, targets[i],
+                    static_cast<long long>(emitted), error,
+                    static_cast<long long>(SimHal_TimerStartCycle(out.timer) - master_start),
+                    (finish_cycle[i] - start_cycle) * 1e3 / SIM_SYSCLK_HZ);
+        // Every axis makes exactly its steps, on the master's time base
+        if (error != 0 ||
+            (std::lround(targets[i]) != 0 && SimHal_TimerStartCycle(out.timer) != master_start)) {
+            result = 1;
+        }
+        // Axis 0 reports what its step counter (TIM9) saw
+        if (i == 0 && std::lround(motor_axis_get_position(0)) != emitted) {
+            std::printf("  axis 0 step counter: %+.1f, expected %+lld\r\n", motor_axis_get_position(0),
+                        static_cast<long long>(emitted));
+            result = 1;
+        }
+    }
+
+    motor_axes_enable(false);
+    return result;
+}
+
+int runQueuedReplay(const std::vector<Move>& moves, bool dma_engine) {
+    SimBoard_Init();
+
+    std::printf("=== Queueing %zu moves on simulated TIM2/TIM4 (%s) ===\r\n", moves.size(),
+                dma_engine ? "DMA step engine" : "PWM rate updates");
+
+    motor_control_init();
+    motor_use_step_engine(dma_engine);
+    motor_enable(true);
+
+    int64_t pulse_position = 0;
+    int result = 0;
+    const uint32_t start_ms = HAL_GetTick();
+    const uint32_t timeout_ms = start_ms + 600000U;
+    size_t next = 0;
+    uint32_t max_depth = 0;
+    uint64_t last_pulses = 0;
+
+    while ((next < moves.size() || motor_is_moving()) && HAL_GetTick() < timeout_ms) {
+        // Keep the queue topped up; the planner chains moves in its ISR
+        while (next < moves.size()) {
+            const Move& move = moves[next];
+            if (!motor_queue_move(move.target, move.max_velocity, move.max_acceleration, move.max_jerk)) {
+                if (motor_queue_depth() < MotionPlanner::QUEUE_CAPACITY) {
+                    std::printf("  move %zu: rejected by planner\r\n", next);
+                    result = 1;
+                    next++;
+                    continue;
+                }
+                break;
+            }
+            next++;
+        }
+        max_depth = std::max(max_depth, motor_queue_depth());
+
+        SimHal_AdvanceCycles(SIM_SYSCLK_HZ / 10000U);
+
+        // Direction only changes between moves, at rest: a move's last step
+        // is half a step before its end, the next one's first at its start
+        const uint64_t pulses = SimHal_TimerPulseCount(TIM2, TIM_CHANNEL_1);
+        const int64_t delta = static_cast<int64_t>(pulses - last_pulses);
+        const bool forward = (SimHal_GPIOA.ODR & MOTOR_DIR_Pin) != 0;
+        pulse_position += forward ? delta : -delta;
+        last_pulses = pulses;
+    }
+
+    const float commanded = moves.empty() ? 0.0f : moves.back().target;
+    std::printf("  %zu moves in %lu ms, max queue depth %lu\r\n", moves.size(),
+                static_cast<unsigned long>(HAL_GetTick() - start_ms), static_cast<unsigned long>(max_depth));
+    const float counted = motor_get_position();
+    std::printf("Final: commanded %.1f, counted %.1f, emitted %lld steps (error %+lld)\r\n",
+                commanded, counted, static_cast<long long>(pulse_position),
+                static_cast<long long>(pulse_position - std::lround(commanded)));
+    // Profiles are planned by motor_queue_move(); a start in the ISR copies
+    // one (and fills the first DMA table in engine mode)
+    const CycleProfiler::Stats starts = CycleProfiler::getStats(CycleProfiler::Probe::MOVE_START);
+    const CycleProfiler::Stats updates = CycleProfiler::getStats(CycleProfiler::Probe::PLANNER_UPDATE);
+    std::printf("  MOVE_START %lu, max %lu ns; PLANNER_UPDATE max %lu ns (host time)\r\n",
+                static_cast<unsigned long>(starts.count), static_cast<unsigned long>(starts.max),
+                static_cast<unsigned long>(updates.max));
+
+    motor_enable(false);
+    return (motor_is_moving() || std::llround(counted) != pulse_position ||
+            pulse_position != std::lround(commanded)) ? 1 : result;
+}
+
+int runLog(uint32_t lines_per_sec) {
+    SimBoard_Init();
+    SimHal_UartCaptureEnable(true);
+
+    std::printf("=== Logging %lu lines/s through the USART2 DMA sink (%lu baud) ===\r\n",
+                static_cast<unsigned long>(lines_per_sec), static_cast<unsigned long>(huart2.Init.BaudRate));
+
+    UartLogSink& sink = UartLogSink::console();
+    const uint64_t period = SIM_SYSCLK_HZ / lines_per_sec;
+    const uint64_t end = SimHal_GetCycles() + SIM_SYSCLK_HZ;
+    uint32_t written = 0;
+    uint32_t accepted = 0;
+    uint64_t bytes_offered = 0;
+    Clock::duration write_time{};
+
+    while (SimHal_GetCycles() < end) {
+        char line[64];
+        const int length = std::snprintf(line, sizeof(line), "log %06lu t=%lu ms pos=%+.1f\r\n",
+                                         static_cast<unsigned long>(written),
+                                         static_cast<unsigned long>(HAL_GetTick()), written * 0.5f);
+        const auto start = Clock::now();
+        if (sink.write(line, static_cast<uint32_t>(length))) {
+            accepted++;
+        }
+        write_time += Clock::now() - start;
+        bytes_offered += static_cast<uint64_t>(length);
+        written++;
+        SimHal_AdvanceCycles(period);
+    }
+    const uint64_t sent_in_window = SimHal_UartTxBytes();
+    const bool drained = sink.flush(1000);
+
+    // Every received line must be whole and numbered above the previous one
+    const char* data = reinterpret_cast<const char*>(SimHal_UartCaptureData());
+    const uint32_t size = SimHal_UartCaptureCount();
+    uint32_t received = 0;
+    long last = -1;
+    bool intact = true;
+    for (uint32_t pos = 0; pos < size;) {
+        const char* eol = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+        unsigned long number = 0;
+        if (eol == nullptr || std::sscanf(data + pos, "log %lu ", &number) != 1 ||
+            static_cast<long>(number) <= last) {
+            intact = false;
+            break;
+        }
+        last = static_cast<long>(number);
+        received++;
+        pos = static_cast<uint32_t>(eol - data) + 1U;
+    }
+
+    const double link_bytes_per_sec = huart2.Init.BaudRate / 10.0;
+    std::printf("  lines written %lu, accepted %lu, received %lu, dropped %lu (%lu bytes)\r\n",
+                static_cast<unsigned long>(written), static_cast<unsigned long>(accepted),
+                static_cast<unsigned long>(received), static_cast<unsigned long>(sink.getDroppedWrites()),
+                static_cast<unsigned long>(sink.getDroppedBytes()));
+    std::printf("  offered %.0f B/s, sent %.0f B/s of %.0f B/s link capacity\r\n",
+                static_cast<double>(bytes_offered), static_cast<double>(sent_in_window), link_bytes_per_sec);
+    std::printf("  write(): %.0f ns host time per call, no virtual time (blocking _write: %.1f ms\r\n"
+                "  of caller time per second of this output)\r\n",
+                std::chrono::duration<double, std::nano>(write_time).count() / written,
+                1e3 * static_cast<double>(bytes_offered) / link_bytes_per_sec);
+    std::printf("  %s, %s\r\n", intact ? "lines intact and in order" : "CORRUPTED OUTPUT",
+                drained ? "buffer drained" : "buffer NOT drained");
+
+    return (intact && drained && received == accepted) ? 0 : 1;
+}
+
+/**
+ * @brief Split captured USART2 output at delimiters and decode it, as SerialComm does
+ * @param handle Called with each valid frame's payload; returns false to count it as bad
+ * @return Candidate frames that failed to decode or were rejected by handle
+ */
+template <typename Handler>
+uint32_t decodeFrames(const uint8_t* data, uint32_t size, Handler handle) {
+    uint32_t bad_frames = 0;
+    uint32_t chunk_start = 0;
+    bool in_frame = false;
+    for (uint32_t pos = 0; pos < size; pos++) {
+        if (data[pos] != TelemetryProtocol::DELIMITER) {
+            continue;
+        }
+        if (in_frame && pos > chunk_start) {
+            uint8_t payload[TelemetryProtocol::MAX_PAYLOAD + 2];
+            const size_t length =
+                TelemetryProtocol::decodeFrame(&data[chunk_start], pos - chunk_start, payload, sizeof(payload));
+            if (length > 0 && handle(payload, length)) {
+                in_frame = false;
+            } else {
+                bad_frames++;
+            }
+        } else {
+            in_frame = true;
+        }
+        chunk_start = pos + 1;
+    }
+    return bad_frames;
+}
+
+int runTelemetry(const std::vector<Move>& moves) {
+    // The firmware's former "DATA,..." printf stream at 115200 baud
+    constexpr double kTextSamplesPerSec = 150.0;
+    constexpr double kRequiredGain = 5.0;
+
+    SimBoard_Init();
+    SimHal_UartCaptureEnable(true);
+
+    std::printf("=== Streaming telemetry for %zu moves (%lu baud) ===\r\n", moves.size(),
+                static_cast<unsigned long>(huart2.Init.BaudRate));
+
+    motor_control_init();
+    motor_enable(true);
+
+    const uint32_t start_ms = HAL_GetTick();
+    for (const Move& move : moves) {
+        if (!motor_move_to(move.target, move.max_velocity, move.max_acceleration, move.max_jerk)) {
+            std::printf("  move to %.1f rejected\r\n", move.target);
+            return 1;
+        }
+        while (motor_is_moving()) {
+            motor_telemetry_service();
+            SimHal_AdvanceMicros(500);
+        }
+    }
+    for (int i = 0; i < 100; i++) {
+        motor_telemetry_service();
+        SimHal_AdvanceMicros(500);
+    }
+    const uint32_t elapsed_ms = HAL_GetTick() - start_ms;
+    UartLogSink::console().flush(1000);
+    motor_enable(false);
+
+    std::vector<TelemetryProtocol::Sample> samples;
+    uint32_t frames = 0, gaps = 0;
+    const uint32_t bad_frames = decodeFrames(
+        SimHal_UartCaptureData(), SimHal_UartCaptureCount(), [&](const uint8_t* payload, size_t length) {
+            TelemetryProtocol::Sample batch[TelemetryProtocol::MAX_BATCH_SAMPLES];
+            const uint32_t count =
+                TelemetryProtocol::decodeTelemetry(payload, length, batch, TelemetryProtocol::MAX_BATCH_SAMPLES);
+            // Samples are contiguous across frames unless one was lost
+            for (uint32_t i = 0; i < count; i++) {
+                if (samples.size() >= 2 &&
+                    batch[i].time_us - samples.back().time_us != samples[1].time_us - samples[0].time_us) {
+                    gaps++;
+                }
+                samples.push_back(batch[i]);
+            }
+            if (count > 0) {
+                frames++;
+                return true;
+            }
+            // Loop timing reports share the link
+            return TelemetryProtocol::getType(payload) == TelemetryProtocol::MessageType::LOOP_TIMING;
+        });
+    const uint32_t size = SimHal_UartCaptureCount();
+
+    // The same samples as the GUI's text format
+    uint64_t text_bytes = 0;
+    for (const auto& s : samples) {
+        char line[128];
+        text_bytes += static_cast<uint64_t>(std::snprintf(
+            line, sizeof(line), "DATA,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%u\r\n", s.time_us / 1000.0f, s.target_position,
+            s.actual_position, s.target_velocity, s.actual_velocity, s.pid_output, s.phase));
+    }
+
+    if (samples.empty()) {
+        std::printf("  no telemetry received\r\n");
+        return 1;
+    }
+    const double link = huart2.Init.BaudRate / 10.0;
+    const double binary_per_sample = static_cast<double>(size) / samples.size();
+    const double text_per_sample = static_cast<double>(text_bytes) / samples.size();
+    std::printf("  %zu samples in %lu frames over %lu ms (%lu bad frames, %lu gaps, %lu dropped in firmware)\r\n",
+                samples.size(), static_cast<unsigned long>(frames), static_cast<unsigned long>(elapsed_ms),
+                static_cast<unsigned long>(bad_frames), static_cast<unsigned long>(gaps),
+                static_cast<unsigned long>(motor_telemetry_dropped()));
+    std::printf("  binary %.1f bytes/sample -> %.0f samples/s max; text %.1f bytes/sample -> %.0f samples/s max (%.1fx)\r\n",
+                binary_per_sample, link / binary_per_sample, text_per_sample, link / text_per_sample,
+                text_per_sample / binary_per_sample);
+    const double rate = samples.size() * 1000.0 / elapsed_ms;
+    const bool rate_ok = rate >= kRequiredGain * kTextSamplesPerSec && motor_telemetry_dropped() == 0;
+    std::printf("  streamed %.0f samples/s, %.1fx the %.0f/s text stream  %s\r\n", rate, rate / kTextSamplesPerSec,
+                kTextSamplesPerSec, rate_ok ? "OK" : "FAIL");
+    std::printf("  last sample: pos %.2f (counted %.2f), phase %u\r\n", samples.back().actual_position,
+                motor_get_position(), samples.back().phase);
+
+    return (bad_frames == 0 && gaps == 0 && rate_ok &&
+            std::fabs(samples.back().actual_position - motor_get_position()) < 0.02f) ? 0 : 1;
+}
+
+int runCommand() {
+    using Opcode = TelemetryProtocol::CommandOpcode;
+    using Status = TelemetryProtocol::AckStatus;
+    constexpr uint32_t kLoopMicros = 20;  // Main loop pass
+
+    SimBoard_Init();
+    SimHal_UartCaptureEnable(true);
+    std::printf("=== GUI command session over USART2 RX DMA (%lu baud) ===\r\n",
+                static_cast<unsigned long>(huart2.Init.BaudRate));
+    motor_control_init();
+
+    // The command-mode main loop of motor_control_main()
+    auto runFor = [](uint32_t ms) {
+        const uint32_t start = HAL_GetTick();
+        while (HAL_GetTick() - start < ms) {
+            motor_command_service();
+            motor_telemetry_service();
+            SimHal_AdvanceMicros(kLoopMicros);
+        }
+    };
+    auto runUntilStopped = [&]() {
+        runFor(5);  // Let the last frame arrive (~2 ms on the wire)
+        while (motor_is_moving()) {
+            runFor(10);
+        }
+    };
+
+    struct Expected {
+        uint8_t sequence;
+        Opcode opcode;
+        Status status;
+    };
+    std::vector<Expected> expected;
+    uint8_t sequence = 0;
+    auto send = [&](Opcode opcode, std::initializer_list<float> args, Status status, bool corrupt = false) {
+        TelemetryProtocol::Command command{};
+        command.sequence = sequence++;
+        command.opcode = opcode;
+        for (const float arg : args) {
+            command.args[command.arg_count++] = arg;
+        }
+        uint8_t frame[TelemetryProtocol::MAX_FRAME];
+        const size_t length = TelemetryProtocol::encodeCommand(command, frame, sizeof(frame));
+        if (corrupt) {
+            frame[length / 2] ^= 0x10;  // Still no zero byte, so only the CRC can tell
+        } else {
+            expected.push_back({ command.sequence, opcode, status });
+        }
+        SimHal_UartInject(frame, static_cast<uint32_t>(length));
+    };
+
+    send(Opcode::GET_VERSION, {}, Status::OK);
+    send(Opcode::START, {}, Status::REJECTED);              // Nothing planned yet
+    send(Opcode::MOVE, { 0.0f, 500.0f, 1000.0f }, Status::BAD_ARGS);
+    send(Opcode::MOVE, { 1000.0f, 500.0f, 1000.0f }, Status::OK);
+    send(Opcode::SET_GAINS, { 1.0f, 0.1f, 0.05f, 0.8f }, Status::OK);
+    send(Opcode::HOME, {}, Status::REJECTED);
+    send(static_cast<Opcode>(0x7F), {}, Status::UNKNOWN);
+    runFor(20);
+
+    // Repeated moves; each START is timed to its first control tick
+    for (int i = 0; i < 4; i++) {
+        send(Opcode::START, {}, Status::OK);
+        runUntilStopped();
+        SimHal_AdvanceMicros(static_cast<uint32_t>(230 * i));  // Vary the phase against the control loop
+    }
+    const float after_moves = motor_get_position();
+    const int64_t pulses_moves = static_cast<int64_t>(SimHal_TimerPulseCount(TIM2, TIM_CHANNEL_1));
+
+    // Console text and a corrupted frame on the line, then a stop mid-move
+    const char text[] = "hello from a terminal\r\n";
+    SimHal_UartInject(reinterpret_cast<const uint8_t*>(text), sizeof(text) - 1);
+    send(Opcode::GET_VERSION, {}, Status::OK, true);
+    send(Opcode::MOVE, { -2000.0f, 1000.0f, 2000.0f, 10000.0f }, Status::OK);
+    send(Opcode::START, {}, Status::OK);
+    runFor(300);
+    send(Opcode::STOP, {}, Status::OK);
+    runUntilStopped();
+    const float after_stop = motor_get_position();
+    const int64_t pulses_stop = 2 * pulses_moves - static_cast<int64_t>(SimHal_TimerPulseCount(TIM2, TIM_CHANNEL_1));
+
+    // Burst that wraps the receive buffer several times
+    for (int i = 0; i < 60; i++) {
+        send(Opcode::GET_VERSION, {}, Status::OK);
+    }
+    send(Opcode::ESTOP, {}, Status::OK);
+    runFor(200);
+    UartLogSink::console().flush(1000);
+
+    // Check the ACKs against what was sent
+    std::vector<TelemetryProtocol::Ack> acks;
+    const uint32_t bad_frames = decodeFrames(
+        SimHal_UartCaptureData(), SimHal_UartCaptureCount(), [&](const uint8_t* payload, size_t length) {
+            TelemetryProtocol::Ack ack;
+            if (TelemetryProtocol::getType(payload) == TelemetryProtocol::MessageType::ACK &&
+                TelemetryProtocol::decodeAck(payload, length, ack)) {
+                acks.push_back(ack);
+            }
+            return true;
+        });
+    uint32_t mismatches = (acks.size() == expected.size()) ? 0 : 1;
+    for (size_t i = 0; i < std::min(acks.size(), expected.size()); i++) {
+        if (acks[i].sequence != expected[i].sequence || acks[i].opcode != expected[i].opcode ||
+            acks[i].status != expected[i].status) {
+            mismatches++;
+        }
+    }
+
+    const CommandReceiver& receiver = CommandReceiver::console();
+    const uint32_t control_period_us = static_cast<uint32_t>(1e6f / MotionPlanner::MIN_UPDATE_FREQ_HZ);
+    const uint32_t bound_us = control_period_us + kLoopMicros;
+    std::printf("  %zu of %zu ACKs as expected (%lu mismatches, %lu bad frames on TX)\r\n",
+                acks.size() - std::min<size_t>(mismatches, acks.size()), expected.size(),
+                static_cast<unsigned long>(mismatches), static_cast<unsigned long>(bad_frames));
+    std::printf("  receiver: %lu frame errors (1 corrupted frame sent), %lu overruns\r\n",
+                static_cast<unsigned long>(receiver.getFrameErrors()),
+                static_cast<unsigned long>(receiver.getOverruns()));
+    std::printf("  positions: %.1f after 4 x START of +1000, %.1f after STOP of a -2000 move "
+                "(emitted %lld, %lld)\r\n", after_moves, after_stop, static_cast<long long>(pulses_moves),
+                static_cast<long long>(pulses_stop));
+    std::printf("  command-to-motion latency: last %lu us, max %lu us (bound %lu us = control period %lu + loop "
+                "pass %lu, from the idle-line event)\r\n",
+                static_cast<unsigned long>(motor_command_latency_us()),
+                static_cast<unsigned long>(motor_command_latency_max_us()), static_cast<unsigned long>(bound_us),
+                static_cast<unsigned long>(control_period_us), static_cast<unsigned long>(kLoopMicros));
+
+    // Positions are counted pulses, exactly the moves' distance
+    const bool ok = mismatches == 0 && bad_frames == 0 && receiver.getFrameErrors() == 1 &&
+                    receiver.getOverruns() == 0 && std::lround(after_moves) == 4000 &&
+                    std::llround(after_moves) == pulses_moves && std::llround(after_stop) == pulses_stop &&
+                    after_stop < after_moves && after_stop > after_moves - 2000.0f &&
+                    motor_command_latency_max_us() <= bound_us;
+    return ok ? 0 : 1;
+}
+
+int runProfile(const std::vector<Move>& moves) {
+    using Opcode = TelemetryProtocol::CommandOpcode;
+    using Status = TelemetryProtocol::AckStatus;
+
+    SimBoard_Init();
+    SimHal_UartCaptureEnable(true);
+    std::printf("=== Execution time probes (host std::chrono back end) ===\r\n");
+    motor_control_init();
+    motor_enable(true);
+
+    auto runUntilStopped = [](bool axes) {
+        while (axes ? motor_axes_are_moving() : motor_is_moving()) {
+            motor_command_service();
+            motor_telemetry_service();
+            SimHal_AdvanceMicros(100);
+        }
+    };
+    // Queued, so the control loop starts each move (MOVE_START)
+    bool accepted = true;
+    for (const Move& move : moves) {
+        accepted = motor_queue_move(move.target, move.max_velocity, move.max_acceleration, move.max_jerk) && accepted;
+        runUntilStopped(false);
+    }
+    motor_axes_enable(true);
+    const float targets[] = { 1000.0f, 500.0f, -250.0f };
+    accepted = motor_axes_move_to(targets, 1000.0f, 2000.0f, 10000.0f) && accepted;
+    runUntilStopped(true);
+
+    // Report on request, as the GUI asks for it
+    TelemetryProtocol::Command command{};
+    command.opcode = Opcode::GET_PROFILE;
+    uint8_t frame[TelemetryProtocol::MAX_FRAME];
+    const size_t length = TelemetryProtocol::encodeCommand(command, frame, sizeof(frame));
+    SimHal_UartInject(frame, static_cast<uint32_t>(length));
+    const uint32_t start = HAL_GetTick();
+    while (HAL_GetTick() - start < 20) {
+        motor_command_service();
+        motor_telemetry_service();
+        SimHal_AdvanceMicros(20);
+    }
+    UartLogSink::console().flush(1000);
+
+    bool acked = false;
+    uint32_t loop_max = 0;
+    decodeFrames(SimHal_UartCaptureData(), SimHal_UartCaptureCount(), [&](const uint8_t* payload, size_t size) {
+        TelemetryProtocol::Ack ack;
+        if (TelemetryProtocol::getType(payload) == TelemetryProtocol::MessageType::ACK &&
+            TelemetryProtocol::decodeAck(payload, size, ack) && ack.opcode == Opcode::GET_PROFILE) {
+            acked = ack.status == Status::OK;
+            loop_max = ack.value;
+        }
+        return true;
+    });
+
+    // Every probe on the control path must have seen the moves
+    uint32_t silent = 0;
+    for (uint32_t i = 0; i < CycleProfiler::PROBE_COUNT; i++) {
+        if (CycleProfiler::getStats(static_cast<CycleProfiler::Probe>(i)).count == 0) {
+            std::printf("  no measurements for %s\r\n", CycleProfiler::getName(static_cast<CycleProfiler::Probe>(i)));
+            silent++;
+        }
+    }
+    std::printf("  GET_PROFILE ACK: %s, control loop max %lu ns%s\r\n", acked ? "OK" : "missing",
+                static_cast<unsigned long>(loop_max), accepted ? "" : ", a move was rejected");
+    // Host timings include preemption by the OS, so the budget line is informative only
+    return (acked && accepted && silent == 0) ? 0 : 1;
+}
+
+void printLoopTiming(const LoopTimingRecorder::Snapshot& s) {
+    std::printf("  %lu iterations, jitter %ld..%ld cycles, max duration %lu, %lu misses, %lu lost ticks\r\n",
+                static_cast<unsigned long>(s.iterations), static_cast<long>(s.jitter_min),
+                static_cast<long>(s.jitter_max), static_cast<unsigned long>(s.duration_max),
+                static_cast<unsigned long>(s.misses), static_cast<unsigned long>(s.lost_ticks));
+    std::printf("  worst miss: iteration %lu, %ld cycles late, ran %lu, context 0x%lx\r\n  |jitter| log2 bins:",
+                static_cast<unsigned long>(s.worst_iteration), static_cast<long>(s.worst_lateness),
+                static_cast<unsigned long>(s.worst_duration), static_cast<unsigned long>(s.worst_context));
+    for (uint32_t bin = 0; bin < LoopTimingRecorder::HISTOGRAM_BINS; bin++) {
+        if (s.histogram[bin] != 0) {
+            std::printf(" %lu:%lu", static_cast<unsigned long>(bin), static_cast<unsigned long>(s.histogram[bin]));
+        }
+    }
+    std::printf("\r\n");
+}
+
+int runJitter(const std::vector<Move>& moves) {
+    constexpr uint32_t kPeriod = SIM_SYSCLK_HZ / 1000U;  // 1 kHz control loop
+    constexpr uint32_t kLatency = 12;                     // Interrupt entry
+    constexpr uint32_t kDuration = 2000;
+
+    // Scripted schedule, starting near the CYCCNT wrap
+    std::printf("=== Loop timing recorder, scripted schedule (period %lu cycles) ===\r\n",
+                static_cast<unsigned long>(kPeriod));
+    LoopTimingRecorder recorder;
+    recorder.start(kPeriod);
+    const uint32_t base = 0xFFF00000U;
+    uint32_t next_entry = base + kLatency;
+    uint32_t tick = 0;
+    for (uint32_t i = 0; i < 1000; i++) {
+        uint32_t entry = base + tick * kPeriod + kLatency;
+        uint32_t duration = kDuration;
+        if (i == 200) {
+            entry += 30000;                    // Interrupts masked for a while
+        } else if (i == 400) {
+            duration = kPeriod + 6000;         // Overrun: misses its deadline
+        } else if (i == 600) {
+            tick += 2;                         // Stall: two updates lost
+            entry = base + tick * kPeriod + kLatency + kPeriod / 2;
+        }
+        if (static_cast<int32_t>(next_entry - entry) > 0) {
+            entry = next_entry;  // Update pending behind an overrun
+        }
+        recorder.onEntry(entry);
+        recorder.onExit(entry + duration, i);
+        next_entry = entry + duration + kLatency;
+        tick++;
+    }
+    const LoopTimingRecorder::Snapshot scripted = recorder.getSnapshot();
+    printLoopTiming(scripted);
+    const bool scripted_ok = scripted.iterations == 1000 && scripted.misses == 1 && scripted.lost_ticks == 2 &&
+                             scripted.worst_iteration == 400 && scripted.worst_context == 400 &&
+                             scripted.worst_lateness == 6000 && scripted.duration_max == kPeriod + 6000;
+    std::printf("  %s\r\n", scripted_ok ? "as scripted" : "NOT AS SCRIPTED");
+
+    // Firmware: the TIM4 control loop reporting over USART2
+    SimBoard_Init();
+    SimHal_UartCaptureEnable(true);
+    std::printf("=== LOOP_TIMING frames from the firmware for %zu moves ===\r\n", moves.size());
+    motor_control_init();
+    motor_enable(true);
+    const uint32_t start_ms = HAL_GetTick();
+    bool accepted = true;
+    for (const Move& move : moves) {
+        accepted = motor_move_to(move.target, move.max_velocity, move.max_acceleration, move.max_jerk) && accepted;
+        while (motor_is_moving()) {
+            motor_telemetry_service();
+            SimHal_AdvanceMicros(500);
+        }
+    }
+    while (HAL_GetTick() - start_ms < 6000) {
+        motor_telemetry_service();
+        SimHal_AdvanceMicros(500);
+    }
+    UartLogSink::console().flush(1000);
+
+    uint32_t reports = 0;
+    TelemetryProtocol::LoopTiming last = {};
+    decodeFrames(SimHal_UartCaptureData(), SimHal_UartCaptureCount(), [&](const uint8_t* payload, size_t length) {
+        if (TelemetryProtocol::decodeLoopTiming(payload, length, last)) {
+            reports++;
+        }
+        return true;
+    });
+    std::printf("  %lu reports, last: %lu iterations at %lu cycles, jitter %ld..%ld, %lu misses, %lu lost ticks\r\n",
+                static_cast<unsigned long>(reports), static_cast<unsigned long>(last.iterations),
+                static_cast<unsigned long>(last.period_cycles), static_cast<long>(last.jitter_min),
+                static_cast<long>(last.jitter_max), static_cast<unsigned long>(last.misses),
+                static_cast<unsigned long>(last.lost_ticks));
+    const bool firmware_ok = accepted && reports >= 5 && last.period_cycles == kPeriod &&
+                             last.iterations >= 5000 && last.misses == 0 && last.lost_ticks == 0;
+    return (scripted_ok && firmware_ok) ? 0 : 1;
+}
+
+int runStop() {
+    constexpr float kDistance = 3000.0f;
+    constexpr float kVelocity = 1000.0f;
+    constexpr float kAcceleration = 2000.0f;
+    constexpr float kJerk = 10000.0f;
+    constexpr float kTick = 1.0e-3f;  // Control period
+    // Second differences of float velocities near kVelocity are only good to a few ulps
+    constexpr float kJerkSlack = 4.0f * kVelocity * FLT_EPSILON / (kTick * kTick);
+    // Stop points (ms into the move): jerk-up, constant accel, jerk-down,
+    // cruise, decel jerk-up, constant decel, final jerk-down
+    const uint32_t kStopAfterMs[] = { 50, 250, 520, 1500, 3050, 3300, 3580 };
+
+    SimBoard_Init();
+    std::printf("=== Decelerating stops (%.0f steps at %.0f/s, %.0f/s^2, %.0f/s^3) ===\r\n", kDistance, kVelocity,
+                kAcceleration, kJerk);
+    motor_control_init();
+    motor_enable(true);
+
+    auto runMs = [](uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            motor_command_service();
+            SimHal_AdvanceMicros(1000);
+        }
+    };
+
+    bool ok = true;
+    float direction = 1.0f;
+    for (const uint32_t stop_ms : kStopAfterMs) {
+        const float start = motor_get_position();
+        const uint64_t pulses_before = SimHal_TimerPulseCount(TIM2, TIM_CHANNEL_1);
+        ok = motor_move_to(start + direction * kDistance, kVelocity, kAcceleration, kJerk) && ok;
+        runMs(stop_ms);
+        if (!motor_decelerate_to_stop()) {
+            std::printf("  %4lu ms: no ramp\r\n", static_cast<unsigned long>(stop_ms));
+            ok = false;
+            continue;
+        }
+
+        // Commanded velocity once per control tick until rest
+        std::vector<float> velocity = { std::fabs(motor_get_velocity()) };
+        const float v_stop = velocity.back();
+        while (motor_is_moving() && velocity.size() < 10000) {
+            runMs(1);
+            velocity.push_back(std::fabs(motor_get_velocity()));
+        }
+        float accel_max = 0.0f;
+        float jerk_max = 0.0f;
+        for (size_t i = 1; i < velocity.size(); i++) {
+            const float accel = (velocity[i] - velocity[i - 1]) / kTick;
+            accel_max = std::max(accel_max, std::fabs(accel));
+            // The last tick may cut a ramp short at rest
+            if (i >= 2 && i + 1 < velocity.size()) {
+                const float previous = (velocity[i - 1] - velocity[i - 2]) / kTick;
+                jerk_max = std::max(jerk_max, std::fabs(accel - previous) / kTick);
+            }
+        }
+        runMs(5);
+        const float moved = direction * (motor_get_position() - start);
+        const uint64_t pulses = SimHal_TimerPulseCount(TIM2, TIM_CHANNEL_1) - pulses_before;
+        const bool stop_ok = accel_max <= kAcceleration * 1.01f && jerk_max <= kJerk + kJerkSlack &&
+                             moved <= kDistance + 1.0f && std::llround(moved) == static_cast<long long>(pulses) &&
+                             motor_get_velocity() == 0.0f;
+        std::printf("  %4lu ms: from %6.1f steps/s, at rest after %3zu ms, max |a| %6.0f, max |j| %6.0f, "
+                    "moved %6.1f (emitted %llu)%s\r\n", static_cast<unsigned long>(stop_ms), v_stop,
+                    velocity.size() - 1, accel_max, jerk_max, moved, static_cast<unsigned long long>(pulses),
+                    stop_ok ? "" : "  FAIL");
+        ok = ok && stop_ok;
+        direction = -direction;
+    }
+
+    // For comparison: the rate drop a hard stop makes in one tick
+    const float start = motor_get_position();
+    ok = motor_move_to(start + direction * kDistance, kVelocity, kAcceleration, kJerk) && ok;
+    runMs(1500);
+    const float v_hard = std::fabs(motor_get_velocity());
+    motor_stop();
+    std::printf("  hard stop: %.1f steps/s to 0 in one tick (%.0f steps/s^2)\r\n", v_hard, v_hard / kTick);
+    return (ok && !motor_is_moving() && motor_get_velocity() == 0.0f) ? 0 : 1;
+}
+
+int runSteps() {
+    struct Case {
+        const char* name;
+        float distance;
+        SCurveProfile::Config config;
+    };
+    const Case kCases[] = {
+        { "cruise", 3000.0f, { 1000.0f, 2000.0f, 10000.0f } },
+        { "no cruise", 400.0f, { 1000.0f, 2000.0f, 10000.0f } },
+        { "high accel", 8000.0f, { 20000.0f, 200000.0f, 4.0e6f } },
+    };
+    constexpr float kPositionTolerance = 2.0e-3f;   // Steps, at each scheduled time
+    constexpr double kEdgeTolerance = 1.0e-6;       // Seconds, emitted against scheduled
+
+    SimBoard_Init();
+    std::printf("=== Per-step scheduling against the analytic profile ===\r\n");
+
+    bool ok = true;
+    for (const Case& c : kCases) {
+        SCurveProfile profile;
+        StepScheduler scheduler;
+        const uint32_t steps = static_cast<uint32_t>(std::lround(c.distance));
+        if (!profile.calculate(c.distance, c.config) || !scheduler.start(profile, steps)) {
+            std::printf("  %-10s invalid profile  FAIL\r\n", c.name);
+            ok = false;
+            continue;
+        }
+        float error_max = 0.0f;
+        float previous = 0.0f;
+        bool ordered = true;
+        float time = 0.0f;
+        const auto start = Clock::now();
+        while (scheduler.next(time)) {
+            const float position = profile.getStateAtTime(time).position;
+            error_max = std::max(error_max, std::fabs(position - static_cast<float>(scheduler.getStep())));
+            ordered = ordered && time >= previous;
+            previous = time;
+        }
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / steps;
+        const bool case_ok = scheduler.getStep() == steps && ordered && error_max <= kPositionTolerance;
+        std::printf("  %-10s %5lu steps in %.3f s, max position error at the step times %.4f steps "
+                    "(%.0f ns/step with the check)%s\r\n", c.name, static_cast<unsigned long>(steps),
+                    profile.getTotalTime(), error_max, ns, case_ok ? "" : "  FAIL");
+        ok = ok && case_ok;
+    }
+
+    // Step edges out of the simulated TIM2, against the scheduled step times
+    const Case& c = kCases[0];
+    SCurveProfile profile;
+    profile.calculate(c.distance, c.config);
+    std::vector<double> scheduled;
+    StepScheduler scheduler;
+    scheduler.start(profile, static_cast<uint32_t>(std::lround(c.distance)));
+    float time = 0.0f;
+    while (scheduler.next(time)) {
+        scheduled.push_back(time);
+    }
+    for (const bool dma_engine : { true, false }) {
+        SimBoard_Init();
+        motor_control_init();
+        motor_use_step_engine(dma_engine);
+        motor_enable(true);
+        SimHal_TimerEdgeCaptureStart(TIM2, TIM_CHANNEL_1);
+        ok = motor_move_to(c.distance, c.config.max_velocity, c.config.max_acceleration, c.config.max_jerk) && ok;
+        while (motor_is_moving() && HAL_GetTick() < 60000U) {
+            SimHal_AdvanceCycles(SIM_SYSCLK_HZ / 1000U);
+        }
+        const uint32_t edges = SimHal_TimerEdgeCaptureCount();
+
+        // One edge per step either way
+        ok = ok && !motor_is_moving() && edges == scheduled.size();
+        if (!dma_engine) {
+            // Rate updates place the steps to within a control tick only, so
+            // there is no step time to hold them to
+            SimHal_TimerEdgeCaptureStart(nullptr, TIM_CHANNEL_1);
+            std::printf("  TIM2 %-16s %5lu edges\r\n", "PWM rate updates:", static_cast<unsigned long>(edges));
+            continue;
+        }
+
+        // The engine's edges land on the step times, aligned on the first step
+        double deviation_max = 0.0;
+        const uint64_t first = SimHal_TimerEdgeCaptureGet(0);
+        for (uint32_t i = 1; i < std::min<size_t>(edges, scheduled.size()); i++) {
+            const double emitted = static_cast<double>(SimHal_TimerEdgeCaptureGet(i) - first) / SIM_SYSCLK_HZ;
+            deviation_max = std::max(deviation_max, std::fabs(emitted - (scheduled[i] - scheduled[0])));
+        }
+        SimHal_TimerEdgeCaptureStart(nullptr, TIM_CHANNEL_1);
+        std::printf("  TIM2 %-16s %5lu edges, max deviation from the step times %9.3f us\r\n",
+                    "DMA step engine:", static_cast<unsigned long>(edges), deviation_max * 1.0e6);
+        ok = ok && deviation_max <= kEdgeTolerance;
+    }
+    return ok ? 0 : 1;
+}
+
+int runJog() {
+    constexpr float kAcceleration = 4000.0f;
+    constexpr float kJerk = 40000.0f;
+    constexpr float kTick = 1.0e-3f;  // Control period
+    constexpr float kJerkSlack = 4.0f * 1500.0f * FLT_EPSILON / (kTick * kTick);
+    // Steps follow the commanded phase to within a rate update, and the first
+    // one is made on the first update of a ramp: a step or two at the ends
+    constexpr float kPositionSlack = 2.0f;
+    // Setpoint changes: up, faster, reverse through zero, reverse again
+    // before that ramp is done, slow down, then stop
+    struct Setpoint {
+        uint32_t at_ms;
+        float velocity;   // steps/s
+        bool held;        // Expected to be reached before the next change
+    };
+    const Setpoint kSetpoints[] = {
+        { 0, 800.0f, true }, { 600, 1500.0f, true }, { 1200, -1000.0f, false },
+        { 1900, 300.0f, true }, { 2600, 100.0f, true }, { 3100, 0.0f, true },
+    };
+
+    SimBoard_Init();
+    std::printf("=== Jog setpoints (%.0f/s^2, %.0f/s^3) ===\r\n", kAcceleration, kJerk);
+    motor_control_init();
+    motor_enable(true);
+
+    bool ok = true;
+    std::vector<float> velocity = { 0.0f };
+    double integrated = 0.0;
+    const float start = motor_get_position();
+    size_t next = 0;
+    for (uint32_t ms = 0; ms < 10000 && (next < std::size(kSetpoints) || motor_is_moving()); ms++) {
+        if (next < std::size(kSetpoints) && ms == kSetpoints[next].at_ms) {
+            // The previous setpoint is held exactly once reached
+            if (next > 0 && kSetpoints[next - 1].held && velocity.back() != kSetpoints[next - 1].velocity) {
+                std::printf("  %4lu ms: %.1f steps/s, setpoint %.0f not reached  FAIL\r\n",
+                            static_cast<unsigned long>(ms), velocity.back(), kSetpoints[next - 1].velocity);
+                ok = false;
+            }
+            std::printf("  %4lu ms: %7.1f -> %7.1f steps/s\r\n", static_cast<unsigned long>(ms), velocity.back(),
+                        kSetpoints[next].velocity);
+            ok = motor_jog(kSetpoints[next].velocity, kAcceleration, kJerk) && ok;
+            next++;
+        }
+        motor_command_service();
+        SimHal_AdvanceMicros(1000);
+        velocity.push_back(motor_get_velocity());
+        integrated += 0.5 * (velocity[velocity.size() - 2] + velocity.back()) * kTick;
+    }
+
+    float accel_max = 0.0f;
+    float jerk_max = 0.0f;
+    uint32_t reversals = 0;
+    for (size_t i = 1; i < velocity.size(); i++) {
+        const float accel = (velocity[i] - velocity[i - 1]) / kTick;
+        accel_max = std::max(accel_max, std::fabs(accel));
+        if (i >= 2) {
+            const float previous = (velocity[i - 1] - velocity[i - 2]) / kTick;
+            jerk_max = std::max(jerk_max, std::fabs(accel - previous) / kTick);
+        }
+        if (velocity[i] * velocity[i - 1] < 0.0f) {
+            reversals++;
+        }
+    }
+    SimHal_AdvanceMicros(5000);
+    const float moved = motor_get_position() - start;
+    std::printf("  at rest after %zu ms, %lu reversals, max |a| %.0f steps/s^2, max |j| %.0f steps/s^3\r\n",
+                velocity.size() - 1, static_cast<unsigned long>(reversals), accel_max, jerk_max);
+    std::printf("  moved %.1f steps (counted), %.1f by the commanded velocity\r\n", moved, integrated);
+
+    ok = ok && !motor_is_moving() && velocity.back() == 0.0f && reversals == 2 &&
+         accel_max <= kAcceleration * 1.01f && jerk_max <= kJerk + kJerkSlack &&
+         std::fabs(moved - static_cast<float>(integrated)) <= kPositionSlack;
+    return ok ? 0 : 1;
+}
+
+int runRetarget(uint32_t seconds) {
+    constexpr float kVelocity = 2000.0f;
+    constexpr float kAcceleration = 8000.0f;
+    constexpr float kJerk = 80000.0f;
+    constexpr float kTick = 1.0e-3f;  // Control period
+    constexpr float kJerkSlack = 4.0f * kVelocity * FLT_EPSILON / (kTick * kTick);
+    constexpr float kAmplitude = 600.0f;   // Peak speed 2*pi*A/T ~ 1500 steps/s
+    constexpr float kPeriod = 2.5f;  // Seconds per swing
+
+    SimBoard_Init();
+    std::printf("=== Retargeting every 20-50 ms for %lu s (%.0f/s, %.0f/s^2, %.0f/s^3) ===\r\n",
+                static_cast<unsigned long>(seconds), kVelocity, kAcceleration, kJerk);
+    motor_control_init();
+    motor_enable(true);
+
+    uint32_t random = 12345;
+    auto nextInterval = [&random]() {
+        random = random * 1103515245U + 12345U;
+        return 20U + (random >> 16) % 31U;
+    };
+
+    std::vector<float> velocity = { 0.0f };
+    uint32_t retargets = 0;
+    uint32_t rejected = 0;
+    double error_sum = 0.0;
+    float error_max = 0.0f;
+    float target = 0.0f;
+    uint32_t next_update = 0;
+    const uint32_t run_ms = seconds * 1000U;
+    for (uint32_t ms = 0; ms < run_ms || motor_is_moving(); ms++) {
+        if (ms < run_ms && ms >= next_update) {
+            // Swinging part, seen with a little measurement noise
+            const float t = static_cast<float>(ms) * 1.0e-3f;
+            const float noise = static_cast<float>((random >> 8) % 21U) - 10.0f;
+            target = std::round(kAmplitude * std::sin(6.2831853f * t / kPeriod) + noise);
+            if (motor_move_to(target, kVelocity, kAcceleration, kJerk)) {
+                retargets++;
+            } else {
+                rejected++;
+            }
+            next_update = ms + nextInterval();
+        }
+        motor_command_service();
+        SimHal_AdvanceMicros(1000);
+        velocity.push_back(motor_get_velocity());
+        if (ms < run_ms) {
+            const float error = std::fabs(target - motor_get_position());
+            error_sum += error;
+            error_max = std::max(error_max, error);
+        }
+        if (ms > run_ms + 10000U) {
+            break;
+        }
+    }
+
+    float accel_max = 0.0f;
+    float jerk_max = 0.0f;
+    for (size_t i = 1; i < velocity.size(); i++) {
+        const float accel = (velocity[i] - velocity[i - 1]) / kTick;
+        accel_max = std::max(accel_max, std::fabs(accel));
+        if (i >= 2) {
+            const float previous = (velocity[i - 1] - velocity[i - 2]) / kTick;
+            jerk_max = std::max(jerk_max, std::fabs(accel - previous) / kTick);
+        }
+    }
+    SimHal_AdvanceMicros(5000);
+    const float settled = motor_get_position();
+    std::printf("  %lu retargets (%lu rejected), tracking error mean %.1f max %.1f steps\r\n",
+                static_cast<unsigned long>(retargets), static_cast<unsigned long>(rejected),
+                error_sum / run_ms, error_max);
+    std::printf("  commanded velocity: max |a| %.0f steps/s^2, max |j| %.0f steps/s^3\r\n", accel_max, jerk_max);
+    std::printf("  last target %.0f, settled at %.0f (counted)\r\n", target, settled);
+
+    bool ok = rejected == 0 && !motor_is_moving() && accel_max <= kAcceleration * 1.01f &&
+              jerk_max <= kJerk + kJerkSlack && settled == target;
+
+    // Lowered limits while accelerating or decelerating at the old ones: the
+    // ramp eases off to the new acceleration at the new jerk, then stays
+    // within the new limits (the first tick still mixes in the old jerk)
+    constexpr float kLowAcceleration = 2000.0f;
+    constexpr float kLowJerk = 20000.0f;
+    constexpr float kEaseOff = (kAcceleration - kLowAcceleration) / kLowJerk + 2.0f * kTick;
+    struct LowerCase {
+        const char* name;
+        float sign;       // Lowered at +/-0.95 of the old acceleration
+        float retarget;   // Steps from the move's start
+    };
+    const LowerCase kLowerCases[] = {
+        { "further on", 1.0f, 4500.0f }, { "further on", -1.0f, 4500.0f }, { "behind", -1.0f, 1000.0f },
+    };
+    for (const LowerCase& c : kLowerCases) {
+        const float origin = motor_get_position();
+        bool case_ok = motor_move_to(origin + 3000.0f, kVelocity, kAcceleration, kJerk);
+        std::vector<float> v = { motor_get_velocity() };
+        uint32_t ms = 0;
+        for (; ms < 5000 && motor_is_moving(); ms++) {
+            motor_command_service();
+            SimHal_AdvanceMicros(1000);
+            v.push_back(motor_get_velocity());
+            if (c.sign * (v.back() - v[v.size() - 2]) / kTick > 0.95f * kAcceleration) {
+                break;
+            }
+        }
+        const float v0 = v.back();
+        const float a0 = (v.back() - v[v.size() - 2]) / kTick;
+        case_ok = motor_move_to(origin + c.retarget, kVelocity, kLowAcceleration, kLowJerk) && case_ok;
+        const size_t lowered = v.size() - 1;
+        for (ms = 0; ms < 10000 && motor_is_moving(); ms++) {
+            motor_command_service();
+            SimHal_AdvanceMicros(1000);
+            v.push_back(motor_get_velocity());
+        }
+
+        float late_accel_max = 0.0f;
+        float late_jerk_max = 0.0f;
+        accel_max = 0.0f;
+        jerk_max = 0.0f;
+        for (size_t i = lowered + 1; i < v.size(); i++) {
+            const float accel = (v[i] - v[i - 1]) / kTick;
+            const float jerk = std::fabs(accel - (v[i - 1] - v[i - 2]) / kTick) / kTick;
+            accel_max = std::max(accel_max, std::fabs(accel));
+            jerk_max = std::max(jerk_max, jerk);
+            if (static_cast<float>(i - lowered) * kTick > kEaseOff) {
+                late_accel_max = std::max(late_accel_max, std::fabs(accel));
+                late_jerk_max = std::max(late_jerk_max, jerk);
+            }
+        }
+        SimHal_AdvanceMicros(5000);
+        const float error = motor_get_position() - (origin + c.retarget);
+        case_ok = case_ok && !motor_is_moving() && accel_max <= kAcceleration * 1.01f &&
+                  jerk_max <= kJerk + kJerkSlack && late_accel_max <= kLowAcceleration * 1.01f &&
+                  late_jerk_max <= kLowJerk + kJerkSlack && error == 0.0f;
+        std::printf("  lowered to %.0f/s^2, %.0f/s^3 at %.0f steps/s, %.0f steps/s^2, target %-10s "
+                    "max |a| %.0f (%.0f after easing off), max |j| %.0f, error %.0f%s\r\n",
+                    kLowAcceleration, kLowJerk, v0, a0, c.name, accel_max, late_accel_max, jerk_max, error,
+                    case_ok ? "" : "  FAIL");
+        ok = ok && case_ok;
+    }
+    return ok ? 0 : 1;
+}
+
+int runTimers() {
+    constexpr float kMinRate = 1.0f;
+    constexpr float kMaxRate = 200000.0f;
+    constexpr float kErrorLimit = 1.0e-3f;       // Relative, below kErrorLimit * 2 * clock
+    constexpr float kFloatSlack = 1.0e-6f;       // Relative, float rounding of the achieved rate
+    constexpr int kPointsPerDecade = 500;
+
+    SimBoard_Init();
+    std::printf("=== Step timer clocks and prescaler/period solver ===\r\n");
+    bool ok = true;
+
+    // Timer clocks from the APB prescalers (HCLK 84 MHz)
+    struct ClockCase {
+        const char* name;
+        uint32_t cfgr;
+        uint32_t dckcfgr;
+        uint32_t apb1_timers;
+        uint32_t apb2_timers;
+    };
+    const ClockCase kClocks[] = {
+        { "APB1 /2, APB2 /1 (board)", RCC_CFGR_PPRE1_DIV2 | RCC_CFGR_PPRE2_DIV1, 0, 84000000, 84000000 },
+        { "APB1 /1, APB2 /1", RCC_CFGR_PPRE1_DIV1 | RCC_CFGR_PPRE2_DIV1, 0, 84000000, 84000000 },
+        { "APB1 /4, APB2 /2", RCC_CFGR_PPRE1_DIV4 | RCC_CFGR_PPRE2_DIV2, 0, 42000000, 84000000 },
+        { "APB1 /4, APB2 /2, TIMPRE", RCC_CFGR_PPRE1_DIV4 | RCC_CFGR_PPRE2_DIV2, RCC_DCKCFGR_TIMPRE, 84000000, 84000000 },
+        { "APB1 /8, APB2 /16, TIMPRE", RCC_CFGR_PPRE1_DIV8 | RCC_CFGR_PPRE2_DIV16, RCC_DCKCFGR_TIMPRE, 42000000, 21000000 },
+    };
+    for (const ClockCase& c : kClocks) {
+        RCC->CFGR = c.cfgr;
+        RCC->DCKCFGR = c.dckcfgr;
+        const uint32_t apb1 = TimerClock::getClock(TIM2);
+        const uint32_t apb2 = TimerClock::getClock(TIM1);
+        const bool case_ok = apb1 == c.apb1_timers && apb2 == c.apb2_timers;
+        std::printf("  %-26s PCLK1 %8lu, PCLK2 %8lu -> TIM2 %8lu, TIM1 %8lu Hz%s\r\n", c.name,
+                    static_cast<unsigned long>(HAL_RCC_GetPCLK1Freq()), static_cast<unsigned long>(HAL_RCC_GetPCLK2Freq()),
+                    static_cast<unsigned long>(apb1), static_cast<unsigned long>(apb2), case_ok ? "" : "  FAIL");
+        ok = ok && case_ok;
+    }
+    SimBoard_Init();  // Back to the board clocks the timer models run at
+
+    // Solver sweep per decade, against the old PSC = 99 with ARR <= 65534
+    const uint32_t clock = TimerClock::getClock(TIM2);
+    const float precise_below = kErrorLimit * 2.0f * static_cast<float>(clock);
+    std::printf("  Max |error| per band (%lu Hz timer clock; sub-%.1f%% up to %.0f kHz, then <= 0.5 tick):\r\n",
+                static_cast<unsigned long>(clock), kErrorLimit * 100.0f, precise_below / 1000.0f);
+    float band_start = kMinRate;
+    while (band_start < kMaxRate) {
+        const float band_end = std::min(band_start * 10.0f, kMaxRate);
+        float error_max[2] = { 0.0f, 0.0f };
+        float fixed_max = 0.0f;
+        bool band_ok = true;
+        for (int i = 0; i <= kPointsPerDecade; i++) {
+            const float rate = band_start * std::pow(band_end / band_start, static_cast<float>(i) / kPointsPerDecade);
+            const TIM_TypeDef* timers[2] = { TIM2, TIM1 };
+            for (int t = 0; t < 2; t++) {
+                TimerClock::Setting setting;
+                const bool solved = TimerClock::solve(clock, rate, TimerClock::getMaxPeriod(timers[t]), 2, setting);
+                const float bound = 0.5f / static_cast<float>(setting.period) + kFloatSlack;
+                const float limit = (rate <= precise_below) ? std::min(bound, kErrorLimit) : bound;
+                band_ok = band_ok && solved && std::fabs(setting.error) <= limit;
+                error_max[t] = std::max(error_max[t], std::fabs(setting.error));
+            }
+            // Old StepperMotor: 840 kHz counter, integer rate, period clamped to 65535 ticks
+            const uint32_t fixed_clock = clock / 100U;
+            const uint32_t fixed_period =
+                std::clamp(fixed_clock / static_cast<uint32_t>(rate), static_cast<uint32_t>(2), static_cast<uint32_t>(65535));
+            const float fixed_rate = static_cast<float>(fixed_clock) / static_cast<float>(fixed_period);
+            fixed_max = std::max(fixed_max, std::fabs(fixed_rate / rate - 1.0f));
+        }
+        std::printf("    %8.0f - %8.0f Hz: TIM2 %.5f%%, TIM1 %.5f%% (PSC 99: %.3f%%)%s\r\n", band_start, band_end,
+                    error_max[0] * 100.0f, error_max[1] * 100.0f, fixed_max * 100.0f, band_ok ? "" : "  FAIL");
+        ok = ok && band_ok;
+        band_start = band_end;
+    }
+
+    // Emitted step rate of StepperMotor, from the recorded edge times
+    struct Output {
+        const char* name;
+        TIM_HandleTypeDef* htim;
+        uint32_t channel;
+    };
+    const Output kOutputs[] = {
+        { "TIM2 CH1", &htim2, TIM_CHANNEL_1 },
+        { "TIM1 CH3", &htim1, TIM_CHANNEL_3 },
+    };
+    const float kRates[] = { 1.0f, 3.7f, 12.5f, 250.3f, 4999.0f, 47123.0f, 167890.0f, 199321.0f };
+    std::printf("  StepperMotor, emitted against commanded:\r\n");
+    for (const Output& output : kOutputs) {
+        SimBoard_Init();
+        output.htim->Instance->SMCR = 0;  // Free running, not started by TIM2
+        StepperMotor::Config config = motorConfig();
+        config.step_timer = output.htim;
+        config.step_channel = output.channel;
+        StepperMotor motor(config);
+        motor.setEnabled(true);
+        for (const float rate : kRates) {
+            SimHal_TimerEdgeCaptureStart(output.htim->Instance, output.channel);
+            motor.setStepRate(rate);
+            const double window = std::max(3.5 / rate, 0.01);
+            SimHal_AdvanceCycles(static_cast<uint64_t>(window * SIM_SYSCLK_HZ));
+            const double achieved = motor.getAchievedStepRate();
+            const float reported = motor.getStepRateError();
+            motor.stop();
+            const uint32_t edges = SimHal_TimerEdgeCaptureCount();
+            const uint64_t span = SimHal_TimerEdgeCaptureGet(edges - 1) - SimHal_TimerEdgeCaptureGet(0);
+            const double emitted = (edges > 1) ? (edges - 1) * static_cast<double>(SIM_SYSCLK_HZ) / span : 0.0;
+            const double error = emitted / rate - 1.0;
+            const double limit = (rate <= precise_below) ? kErrorLimit : 0.5 * rate / clock + kFloatSlack;
+            const bool rate_ok = edges >= 3 && std::fabs(emitted / achieved - 1.0) <= kFloatSlack &&
+                                 std::fabs(error) <= limit;
+            std::printf("    %s %9.1f steps/s: emitted %12.4f (%+.5f%%, reported %+.5f%%)%s\r\n", output.name, rate,
+                        emitted, error * 100.0, reported * 100.0f, rate_ok ? "" : "  FAIL");
+            ok = ok && rate_ok;
+        }
+        SimHal_TimerEdgeCaptureStart(nullptr, output.channel);
+    }
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Step pulses per planner move, stepping the planner by hand every millisecond
+ */
+template <size_t N>
+void runPlannerMoves(MotionPlanner& planner, const TIM_TypeDef* tim, uint32_t channel, const float (&targets)[N],
+                     uint32_t (&steps)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        const uint64_t pulses = SimHal_TimerPulseCount(tim, channel);
+        planner.moveTo(targets[i], 4000.0f, 20000.0f, 200000.0f);
+        while (!planner.isComplete() && HAL_GetTick() < 60000U) {
+            planner.update();
+            SimHal_AdvanceCycles(SIM_SYSCLK_HZ / 1000U);
+        }
+        SimHal_AdvanceCycles(SIM_SYSCLK_HZ / 1000U);
+        steps[i] = static_cast<uint32_t>(SimHal_TimerPulseCount(tim, channel) - pulses);
+    }
+}
+
+template <typename DRIVER>
+void driverSpeed(float speed) {
+    DRIVER::setStepRate(speed);
+}
+
+template <typename DRIVER>
+void driverDirection(bool forward) {
+    DRIVER::setDirection(forward);
+}
+
+/**
+ * @brief One driver against StepperMotor on the same timer channel and pins
+ */
+template <typename DRIVER>
+bool checkDriver(const char* name, TIM_HandleTypeDef* htim, uint32_t channel, bool enable_active_low) {
+    constexpr float kFloatSlack = 1.0e-6f;  // Relative, float rounding of the achieved rate
+    const float kRates[] = { 1.0f, 12.5f, 250.3f, 4999.0f, 47123.0f, 199321.0f };
+    const float kTargets[] = { 2000.0f, -500.0f, 100.0f };
+    constexpr size_t kMoveCount = sizeof(kTargets) / sizeof(kTargets[0]);
+    constexpr size_t kRateCount = sizeof(kRates) / sizeof(kRates[0]);
+    using DirPin = typename DRIVER::DirPin;
+    using EnablePin = typename DRIVER::EnablePin;
+
+    StepperMotor::Config config = motorConfig();
+    config.step_timer = htim;
+    config.step_channel = channel;
+    config.dir_port = DirPin::port();
+    config.dir_pin = DirPin::pin;
+    config.enable_port = EnablePin::port();
+    config.enable_pin = EnablePin::pin;
+    config.enable_active_low = enable_active_low;
+
+    // Pin levels (ODR) after the same calls
+    struct Levels {
+        bool dir;
+        bool enable;
+    };
+    auto levels = [&]() {
+        SimHal_AdvanceCycles(0);  // Apply the BSRR stores
+        return Levels{ (DirPin::port()->ODR & DirPin::pin) != 0, (EnablePin::port()->ODR & EnablePin::pin) != 0 };
+    };
+    Levels reference[4];
+    uint32_t reference_regs[kRateCount][3];
+    uint32_t reference_steps[kMoveCount];
+    {
+        SimBoard_Init();
+        htim->Instance->SMCR = 0;  // Free running, not started by TIM2
+        StepperMotor motor(config);
+        motor.setEnabled(true);
+        reference[0] = levels();
+        motor.setDirection(false);
+        reference[1] = levels();
+        motor.setEnabled(false);
+        reference[2] = levels();
+        motor.setDirection(true);
+        reference[3] = levels();
+        for (size_t i = 0; i < kRateCount; i++) {
+            motor.setStepRate(kRates[i]);
+            reference_regs[i][0] = htim->Instance->PSC;
+            reference_regs[i][1] = htim->Instance->ARR;
+            reference_regs[i][2] = (&htim->Instance->CCR1)[channel >> 2];
+            motor.stop();
+        }
+
+        MotionPlanner planner;
+        planner.init(nullptr, 1000);
+        planner.setSpeedCallback(onSpeed);
+        planner.setDirectionCallback(onDirection);
+        g_motor = &motor;
+        motor.setEnabled(true);
+        runPlannerMoves(planner, htim->Instance, channel, kTargets, reference_steps);
+        g_motor = nullptr;
+    }
+
+    SimBoard_Init();
+    htim->Instance->SMCR = 0;
+    DRIVER::init();
+    bool pins_ok = true;
+    const bool expected_enabled[4] = { true, true, false, false };
+    const bool expected_forward[4] = { true, false, false, true };
+    for (int i = 0; i < 4; i++) {
+        DRIVER::setEnabled(expected_enabled[i]);
+        levels();  // The model keeps only the last BSRR store per port
+        DRIVER::setDirection(expected_forward[i]);
+        const Levels level = levels();
+        pins_ok = pins_ok && level.dir == reference[i].dir && level.enable == reference[i].enable &&
+                  DRIVER::isEnabled() == expected_enabled[i] && DRIVER::isForward() == expected_forward[i];
+    }
+    std::printf("  %-22s pins: direction and enable levels %s StepperMotor%s\r\n", name,
+                pins_ok ? "match" : "differ from", pins_ok ? "" : "  FAIL");
+
+    // Registers and emitted rate per commanded rate
+    bool regs_ok = true;
+    double error_max = 0.0;
+    const uint32_t clock = TimerClock::getClock(htim->Instance);
+    for (size_t i = 0; i < kRateCount; i++) {
+        const float rate = kRates[i];
+        SimHal_TimerEdgeCaptureStart(htim->Instance, channel);
+        DRIVER::setStepRate(rate);
+        regs_ok = regs_ok && htim->Instance->PSC == reference_regs[i][0] &&
+                  htim->Instance->ARR == reference_regs[i][1] && DRIVER::compare() == reference_regs[i][2];
+        SimHal_AdvanceCycles(static_cast<uint64_t>(std::max(3.5 / rate, 0.01) * SIM_SYSCLK_HZ));
+        DRIVER::stop();
+        TimerClock::Setting setting;
+        TimerClock::solve(clock, rate, DRIVER::MAX_PERIOD, 2, setting);
+        const uint32_t edges = SimHal_TimerEdgeCaptureCount();
+        const uint64_t span = SimHal_TimerEdgeCaptureGet(edges - 1) - SimHal_TimerEdgeCaptureGet(0);
+        const double emitted = (edges > 1) ? (edges - 1) * static_cast<double>(SIM_SYSCLK_HZ) / span : 0.0;
+        const double error = std::fabs(emitted / setting.frequency - 1.0);
+        regs_ok = regs_ok && edges >= 3 && error <= kFloatSlack;
+        error_max = std::max(error_max, error);
+    }
+    SimHal_TimerEdgeCaptureStart(nullptr, channel);
+    std::printf("  %-22s PSC/ARR/CCR %s StepperMotor at %u rates, emitted rate within %.2e of the solver%s\r\n",
+                name, regs_ok ? "match" : "differ from", static_cast<unsigned>(kRateCount), error_max,
+                regs_ok ? "" : "  FAIL");
+
+    // Planner moves, against the same moves through StepperMotor
+    MotionPlanner planner;
+    planner.init(nullptr, 1000);
+    planner.setSpeedCallback(driverSpeed<DRIVER>);
+    planner.setDirectionCallback(driverDirection<DRIVER>);
+    DRIVER::setEnabled(true);
+    uint32_t steps[kMoveCount];
+    runPlannerMoves(planner, htim->Instance, channel, kTargets, steps);
+    bool moves_ok = DRIVER::isForward() == (kTargets[kMoveCount - 1] > kTargets[kMoveCount - 2]);
+    std::printf("  %-22s planner moves, steps (StepperMotor):", name);
+    float position = 0.0f;
+    for (size_t i = 0; i < kMoveCount; i++) {
+        const uint32_t difference = (steps[i] > reference_steps[i]) ? steps[i] - reference_steps[i]
+                                                                    : reference_steps[i] - steps[i];
+        std::printf(" %+.0f: %lu (%lu)", kTargets[i] - position, static_cast<unsigned long>(steps[i]),
+                    static_cast<unsigned long>(reference_steps[i]));
+        moves_ok = moves_ok && difference == 0;
+        position = kTargets[i];
+    }
+    std::printf("%s\r\n", moves_ok ? "" : "  FAIL");
+    DRIVER::stop();
+    DRIVER::setEnabled(false);
+    return pins_ok && regs_ok && moves_ok;
+}
+
+int runDriver() {
+    std::printf("=== Compile-time StepperDriver against StepperMotor ===\r\n");
+    bool ok = checkDriver<Axis0Driver>("axis 0 (TIM2 CH1)", &htim2, TIM_CHANNEL_1, false);
+    ok = checkDriver<Axis1Driver>("axis 1 (TIM1 CH3)", &htim1, TIM_CHANNEL_3, false) && ok;
+    ok = checkDriver<Axis2Driver>("axis 2 (TIM5 CH2)", &htim5, TIM_CHANNEL_2, false) && ok;
+    ok = checkDriver<Axis1LowEnableDriver>("axis 1, enable low", &htim1, TIM_CHANNEL_3, true) && ok;
+    return ok ? 0 : 1;
+}
+
+struct EncoderLeg {
+    float position;         // motor_get_position() at rest
+    double shaft;           // Simulated shaft, steps
+    float error_max;        // Largest |following error| reported (steps)
+    uint32_t ms;            // Until the move completed
+};
+
+// Runs axis 0's move to its end, losing slip_steps step pulses from
+// slip_at_ms on, and lets it settle for settle_ms
+EncoderLeg runEncoderLeg(uint32_t slip_at_ms, uint32_t slip_steps, uint32_t settle_ms) {
+    EncoderLeg leg = {};
+    uint32_t ms = 0;
+    for (; ms < 20000 && motor_is_moving(); ms++) {
+        if (slip_steps > 0 && ms == slip_at_ms) {
+            SimHal_EncoderSlip(slip_steps);
+        }
+        motor_command_service();
+        SimHal_AdvanceMicros(1000);
+        leg.error_max = std::max(leg.error_max, std::fabs(motor_get_following_error()));
+    }
+    leg.ms = ms;
+    for (uint32_t i = 0; i < settle_ms; i++) {
+        motor_command_service();
+        SimHal_AdvanceMicros(1000);
+        leg.error_max = std::max(leg.error_max, std::fabs(motor_get_following_error()));
+    }
+    leg.position = motor_get_position();
+    leg.shaft = SimHal_EncoderShaftSteps();
+    return leg;
+}
+
+int runEncoder() {
+    constexpr double kCountsPerStep = 1.25;  // ENCODER_COUNTS_PER_STEP
+    constexpr float kSettledSteps = 1.0f;
+    constexpr uint32_t kSlipSteps = 50;
+    constexpr uint32_t kFaultSlipSteps = 1000;  // Beyond MAX_FOLLOWING_ERROR_STEPS
+
+    SimBoard_Init();
+    SimHal_UartCaptureEnable(true);  // ACKs of the GUI commands below
+    std::printf("=== TIM3 encoder and closed position loop (%.2f counts/step) ===\r\n", kCountsPerStep);
+    SimHal_EncoderAttach(TIM3, TIM2, TIM_CHANNEL_1, MOTOR_DIR_GPIO_Port, MOTOR_DIR_Pin, kCountsPerStep);
+    motor_control_init();
+    motor_enable(true);
+    bool ok = true;
+    auto moveTo = [](float target, float max_velocity) {
+        return motor_move_to(target, max_velocity, 4.0f * max_velocity, 40.0f * max_velocity);
+    };
+
+    // Open loop: the lost steps stay lost, and the step count does not see them
+    ok = moveTo(4000.0f, 2000.0f) && ok;
+    const EncoderLeg open = runEncoderLeg(500, kSlipSteps, 50);
+    const bool open_ok = std::fabs(open.position - 4000.0f) <= kSettledSteps &&
+                         std::fabs(open.shaft - (open.position - kSlipSteps)) <= 0.5;
+    std::printf("  open loop,   %3lu steps lost: counted %.1f, shaft %.1f (error %.1f)  %s\r\n",
+                static_cast<unsigned long>(kSlipSteps), open.position, open.shaft, open.position - open.shaft,
+                open_ok ? "OK" : "FAIL");
+    ok = open_ok && ok;
+
+    // Closed loop: the same move back, losing as many steps, ends on target
+    ok = motor_use_closed_loop(true) && ok;
+    ok = moveTo(0.0f, 2000.0f) && ok;
+    const EncoderLeg closed = runEncoderLeg(500, kSlipSteps, 300);
+    const bool closed_ok = std::fabs(closed.shaft) <= kSettledSteps && std::fabs(closed.position) <= kSettledSteps;
+    std::printf("  closed loop, %3lu steps lost: encoder %.1f, shaft %.1f, max following error %.1f  %s\r\n",
+                static_cast<unsigned long>(kSlipSteps), closed.position, closed.shaft, closed.error_max,
+                closed_ok ? "OK" : "FAIL");
+    ok = closed_ok && ok;
+
+    // Long move: the 16-bit counter wraps, the extended count does not
+    const float kLongTarget = 60000.0f;
+    ok = moveTo(kLongTarget, 20000.0f) && ok;
+    const EncoderLeg wrap = runEncoderLeg(0, 0, 300);
+    const uint32_t cnt = TIM3->CNT;
+    const bool wrap_ok = std::fabs(wrap.shaft - kLongTarget) <= kSettledSteps &&
+                         std::fabs(wrap.position - wrap.shaft) <= 1.0 / kCountsPerStep &&
+                         wrap.shaft * kCountsPerStep > 65536.0;
+    std::printf("  %.0f steps (%.0f counts, CNT %lu): encoder %.1f, shaft %.1f in %lu ms, "
+                "max following error %.1f  %s\r\n",
+                kLongTarget, wrap.shaft * kCountsPerStep, static_cast<unsigned long>(cnt), wrap.position,
+                wrap.shaft, static_cast<unsigned long>(wrap.ms), wrap.error_max, wrap_ok ? "OK" : "FAIL");
+    ok = wrap_ok && ok;
+
+    // At rest: the load pushes the shaft 20 steps back, the loop returns it
+    SimHal_EncoderTurn(-20.0 * kCountsPerStep);
+    uint32_t returned_ms = 0;
+    for (uint32_t ms = 1; ms <= 500; ms++) {
+        motor_command_service();
+        SimHal_AdvanceMicros(1000);
+        if (returned_ms == 0 && std::fabs(SimHal_EncoderShaftSteps() - kLongTarget) <= kSettledSteps) {
+            returned_ms = ms;
+        }
+    }
+    const double pushed = SimHal_EncoderShaftSteps();
+    const bool push_ok = returned_ms != 0 && std::fabs(pushed - kLongTarget) <= kSettledSteps && !motor_is_moving();
+    std::printf("  pushed 20 steps at rest: back within %.0f step in %lu ms, shaft %.1f  %s\r\n", kSettledSteps,
+                static_cast<unsigned long>(returned_ms), pushed, push_ok ? "OK" : "FAIL");
+    ok = push_ok && ok;
+
+    // Stalled, on a move started from the GUI: the following error grows
+    // past its limit, stops the axis and takes the state machine to ERROR
+    auto send = [](TelemetryProtocol::CommandOpcode opcode, std::initializer_list<float> args) {
+        TelemetryProtocol::Command command{};
+        command.opcode = opcode;
+        for (const float arg : args) {
+            command.args[command.arg_count++] = arg;
+        }
+        uint8_t frame[TelemetryProtocol::MAX_FRAME];
+        const size_t length = TelemetryProtocol::encodeCommand(command, frame, sizeof(frame));
+        SimHal_UartInject(frame, static_cast<uint32_t>(length));
+    };
+    send(TelemetryProtocol::CommandOpcode::MOVE, { -4000.0f, 2000.0f, 8000.0f, 80000.0f });
+    send(TelemetryProtocol::CommandOpcode::START, {});
+    for (uint32_t ms = 0; ms < 20 && !motor_is_moving(); ms++) {
+        motor_command_service();
+        SimHal_AdvanceMicros(1000);
+    }
+    ok = motor_is_moving() && ok;
+    const EncoderLeg stall = runEncoderLeg(200, kFaultSlipSteps, 0);
+    const double stopped = SimHal_EncoderShaftSteps();
+    SimHal_AdvanceMicros(100000);
+    const bool stall_ok = motor_has_position_fault() && !motor_is_moving() && stall.ms < 2000 &&
+                          SimHal_EncoderShaftSteps() == stopped;
+    std::printf("  stalled, %lu steps lost: fault after %lu ms at %.1f steps of error, shaft held at %.1f  %s\r\n",
+                static_cast<unsigned long>(kFaultSlipSteps), static_cast<unsigned long>(stall.ms),
+                stall.error_max, stopped, stall_ok ? "OK" : "FAIL");
+    ok = stall_ok && ok;
+
+    return ok ? 0 : 1;
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: stm32-robotics-control-sim bench [iterations]\n"
+                 "       stm32-robotics-control-sim replay [moves.csv] [--trace trace.csv] [--dma] [--queue]\n"
+                 "       stm32-robotics-control-sim axes [target0 target1 target2]\n"
+                 "       stm32-robotics-control-sim log [lines_per_sec]\n"
+                 "       stm32-robotics-control-sim telemetry [moves.csv]\n"
+                 "       stm32-robotics-control-sim command\n"
+                 "       stm32-robotics-control-sim profile [moves.csv]\n"
+                 "       stm32-robotics-control-sim jitter [moves.csv]\n"
+                 "       stm32-robotics-control-sim stop\n"
+                 "       stm32-robotics-control-sim retarget [seconds]\n"
+                 "       stm32-robotics-control-sim jog\n"
+                 "       stm32-robotics-control-sim steps\n"
+                 "       stm32-robotics-control-sim timers\n"
+                 "       stm32-robotics-control-sim driver\n"
+                 "       stm32-robotics-control-sim encoder\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+
+    if (std::strcmp(argv[1], "bench") == 0) {
+        const uint64_t iterations = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 5000000ULL;
+        return runBench(iterations > 0 ? iterations : 1);
+    }
+
+    if (std::strcmp(argv[1], "replay") == 0) {
+        std::vector<Move> moves;
+        FILE* trace = nullptr;
+        bool dma_engine = false;
+        bool queued = false;
+        for (int i = 2; i < argc; i++) {
+            if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+                trace = std::fopen(argv[++i], "w");
+            } else if (std::strcmp(argv[i], "--dma") == 0) {
+                dma_engine = true;
+            } else if (std::strcmp(argv[i], "--queue") == 0) {
+                queued = true;
+            } else if (!loadMoves(argv[i], moves)) {
+                return 2;
+            }
+        }
+        if (moves.empty()) {
+            moves.assign(std::begin(kDefaultMoves), std::end(kDefaultMoves));
+        }
+        const int result = queued ? runQueuedReplay(moves, dma_engine) : runReplay(moves, trace, dma_engine);
+        if (trace) {
+            std::fclose(trace);
+        }
+        return result;
+    }
+
+    if (std::strcmp(argv[1], "axes") == 0) {
+        float targets[] = { 1000.0f, 500.0f, -250.0f };
+        for (int i = 2; i < argc && i - 2 < static_cast<int>(kAxisOutputCount); i++) {
+            targets[i - 2] = std::strtof(argv[i], nullptr);
+        }
+        return runAxes(targets);
+    }
+
+    if (std::strcmp(argv[1], "log") == 0) {
+        const unsigned long rate = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 500UL;
+        return runLog(rate > 0 ? static_cast<uint32_t>(rate) : 1U);
+    }
+
+    if (std::strcmp(argv[1], "telemetry") == 0) {
+        std::vector<Move> moves;
+        if (argc > 2 && !loadMoves(argv[2], moves)) {
+            return 2;
+        }
+        if (moves.empty()) {
+            moves.assign(std::begin(kDefaultMoves), std::end(kDefaultMoves));
+        }
+        return runTelemetry(moves);
+    }
+
+    if (std::strcmp(argv[1], "command") == 0) {
+        return runCommand();
+    }
+
+    if (std::strcmp(argv[1], "profile") == 0) {
+        std::vector<Move> moves;
+        if (argc > 2 && !loadMoves(argv[2], moves)) {
+            return 2;
+        }
+        if (moves.empty()) {
+            moves.assign(std::begin(kDefaultMoves), std::end(kDefaultMoves));
+        }
+        return runProfile(moves);
+    }
+
+    if (std::strcmp(argv[1], "jitter") == 0) {
+        std::vector<Move> moves;
+        if (argc > 2 && !loadMoves(argv[2], moves)) {
+            return 2;
+        }
+        if (moves.empty()) {
+            moves.assign(std::begin(kDefaultMoves), std::end(kDefaultMoves));
+        }
+        return runJitter(moves);
+    }
+
+    if (std::strcmp(argv[1], "stop") == 0) {
+        return runStop();
+    }
+
+    if (std::strcmp(argv[1], "retarget") == 0) {
+        const unsigned long seconds = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 5UL;
+        return runRetarget(seconds > 0 ? static_cast<uint32_t>(seconds) : 1U);
+    }
+
+    if (std::strcmp(argv[1], "jog") == 0) {
+        return runJog();
+    }
+
+    if (std::strcmp(argv[1], "steps") == 0) {
+        return runSteps();
+    }
+
+    if (std::strcmp(argv[1], "timers") == 0) {
+        return runTimers();
+    }
+
+    if (std::strcmp(argv[1], "driver") == 0) {
+        return runDriver();
+    }
+
+    if (std::strcmp(argv[1], "encoder") == 0) {
+        return runEncoder();
+    }
+
+    usage();
+    return 2;
+}
@@ -43,6 +43,10 @@ defined in linker script */
 .word  _sbss
 /* end address for the .bss section. defined in linker script */
 .word  _ebss
+/* start, end and load address of the RAM code (.ram_text). defined in linker script */
+.word  _sramtext
+.word  _eramtext
+.word  _siramtext
 /* stack used for SystemInit_ExtMemCtl; always internal RAM used */
 
 /**
@@ -63,6 +67,23 @@ Reset_Handler:
 /* Call the clock system initialization function.*/
   bl  SystemInit   
 
+/* Copy the RAM-resident code (.ram_text) from flash to SRAM */
+  ldr r0, =_sramtext
+  ldr r1, =_eramtext
+  ldr r2, =_siramtext
+  movs r3, #0
+  b LoopCopyRamTextInit
+
+CopyRamTextInit:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyRamTextInit:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyRamTextInit
+
 /* Copy the data segment initializers from flash to SRAM */  
   ldr r0, =_sdata
   ldr r1, =_edata